@@ -112,6 +112,10 @@ protected:
     Node    *_target;
     /** action的tag属性. 是action的一个标识 */
     int     _tag;
+    /** 在ActionManager中的索引, 没有运行时为-1 */
+    int     _runningIndex;
+
+    friend class ActionManager;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(Action);
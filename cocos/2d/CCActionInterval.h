@@ -83,6 +83,9 @@ protected:
 
     float _elapsed;
     bool   _firstTick;
+
+    // ActionManager 直接推进常用动作的时间, 不经过虚函数 step()
+    friend class ActionManager;
 };
 
 /** @brief 顺序执行动作。
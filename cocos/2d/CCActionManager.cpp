@@ -28,32 +28,108 @@ THE SOFTWARE.
 
 #include "2d/CCActionManager.h"
 #include "2d/CCNode.h"
+#include "2d/CCActionInterval.h"
 #include "base/CCScheduler.h"
 #include "base/ccMacros.h"
-#include "2d/ccCArray.h"
 #include "2d/uthash.h"
 
+#include <typeinfo>
+#include <vector>
+
 NS_CC_BEGIN
 //
 // singleton stuff
 //
 typedef struct _hashElement
 {
-    struct _ccArray             *actions;
     Node                    *target;
-    int                actionIndex;
-    Action                    *currentAction;
-    bool                        currentActionSalvaged;
-    bool                        paused;
-    UT_hash_handle                hh;
+    int                     firstEntry;    // actions of the target in the order they were added,
+    int                     lastEntry;     // linked through tActionEntry::prev/next
+    int                     count;
+    bool                    paused;
+    UT_hash_handle          hh;
 } tHashElement;
 
+// A running action
+typedef struct _actionEntry
+{
+    Action                  *action;       // nullptr when the entry is free
+    tHashElement            *element;
+    int                     prev;
+    int                     next;
+    int                     batch;
+    int                     batchIndex;
+} tActionEntry;
+
+// Running actions which are stepped by the same loop.
+// The interval actions below are grouped by the update() they use and stepped without virtual calls,
+// everything else, subclasses included, is stepped through Action::step().
+enum
+{
+    BATCH_MOVE,         // MoveBy, MoveTo
+    BATCH_BEZIER,       // BezierBy, BezierTo
+    BATCH_SCALE,        // ScaleTo, ScaleBy
+    BATCH_ROTATE_TO,
+    BATCH_ROTATE_BY,
+    BATCH_FADE,         // FadeTo, FadeIn, FadeOut
+    BATCH_TINT_TO,
+    BATCH_TINT_BY,
+    BATCH_GENERIC,
+    BATCH_COUNT
+};
+
+typedef struct _actionBatch
+{
+    // a removed action leaves a nullptr, the arrays are compacted at the end of the tick
+    std::vector<Action*>        actions;
+    std::vector<tHashElement*>  elements;
+    std::vector<int>            entries;
+    size_t                      removed;
+} tActionBatch;
+
+typedef struct _actionStorage
+{
+    std::vector<tActionEntry>   entries;
+    std::vector<int>            freeEntries;
+    tActionBatch                batches[BATCH_COUNT];
+    // actions and targets are released once the manager is done with them,
+    // so that a release triggering a removal can't pull the arrays from under it
+    std::vector<Ref*>           pendingReleases;
+} tActionStorage;
+
+static int batchOfAction(Action *action)
+{
+    const std::type_info& type = typeid(*action);
+
+    if (type == typeid(MoveTo) || type == typeid(MoveBy))
+        return BATCH_MOVE;
+    if (type == typeid(BezierTo) || type == typeid(BezierBy))
+        return BATCH_BEZIER;
+    if (type == typeid(ScaleTo) || type == typeid(ScaleBy))
+        return BATCH_SCALE;
+    if (type == typeid(RotateTo))
+        return BATCH_ROTATE_TO;
+    if (type == typeid(RotateBy))
+        return BATCH_ROTATE_BY;
+    if (type == typeid(FadeTo) || type == typeid(FadeIn) || type == typeid(FadeOut))
+        return BATCH_FADE;
+    if (type == typeid(TintTo))
+        return BATCH_TINT_TO;
+    if (type == typeid(TintBy))
+        return BATCH_TINT_BY;
+
+    return BATCH_GENERIC;
+}
+
 ActionManager::ActionManager(void)
 : _targets(nullptr),
-  _currentTarget(nullptr),
-  _currentTargetSalvaged(false)
+  _storage(new tActionStorage()),
+  _updating(false)
 {
-
+    for (auto& batch : _storage->batches)
+    {
+        batch.removed = 0;
+    }
 }
 
 ActionManager::~ActionManager(void)
@@ -61,60 +137,120 @@ ActionManager::~ActionManager(void)
     CCLOGINFO("deallocing ActionManager: %p", this);
 
     removeAllActions();
+
+    delete _storage;
 }
 
 // private
 
 void ActionManager::deleteHashElement(tHashElement *element)
 {
-    ccArrayFree(element->actions);
     HASH_DEL(_targets, element);
-    element->target->release();
+    releaseLater(element->target);
     free(element);
 }
 
-void ActionManager::actionAllocWithHashElement(tHashElement *element)
+void ActionManager::releaseLater(Ref *object)
 {
-    // 4 actions per Node by default
-    if (element->actions == nullptr)
-    {
-        element->actions = ccArrayNew(4);
-    }else 
-    if (element->actions->num == element->actions->max)
+    _storage->pendingReleases.push_back(object);
+}
+
+void ActionManager::releasePending()
+{
+    if (_updating)
     {
-        ccArrayDoubleCapacity(element->actions);
+        return;
     }
 
+    // a release may remove more actions, which queue their own releases
+    while (! _storage->pendingReleases.empty())
+    {
+        std::vector<Ref*> objects;
+        objects.swap(_storage->pendingReleases);
+        for (auto object : objects)
+        {
+            object->release();
+        }
+    }
 }
 
-void ActionManager::removeActionAtIndex(ssize_t index, tHashElement *element)
+void ActionManager::removeEntry(int index)
 {
-    Action *action = (Action*)element->actions->arr[index];
+    tActionEntry& entry = _storage->entries[index];
+    Action *action = entry.action;
+    tHashElement *element = entry.element;
 
-    if (action == element->currentAction && (! element->currentActionSalvaged))
+    if (entry.prev >= 0)
+    {
+        _storage->entries[entry.prev].next = entry.next;
+    }
+    else
+    {
+        element->firstEntry = entry.next;
+    }
+
+    if (entry.next >= 0)
+    {
+        _storage->entries[entry.next].prev = entry.prev;
+    }
+    else
     {
-        element->currentAction->retain();
-        element->currentActionSalvaged = true;
+        element->lastEntry = entry.prev;
     }
 
-    ccArrayRemoveObjectAtIndex(element->actions, index, true);
+    tActionBatch *batch = &_storage->batches[entry.batch];
+    batch->actions[entry.batchIndex] = nullptr;
+    batch->elements[entry.batchIndex] = nullptr;
+    ++batch->removed;
 
-    // update actionIndex in case we are in tick. looping over the actions
-    if (element->actionIndex >= index)
+    entry.action = nullptr;
+    entry.element = nullptr;
+    _storage->freeEntries.push_back(index);
+
+    action->_runningIndex = -1;
+    releaseLater(action);
+
+    if (--element->count == 0)
     {
-        element->actionIndex--;
+        deleteHashElement(element);
     }
 
-    if (element->actions->num == 0)
+    // outside of update() the holes are only compacted once they take up half of the batch
+    if (! _updating && batch->removed > 64 && batch->removed * 2 > batch->actions.size())
     {
-        if (_currentTarget == element)
-        {
-            _currentTargetSalvaged = true;
-        }
-        else
+        compactBatch(batch);
+    }
+}
+
+void ActionManager::compactBatch(tActionBatch *batch)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < batch->actions.size(); ++i)
+    {
+        if (batch->actions[i] == nullptr)
         {
-            deleteHashElement(element);
+            continue;
         }
+
+        batch->actions[count] = batch->actions[i];
+        batch->elements[count] = batch->elements[i];
+        batch->entries[count] = batch->entries[i];
+        _storage->entries[batch->entries[count]].batchIndex = (int)count;
+        ++count;
+    }
+
+    batch->actions.resize(count);
+    batch->elements.resize(count);
+    batch->entries.resize(count);
+    batch->removed = 0;
+}
+
+void ActionManager::removeAllActionsFromElement(tHashElement *element)
+{
+    // the element is deleted with its last action
+    for (int count = element->count; count > 0; --count)
+    {
+        removeEntry(element->firstEntry);
     }
 }
 
@@ -169,6 +305,7 @@ void ActionManager::addAction(Action *action, Node *target, bool paused)
 {
     CCASSERT(action != nullptr, "");
     CCASSERT(target != nullptr, "");
+    CCASSERT(action->_runningIndex < 0, "action is already running");
 
     tHashElement *element = nullptr;
     // we should convert it to Ref*, because we save it as Ref*
@@ -178,17 +315,54 @@ void ActionManager::addAction(Action *action, Node *target, bool paused)
     {
         element = (tHashElement*)calloc(sizeof(*element), 1);
         element->paused = paused;
+        element->firstEntry = -1;
+        element->lastEntry = -1;
         target->retain();
         element->target = target;
         HASH_ADD_PTR(_targets, target, element);
     }
 
-     actionAllocWithHashElement(element);
- 
-     CCASSERT(! ccArrayContainsObject(element->actions, action), "");
-     ccArrayAppendObject(element->actions, action);
- 
-     action->startWithTarget(target);
+    int index;
+    if (! _storage->freeEntries.empty())
+    {
+        index = _storage->freeEntries.back();
+        _storage->freeEntries.pop_back();
+    }
+    else
+    {
+        index = (int)_storage->entries.size();
+        _storage->entries.push_back(tActionEntry());
+    }
+
+    tActionBatch *batch = &_storage->batches[batchOfAction(action)];
+
+    tActionEntry& entry = _storage->entries[index];
+    entry.action = action;
+    entry.element = element;
+    entry.prev = element->lastEntry;
+    entry.next = -1;
+    entry.batch = (int)(batch - _storage->batches);
+    entry.batchIndex = (int)batch->actions.size();
+
+    if (element->lastEntry >= 0)
+    {
+        _storage->entries[element->lastEntry].next = index;
+    }
+    else
+    {
+        element->firstEntry = index;
+    }
+    element->lastEntry = index;
+    ++element->count;
+
+    batch->actions.push_back(action);
+    batch->elements.push_back(element);
+    batch->entries.push_back(index);
+
+    action->retain();
+    action->_runningIndex = index;
+
+    action->startWithTarget(target);
 }
 
 // remove
@@ -197,10 +371,12 @@ void ActionManager::removeAllActions()
 {
     for (tHashElement *element = _targets; element != nullptr; )
     {
-        auto target = element->target;
+        auto current = element;
         element = (tHashElement*)element->hh.next;
-        removeAllActionsFromTarget(target);
+        removeAllActionsFromElement(current);
     }
+
+    releasePending();
 }
 
 void ActionManager::removeAllActionsFromTarget(Node *target)
@@ -215,21 +391,8 @@ void ActionManager::removeAllActionsFromTarget(Node *target)
     HASH_FIND_PTR(_targets, &target, element);
     if (element)
     {
-        if (ccArrayContainsObject(element->actions, element->currentAction) && (! element->currentActionSalvaged))
-        {
-            element->currentAction->retain();
-            element->currentActionSalvaged = true;
-        }
-
-        ccArrayRemoveAllObjects(element->actions);
-        if (_currentTarget == element)
-        {
-            _currentTargetSalvaged = true;
-        }
-        else
-        {
-            deleteHashElement(element);
-        }
+        removeAllActionsFromElement(element);
+        releasePending();
     }
     else
     {
@@ -245,16 +408,11 @@ void ActionManager::removeAction(Action *action)
         return;
     }
 
-    tHashElement *element = nullptr;
-    Ref *target = action->getOriginalTarget();
-    HASH_FIND_PTR(_targets, &target, element);
-    if (element)
+    int index = action->_runningIndex;
+    if (index >= 0 && index < (int)_storage->entries.size() && _storage->entries[index].action == action)
     {
-        auto i = ccArrayGetIndexOfObject(element->actions, action);
-        if (i != CC_INVALID_INDEX)
-        {
-            removeActionAtIndex(i, element);
-        }
+        removeEntry(index);
+        releasePending();
     }
     else
     {
@@ -272,14 +430,14 @@ void ActionManager::removeActionByTag(int tag, Node *target)
 
     if (element)
     {
-        auto limit = element->actions->num;
-        for (int i = 0; i < limit; ++i)
+        for (int i = element->firstEntry; i >= 0; i = _storage->entries[i].next)
         {
-            Action *action = (Action*)element->actions->arr[i];
+            Action *action = _storage->entries[i].action;
 
             if (action->getTag() == (int)tag && action->getOriginalTarget() == target)
             {
-                removeActionAtIndex(i, element);
+                removeEntry(i);
+                releasePending();
                 break;
             }
         }
@@ -299,17 +457,13 @@ Action* ActionManager::getActionByTag(int tag, const Node *target) const
 
     if (element)
     {
-        if (element->actions != nullptr)
+        for (int i = element->firstEntry; i >= 0; i = _storage->entries[i].next)
         {
-            auto limit = element->actions->num;
-            for (int i = 0; i < limit; ++i)
-            {
-                Action *action = (Action*)element->actions->arr[i];
+            Action *action = _storage->entries[i].action;
 
-                if (action->getTag() == (int)tag)
-                {
-                    return action;
-                }
+            if (action->getTag() == (int)tag)
+            {
+                return action;
             }
         }
         CCLOG("cocos2d : getActionByTag(tag = %d): Action not found", tag);
@@ -330,70 +484,112 @@ ssize_t ActionManager::getNumberOfRunningActionsInTarget(const Node *target) con
     HASH_FIND_PTR(_targets, &target, element);
     if (element)
     {
-        return element->actions ? element->actions->num : 0;
+        return element->count;
     }
 
     return 0;
 }
 
 // main loop
-void ActionManager::update(float dt)
+
+// Same as ActionInterval::step() followed by isDone(), with T::update() called directly
+template <class T>
+void ActionManager::stepIntervalActions(tActionBatch *batch, size_t begin, float dt)
 {
-    for (tHashElement *elt = _targets; elt != nullptr; )
+    for (size_t i = begin; i < batch->actions.size(); ++i)
     {
-        _currentTarget = elt;
-        _currentTargetSalvaged = false;
+        T *action = static_cast<T*>(batch->actions[i]);
+        if (action == nullptr || batch->elements[i]->paused)
+        {
+            continue;
+        }
 
-        if (! _currentTarget->paused)
+        if (action->_firstTick)
         {
-            // The 'actions' MutableArray may change while inside this loop.
-            for (_currentTarget->actionIndex = 0; _currentTarget->actionIndex < _currentTarget->actions->num;
-                _currentTarget->actionIndex++)
-            {
-                _currentTarget->currentAction = (Action*)_currentTarget->actions->arr[_currentTarget->actionIndex];
-                if (_currentTarget->currentAction == nullptr)
-                {
-                    continue;
-                }
-
-                _currentTarget->currentActionSalvaged = false;
-
-                _currentTarget->currentAction->step(dt);
-
-                if (_currentTarget->currentActionSalvaged)
-                {
-                    // The currentAction told the node to remove it. To prevent the action from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    _currentTarget->currentAction->release();
-                } else
-                if (_currentTarget->currentAction->isDone())
-                {
-                    _currentTarget->currentAction->stop();
-
-                    Action *action = _currentTarget->currentAction;
-                    // Make currentAction nil to prevent removeAction from salvaging it.
-                    _currentTarget->currentAction = nullptr;
-                    removeAction(action);
-                }
-
-                _currentTarget->currentAction = nullptr;
-            }
+            action->_firstTick = false;
+            action->_elapsed = 0;
         }
+        else
+        {
+            action->_elapsed += dt;
+        }
+
+        float duration = action->getDuration();
+        action->T::update(MAX (0, MIN(1, action->_elapsed / MAX(duration, FLT_EPSILON))));
 
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashElement*)(elt->hh.next);
+        // update() could have removed the action, e.g. from an overridden Node::setPosition()
+        if (batch->actions[i] == action && action->_elapsed >= duration)
+        {
+            action->stop();
+            removeEntry(batch->entries[i]);
+        }
+    }
+}
 
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->actions->num == 0)
+void ActionManager::stepActions(tActionBatch *batch, size_t begin, float dt)
+{
+    // actions added while looping are appended and stepped in this tick as well
+    for (size_t i = begin; i < batch->actions.size(); ++i)
+    {
+        Action *action = batch->actions[i];
+        if (action == nullptr || batch->elements[i]->paused)
+        {
+            continue;
+        }
+
+        action->step(dt);
+
+        // The action may have been removed by its own step. It is kept alive until the end
+        // of the tick, and its slot is cleared.
+        if (batch->actions[i] == action && action->isDone())
+        {
+            action->stop();
+            removeEntry(batch->entries[i]);
+        }
+    }
+}
+
+void ActionManager::stepIntervalBatches(size_t *begin, float dt)
+{
+    tActionBatch *batches = _storage->batches;
+
+    stepIntervalActions<MoveBy>(&batches[BATCH_MOVE], begin[BATCH_MOVE], dt);
+    stepIntervalActions<BezierBy>(&batches[BATCH_BEZIER], begin[BATCH_BEZIER], dt);
+    stepIntervalActions<ScaleTo>(&batches[BATCH_SCALE], begin[BATCH_SCALE], dt);
+    stepIntervalActions<RotateTo>(&batches[BATCH_ROTATE_TO], begin[BATCH_ROTATE_TO], dt);
+    stepIntervalActions<RotateBy>(&batches[BATCH_ROTATE_BY], begin[BATCH_ROTATE_BY], dt);
+    stepIntervalActions<FadeTo>(&batches[BATCH_FADE], begin[BATCH_FADE], dt);
+    stepIntervalActions<TintTo>(&batches[BATCH_TINT_TO], begin[BATCH_TINT_TO], dt);
+    stepIntervalActions<TintBy>(&batches[BATCH_TINT_BY], begin[BATCH_TINT_BY], dt);
+
+    for (int i = 0; i < BATCH_GENERIC; ++i)
+    {
+        begin[i] = batches[i].actions.size();
+    }
+}
+
+void ActionManager::update(float dt)
+{
+    _updating = true;
+
+    size_t begin[BATCH_GENERIC] = { 0 };
+    stepIntervalBatches(begin, dt);
+    stepActions(&_storage->batches[BATCH_GENERIC], 0, dt);
+
+    // interval actions started by the ones above, e.g. from a CallFunc, make their first step in this tick
+    stepIntervalBatches(begin, dt);
+
+    _updating = false;
+
+    for (auto& batch : _storage->batches)
+    {
+        if (batch.removed > 0)
         {
-            deleteHashElement(_currentTarget);
+            compactBatch(&batch);
         }
     }
 
-    // issue #635
-    _currentTarget = nullptr;
+    releasePending();
 }
 
 NS_CC_END
@@ -36,6 +36,8 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 struct _hashElement;
+struct _actionBatch;
+struct _actionStorage;
 
 /**
  * @addtogroup actions
@@ -44,6 +46,10 @@ struct _hashElement;
 
 /** 
  @brief ActionManager是一个管理动作的单例类。 
+ 运行中的动作保存在连续的数组中. MoveTo/MoveBy, BezierTo/BezierBy, ScaleTo/ScaleBy,
+ RotateTo, RotateBy, FadeTo/FadeIn/FadeOut, TintTo, TintBy 按类型分组, 每组在一个循环里直接调用
+ update(), 其它动作(包括这些类的子类)仍然通过虚函数 step() 更新. 移除动作的开销是 O(1).
+ 同一个目标上修改同一属性的多个动作, 更新顺序不保证与添加顺序一致.
  @since v0.8
  */
 class CC_DLL ActionManager : public Ref
@@ -118,16 +124,20 @@ public:
     void update(float dt);
     
 protected:
-    // declared in ActionManager.m
-
-    void removeActionAtIndex(ssize_t index, struct _hashElement *element);
+    void removeEntry(int index);
+    void removeAllActionsFromElement(struct _hashElement *element);
     void deleteHashElement(struct _hashElement *element);
-    void actionAllocWithHashElement(struct _hashElement *element);
+    void releaseLater(Ref *object);
+    void releasePending();
+    void compactBatch(struct _actionBatch *batch);
+    void stepIntervalBatches(size_t *begin, float dt);
+    template <class T> void stepIntervalActions(struct _actionBatch *batch, size_t begin, float dt);
+    void stepActions(struct _actionBatch *batch, size_t begin, float dt);
 
 protected:
     struct _hashElement    *_targets;
-    struct _hashElement    *_currentTarget;
-    bool            _currentTargetSalvaged;
+    struct _actionStorage  *_storage;   // dense storage of the running actions
+    bool            _updating;
 };
 
 // end of actions group
@@ -210,7 +210,7 @@ void ClippingNode::visit(Renderer *renderer, const Mat4 &parentTransform, bool p
     
     bool dirty = parentTransformUpdated || _transformUpdated;
     if(dirty)
-        _modelViewTransform = transform(parentTransform);
+        updateModelViewTransform(parentTransform);
     _transformUpdated = false;
 
     // IMPORTANT:
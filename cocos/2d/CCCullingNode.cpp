@@ -0,0 +1,414 @@
+/****************************************************************************
+ Copyright (c) 2013-2014 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "2d/CCCullingNode.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/CCDirector.h"
+#include "math/CCAffineTransform.h"
+
+NS_CC_BEGIN
+
+// children spanning more cells than this are tested one by one every frame
+static const int64_t MAX_CELLS_PER_CHILD = 64;
+
+static inline int64_t cellKey(int x, int y)
+{
+    return ((int64_t)x << 32) | (uint32_t)y;
+}
+
+// keeps huge or degenerate coordinates (e.g. a zero scale) inside the int range
+static inline int cellCoord(float value, float cellSize)
+{
+    static const float LIMIT = (float)(1 << 30);
+
+    float cell = floorf(value / cellSize);
+    if (cell != cell)
+        return 0;
+    return (int)std::max(-LIMIT, std::min(LIMIT, cell));
+}
+
+// bounds of the node and all its descendants, in the space described by toContainer
+static Rect subtreeBounds(Node* node, const AffineTransform& toContainer)
+{
+    const Size& size = node->getContentSize();
+    Rect bounds = RectApplyAffineTransform(Rect(0, 0, size.width, size.height), toContainer);
+
+    for (const auto& child : node->getChildren())
+    {
+        AffineTransform t = AffineTransformConcat(child->getNodeToParentAffineTransform(), toContainer);
+        bounds = bounds.unionWithRect(subtreeBounds(child, t));
+    }
+
+    return bounds;
+}
+
+CullingNode* CullingNode::create(float cellSize)
+{
+    CullingNode * ret = new CullingNode();
+    if (ret && ret->initWithCellSize(cellSize))
+    {
+        ret->autorelease();
+    }
+    else
+    {
+        CC_SAFE_DELETE(ret);
+    }
+    return ret;
+}
+
+CullingNode::CullingNode()
+: _cellSize(256)
+, _cullingMargin(0)
+, _indexDirty(true)
+, _visitedChildrenCount(0)
+, _culledChildrenCount(0)
+{
+}
+
+CullingNode::~CullingNode()
+{
+}
+
+bool CullingNode::initWithCellSize(float cellSize)
+{
+    if (!Node::init())
+    {
+        return false;
+    }
+
+    CCASSERT(cellSize > 0, "cellSize must be positive");
+    _cellSize = cellSize;
+    return true;
+}
+
+void CullingNode::setCellSize(float cellSize)
+{
+    CCASSERT(cellSize > 0, "cellSize must be positive");
+    _cellSize = cellSize;
+    _indexDirty = true;
+}
+
+void CullingNode::updateChildBounds(Node* child)
+{
+    ssize_t index = _children.getIndex(child);
+    if (index >= 0 && index < (ssize_t)_entries.size())
+    {
+        _entries[index].boundsDirty = true;
+    }
+}
+
+void CullingNode::addChild(Node* child, int localZOrder, int tag)
+{
+    Node::addChild(child, localZOrder, tag);
+    _indexDirty = true;
+}
+
+void CullingNode::removeChild(Node* child, bool cleanup)
+{
+    Node::removeChild(child, cleanup);
+    _indexDirty = true;
+}
+
+void CullingNode::removeAllChildrenWithCleanup(bool cleanup)
+{
+    Node::removeAllChildrenWithCleanup(cleanup);
+    _indexDirty = true;
+}
+
+void CullingNode::sortAllChildren()
+{
+    // sorting moves the children, so the entries no longer line up with them
+    if (_reorderChildDirty)
+    {
+        _indexDirty = true;
+    }
+    Node::sortAllChildren();
+}
+
+void CullingNode::rebuildIndex()
+{
+    _cells.clear();
+    _largeEntries.clear();
+
+    ChildEntry empty = ChildEntry();
+    empty.maxCellX = -1;    // not inserted in any cell
+
+    _entries.assign(_children.size(), empty);
+    for (ssize_t i = 0; i < (ssize_t)_entries.size(); ++i)
+    {
+        updateEntry(i, true);
+    }
+
+    _indexDirty = false;
+}
+
+void CullingNode::updateIndex()
+{
+    if (_indexDirty || _entries.size() != (size_t)_children.size())
+    {
+        rebuildIndex();
+        return;
+    }
+
+    for (ssize_t i = 0; i < (ssize_t)_entries.size(); ++i)
+    {
+        updateEntry(i, false);
+    }
+}
+
+void CullingNode::updateEntry(ssize_t index, bool force)
+{
+    ChildEntry& entry = _entries[index];
+    Node* child = _children.at(index);
+
+    const Mat4& t = child->getNodeToParentTransform();
+    const float transform[6] = { t.m[0], t.m[1], t.m[4], t.m[5], t.m[12], t.m[13] };
+    const Size& contentSize = child->getContentSize();
+
+    if (!force && !entry.boundsDirty
+        && memcmp(transform, entry.transform, sizeof(transform)) == 0
+        && contentSize.equals(entry.contentSize))
+    {
+        return;
+    }
+
+    memcpy(entry.transform, transform, sizeof(transform));
+    entry.contentSize = contentSize;
+    entry.boundsDirty = false;
+
+    AffineTransform toContainer = AffineTransformMake(transform[0], transform[1], transform[2], transform[3], transform[4], transform[5]);
+    entry.bounds = subtreeBounds(child, toContainer);
+
+    removeEntry(index);
+    insertEntry(index);
+}
+
+void CullingNode::insertEntry(ssize_t index)
+{
+    ChildEntry& entry = _entries[index];
+
+    entry.minCellX = cellCoord(entry.bounds.getMinX(), _cellSize);
+    entry.minCellY = cellCoord(entry.bounds.getMinY(), _cellSize);
+    entry.maxCellX = cellCoord(entry.bounds.getMaxX(), _cellSize);
+    entry.maxCellY = cellCoord(entry.bounds.getMaxY(), _cellSize);
+
+    int64_t cellCount = (int64_t)(entry.maxCellX - entry.minCellX + 1) * (entry.maxCellY - entry.minCellY + 1);
+    entry.large = cellCount > MAX_CELLS_PER_CHILD;
+
+    if (entry.large)
+    {
+        _largeEntries.push_back(index);
+        return;
+    }
+
+    for (int x = entry.minCellX; x <= entry.maxCellX; ++x)
+    {
+        for (int y = entry.minCellY; y <= entry.maxCellY; ++y)
+        {
+            _cells[cellKey(x, y)].push_back(index);
+        }
+    }
+}
+
+void CullingNode::removeEntry(ssize_t index)
+{
+    ChildEntry& entry = _entries[index];
+
+    if (entry.large)
+    {
+        _largeEntries.erase(std::find(_largeEntries.begin(), _largeEntries.end(), index));
+        entry.large = false;
+        return;
+    }
+
+    for (int x = entry.minCellX; x <= entry.maxCellX; ++x)
+    {
+        for (int y = entry.minCellY; y <= entry.maxCellY; ++y)
+        {
+            auto iter = _cells.find(cellKey(x, y));
+            if (iter == _cells.end())
+                continue;
+
+            auto& cell = iter->second;
+            cell.erase(std::find(cell.begin(), cell.end(), index));
+            if (cell.empty())
+                _cells.erase(iter);
+        }
+    }
+    entry.maxCellX = entry.minCellX - 1;
+}
+
+void CullingNode::markVisibleChildren()
+{
+    for (auto& entry : _entries)
+    {
+        entry.wasVisible = entry.visible;
+        entry.visible = false;
+    }
+
+    // window rectangle in our coordinate system
+    const Size& winSize = Director::getInstance()->getWinSize();
+    Rect screen(-_cullingMargin, -_cullingMargin, winSize.width + _cullingMargin * 2, winSize.height + _cullingMargin * 2);
+    Rect visibleRect = RectApplyTransform(screen, _modelViewTransform.getInversed());
+
+    int minCellX = cellCoord(visibleRect.getMinX(), _cellSize);
+    int minCellY = cellCoord(visibleRect.getMinY(), _cellSize);
+    int maxCellX = cellCoord(visibleRect.getMaxX(), _cellSize);
+    int maxCellY = cellCoord(visibleRect.getMaxY(), _cellSize);
+    int64_t cellCount = (int64_t)(maxCellX - minCellX + 1) * (maxCellY - minCellY + 1);
+
+    if (cellCount > (int64_t)_cells.size())
+    {
+        // zoomed out: testing the occupied cells is cheaper than walking the visible ones
+        for (const auto& cell : _cells)
+        {
+            int x = (int)(cell.first >> 32);
+            int y = (int)(int32_t)(cell.first & 0xffffffff);
+            if (x < minCellX || x > maxCellX || y < minCellY || y > maxCellY)
+                continue;
+
+            for (auto index : cell.second)
+            {
+                auto& entry = _entries[index];
+                entry.visible = entry.visible || entry.bounds.intersectsRect(visibleRect);
+            }
+        }
+    }
+    else
+    {
+        for (int x = minCellX; x <= maxCellX; ++x)
+        {
+            for (int y = minCellY; y <= maxCellY; ++y)
+            {
+                auto iter = _cells.find(cellKey(x, y));
+                if (iter == _cells.end())
+                    continue;
+
+                for (auto index : iter->second)
+                {
+                    auto& entry = _entries[index];
+                    entry.visible = entry.visible || entry.bounds.intersectsRect(visibleRect);
+                }
+            }
+        }
+    }
+
+    for (auto index : _largeEntries)
+    {
+        auto& entry = _entries[index];
+        entry.visible = entry.bounds.intersectsRect(visibleRect);
+    }
+}
+
+bool CullingNode::visitChild(ssize_t index, Renderer *renderer, bool dirty)
+{
+    ChildEntry& entry = _entries[index];
+    if (!entry.visible)
+    {
+        ++_culledChildrenCount;
+        return false;
+    }
+
+    // a child that was skipped last frame may have missed a transform update of ours
+    _children.at(index)->visit(renderer, _modelViewTransform, dirty || !entry.wasVisible);
+    ++_visitedChildrenCount;
+    return true;
+}
+
+void CullingNode::visit(Renderer *renderer, const Mat4 &parentTransform, bool parentTransformUpdated)
+{
+    // quick return if not visible. children won't be drawn.
+    if (!_visible)
+    {
+        return;
+    }
+
+    bool dirty = parentTransformUpdated || _transformUpdated;
+    if(dirty)
+        updateModelViewTransform(parentTransform);
+    _transformUpdated = false;
+
+    // IMPORTANT:
+    // To ease the migration to v3.0, we still support the Mat4 stack,
+    // but it is deprecated and your code should not rely on it
+    Director* director = Director::getInstance();
+    CCASSERT(nullptr != director, "Director is null when seting matrix stack");
+    director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+    director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+
+    _visitedChildrenCount = 0;
+    _culledChildrenCount = 0;
+
+    if(!_children.empty())
+    {
+        sortAllChildren();
+        updateIndex();
+
+        if (TransformIsAffine2D(_modelViewTransform))
+        {
+            markVisibleChildren();
+        }
+        else
+        {
+            // the window can't be mapped back to a rectangle in our space
+            for (auto& entry : _entries)
+            {
+                entry.wasVisible = entry.visible;
+                entry.visible = true;
+            }
+        }
+
+        ssize_t i = 0;
+        ssize_t count = _children.size();
+
+        // draw children zOrder < 0
+        for( ; i < count; i++ )
+        {
+            if (_children.at(i)->getLocalZOrder() < 0)
+                visitChild(i, renderer, dirty);
+            else
+                break;
+        }
+        // self draw
+        this->draw(renderer, _modelViewTransform, dirty);
+
+        for( ; i < count; i++ )
+            visitChild(i, renderer, dirty);
+    }
+    else
+    {
+        this->draw(renderer, _modelViewTransform, dirty);
+    }
+
+    // reset for next frame
+    _orderOfArrival = 0;
+
+    director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+}
+
+NS_CC_END
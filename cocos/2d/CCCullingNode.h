@@ -0,0 +1,120 @@
+/****************************************************************************
+ Copyright (c) 2013-2014 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __MISCNODE_CCCULLING_NODE_H__
+#define __MISCNODE_CCCULLING_NODE_H__
+
+#include <unordered_map>
+#include <vector>
+
+#include "2d/CCNode.h"
+
+NS_CC_BEGIN
+
+/**
+ * 按空间网格剔除子节点的容器节点。
+ * 每个子节点连同它的子树的包围盒 (在 CullingNode 坐标系中) 都缓存在一个均匀网格里,
+ * visit 时只访问与屏幕相交的格子中的子节点, 完全在屏幕外的子树不会被遍历。
+ *
+ * 子节点自身的变换或 contentSize 改变时包围盒会自动更新;
+ * 子树内部的节点移动后需要调用 updateChildBounds()。
+ * 包围盒由 contentSize 计算, 绘制范围超出 contentSize 的节点 (例如粒子系统) 可以用 setCullingMargin() 放宽。
+ * 模型视图矩阵不是 2D 仿射变换时 (3D 旋转等) 会访问所有子节点。
+ */
+class CC_DLL CullingNode : public Node
+{
+public:
+    /** 用给定的格子大小 (points) 创建 CullingNode */
+    static CullingNode* create(float cellSize = 256);
+
+    /** 设置网格的格子大小, 会重建索引 */
+    void setCellSize(float cellSize);
+    float getCellSize() const { return _cellSize; }
+
+    /** 屏幕矩形向外扩展的距离 (points), 默认为 0 */
+    void setCullingMargin(float margin) { _cullingMargin = margin; }
+    float getCullingMargin() const { return _cullingMargin; }
+
+    /** 子节点的子树内部发生变化后, 重新计算它的包围盒 */
+    void updateChildBounds(Node* child);
+
+    /** 上一帧访问的子节点数量 */
+    ssize_t getVisitedChildrenCount() const { return _visitedChildrenCount; }
+    /** 上一帧被剔除的子节点数量 */
+    ssize_t getCulledChildrenCount() const { return _culledChildrenCount; }
+
+    // overrides
+    using Node::addChild;
+    virtual void addChild(Node* child, int localZOrder, int tag) override;
+    virtual void removeChild(Node* child, bool cleanup = true) override;
+    virtual void removeAllChildrenWithCleanup(bool cleanup) override;
+    virtual void sortAllChildren() override;
+    virtual void visit(Renderer *renderer, const Mat4 &parentTransform, bool parentTransformUpdated) override;
+
+CC_CONSTRUCTOR_ACCESS:
+    CullingNode();
+    virtual ~CullingNode();
+
+    bool initWithCellSize(float cellSize);
+
+protected:
+    struct ChildEntry
+    {
+        float transform[6];     ///< 上次计算包围盒时子节点的 a, b, c, d, tx, ty
+        Size contentSize;       ///< 上次计算包围盒时子节点的 contentSize
+        Rect bounds;            ///< 子树在 CullingNode 坐标系中的包围盒
+        int minCellX, minCellY, maxCellX, maxCellY;
+        bool large;             ///< 跨越太多格子, 每帧单独测试
+        bool boundsDirty;
+        bool visible;           ///< 这一帧是否可见
+        bool wasVisible;        ///< 上一帧是否可见
+    };
+
+    void rebuildIndex();
+    void updateIndex();
+    void updateEntry(ssize_t index, bool force);
+    void insertEntry(ssize_t index);
+    void removeEntry(ssize_t index);
+    void markVisibleChildren();
+    bool visitChild(ssize_t index, Renderer *renderer, bool dirty);
+
+    float _cellSize;
+    float _cullingMargin;
+    bool _indexDirty;
+
+    std::vector<ChildEntry> _entries;           ///< 和 _children 一一对应
+    std::unordered_map<int64_t, std::vector<ssize_t>> _cells;
+    std::vector<ssize_t> _largeEntries;
+
+    ssize_t _visitedChildrenCount;
+    ssize_t _culledChildrenCount;
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(CullingNode);
+};
+
+NS_CC_END
+
+#endif // __MISCNODE_CCCULLING_NODE_H__
@@ -1083,7 +1083,7 @@ void Label::visit(Renderer *renderer, const Mat4 &parentTransform, bool parentTr
 
     if(dirty)
     {
-        _modelViewTransform = transform(parentTransform);
+        updateModelViewTransform(parentTransform);
     }
     _transformUpdated = false;
 
@@ -91,6 +91,9 @@ Node::Node(void)
 , _transformDirty(true)
 , _inverseDirty(true)
 , _transformUpdated(true)
+, _modelViewVersion(0)
+, _parentModelViewVersion(0)
+, _modelViewTranslatedOnly(false)
 // children (lazy allocs)
 // lazy alloc
 , _localZOrder(0)
@@ -232,10 +235,13 @@ void Node::setLocalZOrder(int z)
     _localZOrder = z;
     if (_parent)
     {
+        // marks the node dirty for the event dispatcher as well
         _parent->reorderChild(this, z);
     }
-
-    _eventDispatcher->setDirtyForNode(this);
+    else
+    {
+        _eventDispatcher->setDirtyForNode(this);
+    }
 }
 
 void Node::setGlobalZOrder(float globalZOrder)
@@ -575,6 +581,8 @@ bool Node::isRunning() const
 void Node::setParent(Node * var)
 {
     _parent = var;
+    // versions are per node, one taken from the old parent means nothing here
+    _parentModelViewVersion = 0;
 }
 
 /// isRelativeAnchorPoint getter
@@ -927,6 +935,7 @@ void Node::reorderChild(Node *child, int zOrder)
     _reorderChildDirty = true;
     child->setOrderOfArrival(s_globalOrderOfArrival++);
     child->_setLocalZOrder(zOrder);
+    _eventDispatcher->setDirtyForNode(child);
 }
 
 void Node::sortAllChildren()
@@ -964,7 +973,7 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, bool parentTra
 
     bool dirty = _transformUpdated || parentTransformUpdated;
     if(dirty)
-        _modelViewTransform = this->transform(parentTransform);
+        updateModelViewTransform(parentTransform);
     _transformUpdated = false;
 
 
@@ -1008,11 +1017,82 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, bool parentTra
     director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
 }
 
+static Node::TransformStats s_transformStats = { 0, 0, 0 };
+
+const Node::TransformStats& Node::getTransformStats()
+{
+    return s_transformStats;
+}
+
+void Node::resetTransformStats()
+{
+    s_transformStats.fullMultiplies = 0;
+    s_transformStats.affineMultiplies = 0;
+    s_transformStats.translations = 0;
+}
+
+// the last row is (0, 0, 0, 1): translating the parent only translates the product
+static inline bool isAffineTransform(const Mat4& m)
+{
+    return m.m[3] == 0 && m.m[7] == 0 && m.m[11] == 0 && m.m[15] == 1;
+}
+
 Mat4 Node::transform(const Mat4& parentTransform)
 {
-    Mat4 ret = this->getNodeToParentTransform();
-    ret  = parentTransform * ret;
-    return ret;
+    const Mat4& local = this->getNodeToParentTransform();
+
+    if (TransformIsAffine2D(parentTransform) && TransformIsAffine2D(local))
+    {
+        Mat4 ret;
+        TransformConcatAffine2D(parentTransform, local, &ret);
+        ++s_transformStats.affineMultiplies;
+        return ret;
+    }
+
+    ++s_transformStats.fullMultiplies;
+    return parentTransform * local;
+}
+
+void Node::updateModelViewTransform(const Mat4& parentTransform)
+{
+    bool fromParent = _parent && &parentTransform == &_parent->_modelViewTransform;
+
+    // Only the parent's translation changed since our matrix was computed and our local
+    // transform did not change: with an affine local transform the rotation/scale columns
+    // of P * L stay the same, so only the translation column has to be recomputed.
+    if (fromParent && !_transformUpdated
+        && _parentModelViewVersion != 0
+        && _parent->_modelViewVersion == _parentModelViewVersion + 1
+        && _parent->_modelViewTranslatedOnly
+        && isAffineTransform(getNodeToParentTransform()))
+    {
+        const float* p = parentTransform.m;
+        const float* l = getNodeToParentTransform().m;
+        _modelViewTransform.m[12] = p[0] * l[12] + p[4] * l[13] + p[8]  * l[14] + p[12];
+        _modelViewTransform.m[13] = p[1] * l[12] + p[5] * l[13] + p[9]  * l[14] + p[13];
+        _modelViewTransform.m[14] = p[2] * l[12] + p[6] * l[13] + p[10] * l[14] + p[14];
+        _modelViewTranslatedOnly = true;
+        ++s_transformStats.translations;
+    }
+    else
+    {
+        Mat4 mv = this->transform(parentTransform);
+
+        // let the children take the fast path when only our translation changed
+        const float* o = _modelViewTransform.m;
+        _modelViewTranslatedOnly = _modelViewVersion != 0
+            && mv.m[0] == o[0] && mv.m[1] == o[1] && mv.m[2] == o[2] && mv.m[3] == o[3]
+            && mv.m[4] == o[4] && mv.m[5] == o[5] && mv.m[6] == o[6] && mv.m[7] == o[7]
+            && mv.m[8] == o[8] && mv.m[9] == o[9] && mv.m[10] == o[10] && mv.m[11] == o[11]
+            && mv.m[15] == o[15];
+        _modelViewTransform = mv;
+    }
+
+    _parentModelViewVersion = fromParent ? _parent->_modelViewVersion : 0;
+
+    // 0 is reserved for "never computed"
+    if (++_modelViewVersion == 0)
+        _modelViewVersion = 1;
 }
 
 
@@ -1404,16 +1484,20 @@ const Mat4& Node::getNodeToParentTransform() const
             _transform = _transform * rotX;
         }
 
-        // XXX: Try to inline skew
         // If skew is needed, apply skew and then anchor point
         if (needsSkewMatrix)
         {
-            Mat4 skewMatrix(1, (float)tanf(CC_DEGREES_TO_RADIANS(_skewY)), 0, 0,
-                              (float)tanf(CC_DEGREES_TO_RADIANS(_skewX)), 1, 0, 0,
-                              0,  0,  1, 0,
-                              0,  0,  0, 1);
-
-            _transform = _transform * skewMatrix;
+            // Multiplying by the skew matrix on the right only mixes the first two columns
+            float skewX = tanf(CC_DEGREES_TO_RADIANS(_skewX));
+            float skewY = tanf(CC_DEGREES_TO_RADIANS(_skewY));
+            float* m = _transform.m;
+            for (int row = 0; row < 4; ++row)
+            {
+                float col0 = m[row];
+                float col1 = m[4 + row];
+                m[row]     = col0 + col1 * skewX;
+                m[4 + row] = col0 * skewY + col1;
+            }
 
             // adjust anchor point
             if (!_anchorPointInPoints.equals(Vec2::ZERO))
@@ -1427,7 +1511,10 @@ const Mat4& Node::getNodeToParentTransform() const
 
         if (_useAdditionalTransform)
         {
-            _transform = _transform * _additionalTransform;
+            if (TransformIsAffine2D(_transform) && TransformIsAffine2D(_additionalTransform))
+                TransformConcatAffine2D(_transform, _additionalTransform, &_transform);
+            else
+                _transform = _transform * _additionalTransform;
         }
 
         _transformDirty = false;
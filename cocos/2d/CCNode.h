@@ -932,6 +932,18 @@ public:
     virtual void visit(Renderer *renderer, const Mat4& parentTransform, bool parentTransformUpdated);
     virtual void visit() final;
 
+    /** 每帧 visit 中模型视图矩阵的计算统计 */
+    struct TransformStats
+    {
+        unsigned int fullMultiplies;    ///< 使用完整 4x4 矩阵乘法计算的数量
+        unsigned int affineMultiplies;  ///< 使用 2D 仿射乘法计算的数量
+        unsigned int translations;      ///< 父节点只有平移改变, 只更新平移部分的数量
+    };
+
+    /** 返回当前帧的矩阵计算统计, Director 在每帧开始时调用 resetTransformStats() 清零 */
+    static const TransformStats& getTransformStats();
+    static void resetTransformStats();
+
 
     /** 返回包含Node(节点)的Scene（场景）。
      如果这个节点不属于任何的场景，它将返回`nullptr`。
@@ -1230,6 +1242,13 @@ public:
     virtual Mat4 getWorldToNodeTransform() const;
     virtual AffineTransform getWorldToNodeAffineTransform() const;
 
+    /**
+     * 返回模型视图矩阵的版本, visit 重新计算矩阵(包括祖先变换改变导致的重算)时改变, 可用来缓存世界坐标系下的数据.
+     * 节点自身有尚未被 visit 应用的变换, 或者从未被 visit 过时返回 0, 表示不能使用缓存.
+     * @note 祖先在本帧 visit 之前的变换不会反映出来
+     */
+    unsigned int getModelViewVersion() const { return _transformUpdated ? 0 : _modelViewVersion; }
+
 
     /** @deprecated Use getWorldToNodeTransform() instead */
     CC_DEPRECATED_ATTRIBUTE inline virtual AffineTransform worldToNodeTransform() const { return getWorldToNodeAffineTransform(); }
@@ -1363,6 +1382,9 @@ protected:
 
     Mat4 transform(const Mat4 &parentTransform);
 
+    /** 更新 _modelViewTransform。如果只有父节点的平移改变了, 直接平移缓存的矩阵而不重新相乘 */
+    void updateModelViewTransform(const Mat4 &parentTransform);
+
     virtual void updateCascadeOpacity();
     virtual void disableCascadeOpacity();
     virtual void updateCascadeColor();
@@ -1407,6 +1429,10 @@ protected:
     bool _useAdditionalTransform;   ///< The flag to check whether the additional transform is dirty
     bool _transformUpdated;         ///< 是否Transform 对象在最后一帧更新了
 
+    unsigned int _modelViewVersion;       ///< _modelViewTransform 每次更新时递增
+    unsigned int _parentModelViewVersion; ///< 上次更新时父节点的 _modelViewVersion, 0 表示不是用父节点的矩阵计算的
+    bool _modelViewTranslatedOnly;        ///< 上次更新是否只改变了 _modelViewTransform 的平移部分
+
     int _localZOrder;               ///< Local 顺序 (和兄妹节点相关) 被用于节点的排序
     float _globalZOrder;            ///< Global 顺序 用于节点的排序
 
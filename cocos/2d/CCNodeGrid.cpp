@@ -96,7 +96,7 @@ void NodeGrid::visit(Renderer *renderer, const Mat4 &parentTransform, bool paren
 
     bool dirty = parentTransformUpdated || _transformUpdated;
     if(dirty)
-        _modelViewTransform = this->transform(parentTransform);
+        updateModelViewTransform(parentTransform);
     _transformUpdated = false;
 
     // IMPORTANT:
@@ -137,7 +137,7 @@ void ParticleBatchNode::visit(Renderer *renderer, const Mat4 &parentTransform, b
 
     bool dirty = parentTransformUpdated || _transformUpdated;
     if(dirty)
-        _modelViewTransform = transform(parentTransform);
+        updateModelViewTransform(parentTransform);
     _transformUpdated = false;
 
     // IMPORTANT:
@@ -56,6 +56,7 @@ THE SOFTWARE.
 #include "base/ZipUtils.h"
 #include "base/CCDirector.h"
 #include "base/CCProfiling.h"
+#include "base/CCThreadPool.h"
 // opengl
 #include "CCGL.h"
 
@@ -81,12 +82,111 @@ NS_CC_BEGIN
 //  cocos2d uses a another approach, but the results are almost identical. 
 //
 
+static bool s_parallelUpdateEnabled = false;
+static std::vector<ParticleSystem*> s_pendingSystems;
+
+ParticleData::ParticleData()
+: _buffer(nullptr)
+, _maxCount(0)
+{
+    assignArrays(nullptr, 0);
+}
+
+ParticleData::~ParticleData()
+{
+    release();
+}
+
+bool ParticleData::init(int count)
+{
+    // every attribute lives in its own array inside one allocation; arrays are
+    // padded to a multiple of 4 elements so each one starts 16 byte aligned
+    static const int ATTRIBUTE_COUNT = 26; // 25 float arrays + atlasIndex
+    size_t stride = (MAX(count, 1) + 3) & ~3;
+    void* buffer = calloc(stride * ATTRIBUTE_COUNT, sizeof(float));
+    if (!buffer)
+    {
+        return false;
+    }
+
+    release();
+    _buffer = buffer;
+    _maxCount = count;
+
+    assignArrays((float*)buffer, stride);
+
+    return true;
+}
+
+void ParticleData::release()
+{
+    CC_SAFE_FREE(_buffer);
+    assignArrays(nullptr, 0);
+    _maxCount = 0;
+}
+
+void ParticleData::assignArrays(float* buffer, size_t stride)
+{
+    float** arrays[] = {
+        &posx, &posy, &startPosX, &startPosY,
+        &colorR, &colorG, &colorB, &colorA,
+        &deltaColorR, &deltaColorG, &deltaColorB, &deltaColorA,
+        &size, &deltaSize, &rotation, &deltaRotation, &timeToLive,
+        &modeA.dirX, &modeA.dirY, &modeA.radialAccel, &modeA.tangentialAccel,
+        &modeB.angle, &modeB.degreesPerSecond, &modeB.radius, &modeB.deltaRadius,
+    };
+    for (auto array : arrays)
+    {
+        *array = buffer;
+        buffer += stride;
+    }
+    static_assert(sizeof(unsigned int) == sizeof(float), "atlasIndex shares the float buffer");
+    atlasIndex = (unsigned int*)buffer;
+}
+
+void ParticleData::copyParticle(int dst, int src)
+{
+    posx[dst] = posx[src];
+    posy[dst] = posy[src];
+    startPosX[dst] = startPosX[src];
+    startPosY[dst] = startPosY[src];
+
+    colorR[dst] = colorR[src];
+    colorG[dst] = colorG[src];
+    colorB[dst] = colorB[src];
+    colorA[dst] = colorA[src];
+
+    deltaColorR[dst] = deltaColorR[src];
+    deltaColorG[dst] = deltaColorG[src];
+    deltaColorB[dst] = deltaColorB[src];
+    deltaColorA[dst] = deltaColorA[src];
+
+    size[dst] = size[src];
+    deltaSize[dst] = deltaSize[src];
+
+    rotation[dst] = rotation[src];
+    deltaRotation[dst] = deltaRotation[src];
+
+    timeToLive[dst] = timeToLive[src];
+
+    atlasIndex[dst] = atlasIndex[src];
+
+    modeA.dirX[dst] = modeA.dirX[src];
+    modeA.dirY[dst] = modeA.dirY[src];
+    modeA.radialAccel[dst] = modeA.radialAccel[src];
+    modeA.tangentialAccel[dst] = modeA.tangentialAccel[src];
+
+    modeB.angle[dst] = modeB.angle[src];
+    modeB.degreesPerSecond[dst] = modeB.degreesPerSecond[src];
+    modeB.radius[dst] = modeB.radius[src];
+    modeB.deltaRadius[dst] = modeB.deltaRadius[src];
+}
+
 ParticleSystem::ParticleSystem()
 : _isBlendAdditive(false)
 , _isAutoRemoveOnFinish(false)
 , _plistFile("")
 , _elapsed(0)
-, _particles(nullptr)
 , _configName("")
 , _emitCounter(0)
 , _particleIdx(0)
@@ -119,7 +219,16 @@ ParticleSystem::ParticleSystem()
 , _opacityModifyRGB(false)
 , _yCoordFlipped(1)
 , _positionType(PositionType::FREE)
+, _randomSeed(0)
+, _randomState(0)
+, _emitterPosition(Vec2::ZERO)
+, _pendingDelta(0)
+, _pendingUpdate(false)
+, _pendingAlive(true)
 {
+    // seed from rand() so srand() still makes the whole scene reproducible
+    setRandomSeed(rand());
+
     modeA.gravity = Vec2::ZERO;
     modeA.speed = 0;
     modeA.speedVar = 0;
@@ -433,11 +542,7 @@ bool ParticleSystem::initWithTotalParticles(int numberOfParticles)
 {
     _totalParticles = numberOfParticles;
 
-    CC_SAFE_FREE(_particles);
-    
-    _particles = (tParticle*)calloc(_totalParticles, sizeof(tParticle));
-
-    if( ! _particles )
+    if( ! _particleData.init(_totalParticles) )
     {
         CCLOG("Particle system: not enough memory");
         this->release();
@@ -449,7 +554,7 @@ bool ParticleSystem::initWithTotalParticles(int numberOfParticles)
     {
         for (int i = 0; i < _totalParticles; i++)
         {
-            _particles[i].atlasIndex=i;
+            _particleData.atlasIndex[i]=i;
         }
     }
     // default, active
@@ -470,9 +575,6 @@ bool ParticleSystem::initWithTotalParticles(int numberOfParticles)
 
     _isAutoRemoveOnFinish = false;
 
-    // Optimization: compile updateParticle method
-    //updateParticleSel = @selector(updateQuadWithParticle:newPosition:);
-    //updateParticleImp = (CC_UPDATE_PARTICLE_IMP) [self methodForSelector:updateParticleSel];
     //for batchNode
     _transformSystemDirty = false;
 
@@ -484,7 +586,7 @@ ParticleSystem::~ParticleSystem()
     // Since the scheduler retains the "target (in this case the ParticleSystem)
 	// it is not needed to call "unscheduleUpdate" here. In fact, it will be called in "cleanup"
     //unscheduleUpdate();
-    CC_SAFE_FREE(_particles);
+    _particleData.release();
     CC_SAFE_RELEASE(_texture);
 }
 
@@ -495,123 +597,174 @@ bool ParticleSystem::addParticle()
         return false;
     }
 
-    tParticle * particle = &_particles[ _particleCount ];
-    this->initParticle(particle);
-    ++_particleCount;
+    this->addParticles(1);
 
     return true;
 }
 
-void ParticleSystem::initParticle(tParticle* particle)
+void ParticleSystem::addParticles(int count)
 {
-    // timeToLive
-    // no negative life. prevent division by 0
-    particle->timeToLive = _life + _lifeVar * CCRANDOM_MINUS1_1();
-    particle->timeToLive = MAX(0, particle->timeToLive);
-
-    // position
-    particle->pos.x = _sourcePosition.x + _posVar.x * CCRANDOM_MINUS1_1();
-
-    particle->pos.y = _sourcePosition.y + _posVar.y * CCRANDOM_MINUS1_1();
-
-
-    // Color
-    Color4F start;
-    start.r = clampf(_startColor.r + _startColorVar.r * CCRANDOM_MINUS1_1(), 0, 1);
-    start.g = clampf(_startColor.g + _startColorVar.g * CCRANDOM_MINUS1_1(), 0, 1);
-    start.b = clampf(_startColor.b + _startColorVar.b * CCRANDOM_MINUS1_1(), 0, 1);
-    start.a = clampf(_startColor.a + _startColorVar.a * CCRANDOM_MINUS1_1(), 0, 1);
+    _emitterPosition = computeEmitterPosition();
+    this->emitParticles(count);
+}
 
-    Color4F end;
-    end.r = clampf(_endColor.r + _endColorVar.r * CCRANDOM_MINUS1_1(), 0, 1);
-    end.g = clampf(_endColor.g + _endColorVar.g * CCRANDOM_MINUS1_1(), 0, 1);
-    end.b = clampf(_endColor.b + _endColorVar.b * CCRANDOM_MINUS1_1(), 0, 1);
-    end.a = clampf(_endColor.a + _endColorVar.a * CCRANDOM_MINUS1_1(), 0, 1);
+Vec2 ParticleSystem::computeEmitterPosition()
+{
+    if (_positionType == PositionType::FREE)
+    {
+        return this->convertToWorldSpace(Vec2::ZERO);
+    }
+    else if (_positionType == PositionType::RELATIVE)
+    {
+        return _position;
+    }
+    return Vec2::ZERO;
+}
 
-    particle->color = start;
-    particle->deltaColor.r = (end.r - start.r) / particle->timeToLive;
-    particle->deltaColor.g = (end.g - start.g) / particle->timeToLive;
-    particle->deltaColor.b = (end.b - start.b) / particle->timeToLive;
-    particle->deltaColor.a = (end.a - start.a) / particle->timeToLive;
+void ParticleSystem::emitParticles(int count)
+{
+    count = MIN(count, _totalParticles - _particleCount);
+    if (count <= 0)
+    {
+        return;
+    }
 
-    // size
-    float startS = _startSize + _startSizeVar * CCRANDOM_MINUS1_1();
-    startS = MAX(0, startS); // No negative value
+    // each attribute is generated in its own loop so every pass streams
+    // through a single array
+    int start = _particleCount;
+    int end = _particleCount + count;
 
-    particle->size = startS;
+    // timeToLive
+    // no negative life. prevent division by 0
+    float* timeToLive = _particleData.timeToLive;
+    for (int i = start; i < end; ++i)
+    {
+        timeToLive[i] = MAX(0, _life + _lifeVar * randomMinus1To1());
+    }
 
-    if (_endSize == START_SIZE_EQUAL_TO_END_SIZE)
+    // position
+    for (int i = start; i < end; ++i)
     {
-        particle->deltaSize = 0;
+        _particleData.posx[i] = _sourcePosition.x + _posVar.x * randomMinus1To1();
     }
-    else
+    for (int i = start; i < end; ++i)
     {
-        float endS = _endSize + _endSizeVar * CCRANDOM_MINUS1_1();
-        endS = MAX(0, endS); // No negative values
-        particle->deltaSize = (endS - startS) / particle->timeToLive;
+        _particleData.posy[i] = _sourcePosition.y + _posVar.y * randomMinus1To1();
     }
 
-    // rotation
-    float startA = _startSpin + _startSpinVar * CCRANDOM_MINUS1_1();
-    float endA = _endSpin + _endSpinVar * CCRANDOM_MINUS1_1();
-    particle->rotation = startA;
-    particle->deltaRotation = (endA - startA) / particle->timeToLive;
+    // color
+    auto initColor = [=](float* color, float* deltaColor, float startColor, float startColorVar, float endColor, float endColorVar) {
+        for (int i = start; i < end; ++i)
+        {
+            float startValue = clampf(startColor + startColorVar * randomMinus1To1(), 0, 1);
+            float endValue = clampf(endColor + endColorVar * randomMinus1To1(), 0, 1);
+            color[i] = startValue;
+            deltaColor[i] = (endValue - startValue) / timeToLive[i];
+        }
+    };
+    initColor(_particleData.colorR, _particleData.deltaColorR, _startColor.r, _startColorVar.r, _endColor.r, _endColorVar.r);
+    initColor(_particleData.colorG, _particleData.deltaColorG, _startColor.g, _startColorVar.g, _endColor.g, _endColorVar.g);
+    initColor(_particleData.colorB, _particleData.deltaColorB, _startColor.b, _startColorVar.b, _endColor.b, _endColorVar.b);
+    initColor(_particleData.colorA, _particleData.deltaColorA, _startColor.a, _startColorVar.a, _endColor.a, _endColorVar.a);
 
-    // position
-    if (_positionType == PositionType::FREE)
+    // size
+    for (int i = start; i < end; ++i)
     {
-        particle->startPos = this->convertToWorldSpace(Vec2::ZERO);
+        float startS = _startSize + _startSizeVar * randomMinus1To1();
+        startS = MAX(0, startS); // No negative value
+        _particleData.size[i] = startS;
+
+        if (_endSize == START_SIZE_EQUAL_TO_END_SIZE)
+        {
+            _particleData.deltaSize[i] = 0;
+        }
+        else
+        {
+            float endS = _endSize + _endSizeVar * randomMinus1To1();
+            endS = MAX(0, endS); // No negative values
+            _particleData.deltaSize[i] = (endS - startS) / timeToLive[i];
+        }
     }
-    else if (_positionType == PositionType::RELATIVE)
+
+    // rotation
+    for (int i = start; i < end; ++i)
     {
-        particle->startPos = _position;
+        float startA = _startSpin + _startSpinVar * randomMinus1To1();
+        float endA = _endSpin + _endSpinVar * randomMinus1To1();
+        _particleData.rotation[i] = startA;
+        _particleData.deltaRotation[i] = (endA - startA) / timeToLive[i];
     }
 
-    // direction
-    float a = CC_DEGREES_TO_RADIANS( _angle + _angleVar * CCRANDOM_MINUS1_1() );    
+    // position
+    for (int i = start; i < end; ++i)
+    {
+        _particleData.startPosX[i] = _emitterPosition.x;
+        _particleData.startPosY[i] = _emitterPosition.y;
+    }
 
     // Mode Gravity: A
     if (_emitterMode == Mode::GRAVITY)
     {
-        Vec2 v(cosf( a ), sinf( a ));
-        float s = modeA.speed + modeA.speedVar * CCRANDOM_MINUS1_1();
-
         // direction
-        particle->modeA.dir = v * s ;
+        for (int i = start; i < end; ++i)
+        {
+            float a = CC_DEGREES_TO_RADIANS( _angle + _angleVar * randomMinus1To1() );
+            float s = modeA.speed + modeA.speedVar * randomMinus1To1();
+            _particleData.modeA.dirX[i] = cosf( a ) * s;
+            _particleData.modeA.dirY[i] = sinf( a ) * s;
+        }
 
         // radial accel
-        particle->modeA.radialAccel = modeA.radialAccel + modeA.radialAccelVar * CCRANDOM_MINUS1_1();
- 
+        for (int i = start; i < end; ++i)
+        {
+            _particleData.modeA.radialAccel[i] = modeA.radialAccel + modeA.radialAccelVar * randomMinus1To1();
+        }
 
         // tangential accel
-        particle->modeA.tangentialAccel = modeA.tangentialAccel + modeA.tangentialAccelVar * CCRANDOM_MINUS1_1();
+        for (int i = start; i < end; ++i)
+        {
+            _particleData.modeA.tangentialAccel[i] = modeA.tangentialAccel + modeA.tangentialAccelVar * randomMinus1To1();
+        }
 
         // rotation is dir
-        if(modeA.rotationIsDir)
-            particle->rotation = -CC_RADIANS_TO_DEGREES(particle->modeA.dir.getAngle());
+        if (modeA.rotationIsDir)
+        {
+            for (int i = start; i < end; ++i)
+            {
+                _particleData.rotation[i] = -CC_RADIANS_TO_DEGREES(atan2f(_particleData.modeA.dirY[i], _particleData.modeA.dirX[i]));
+            }
+        }
     }
 
     // Mode Radius: B
-    else 
+    else
     {
         // Set the default diameter of the particle from the source position
-        float startRadius = modeB.startRadius + modeB.startRadiusVar * CCRANDOM_MINUS1_1();
-        float endRadius = modeB.endRadius + modeB.endRadiusVar * CCRANDOM_MINUS1_1();
+        for (int i = start; i < end; ++i)
+        {
+            float startRadius = modeB.startRadius + modeB.startRadiusVar * randomMinus1To1();
+            float endRadius = modeB.endRadius + modeB.endRadiusVar * randomMinus1To1();
 
-        particle->modeB.radius = startRadius;
+            _particleData.modeB.radius[i] = startRadius;
 
-        if (modeB.endRadius == START_RADIUS_EQUAL_TO_END_RADIUS)
-        {
-            particle->modeB.deltaRadius = 0;
+            if (modeB.endRadius == START_RADIUS_EQUAL_TO_END_RADIUS)
+            {
+                _particleData.modeB.deltaRadius[i] = 0;
+            }
+            else
+            {
+                _particleData.modeB.deltaRadius[i] = (endRadius - startRadius) / timeToLive[i];
+            }
         }
-        else
+
+        for (int i = start; i < end; ++i)
         {
-            particle->modeB.deltaRadius = (endRadius - startRadius) / particle->timeToLive;
+            _particleData.modeB.angle[i] = CC_DEGREES_TO_RADIANS( _angle + _angleVar * randomMinus1To1() );
+            _particleData.modeB.degreesPerSecond[i] = CC_DEGREES_TO_RADIANS(modeB.rotatePerSecond + modeB.rotatePerSecondVar * randomMinus1To1());
         }
+    }
 
-        particle->modeB.angle = a;
-        particle->modeB.degreesPerSecond = CC_DEGREES_TO_RADIANS(modeB.rotatePerSecond + modeB.rotatePerSecondVar * CCRANDOM_MINUS1_1());
-    }    
+    _particleCount += count;
 }
 
 void ParticleSystem::onEnter()
@@ -641,8 +794,7 @@ void ParticleSystem::resetSystem()
     _elapsed = 0;
     for (_particleIdx = 0; _particleIdx < _particleCount; ++_particleIdx)
     {
-        tParticle *p = &_particles[_particleIdx];
-        p->timeToLive = 0;
+        _particleData.timeToLive[_particleIdx] = 0;
     }
 }
 bool ParticleSystem::isFull()
@@ -653,8 +805,56 @@ bool ParticleSystem::isFull()
 // ParticleSystem - MainLoop
 void ParticleSystem::update(float dt)
 {
+    _emitterPosition = computeEmitterPosition();
+
+    if (s_parallelUpdateEnabled && !_batchNode)
+    {
+        // simulated together with the other emitters in updatePendingSystems()
+        if (!_pendingUpdate)
+        {
+            _pendingUpdate = true;
+            _pendingDelta = 0;
+            this->retain();
+            s_pendingSystems.push_back(this);
+        }
+        _pendingDelta += dt;
+        return;
+    }
+
     CC_PROFILER_START_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
 
+    if (!updateParticles(dt))
+    {
+        removeOnFinish();
+        return;
+    }
+
+    // only update gl buffer when visible
+    if (_visible && ! _batchNode)
+    {
+        postStep();
+    }
+
+    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+}
+
+bool ParticleSystem::updateParticles(float dt)
+{
+    if (!stepParticles(dt))
+    {
+        return false;
+    }
+
+    // update values in quad
+    _particleIdx = _particleCount;
+    updateParticleQuads();
+    _transformSystemDirty = false;
+
+    return true;
+}
+
+bool ParticleSystem::stepParticles(float dt)
+{
     if (_isActive && _emissionRate)
     {
         float rate = 1.0f / _emissionRate;
@@ -663,12 +863,14 @@ void ParticleSystem::update(float dt)
         {
             _emitCounter += dt;
         }
-        
-        while (_particleCount < _totalParticles && _emitCounter > rate) 
+
+        int emitCount = 0;
+        while (_particleCount + emitCount < _totalParticles && _emitCounter > rate)
         {
-            this->addParticle();
+            ++emitCount;
             _emitCounter -= rate;
         }
+        this->emitParticles(emitCount);
 
         _elapsed += dt;
         if (_duration != -1 && _duration < _elapsed)
@@ -677,154 +879,252 @@ void ParticleSystem::update(float dt)
         }
     }
 
-    _particleIdx = 0;
+    // life
+    float* timeToLive = _particleData.timeToLive;
+    for (int i = 0; i < _particleCount; ++i)
+    {
+        timeToLive[i] -= dt;
+    }
 
-    Vec2 currentPosition = Vec2::ZERO;
-    if (_positionType == PositionType::FREE)
+    // remove dead particles by moving the last particle into their slot.
+    // the moved particle is checked again since it may be dead as well
+    bool particleDied = false;
+    for (int i = 0; i < _particleCount; )
     {
-        currentPosition = this->convertToWorldSpace(Vec2::ZERO);
+        if (timeToLive[i] > 0)
+        {
+            ++i;
+            continue;
+        }
+
+        int last = _particleCount - 1;
+        unsigned int currentIndex = _particleData.atlasIndex[i];
+        if (i != last)
+        {
+            _particleData.copyParticle(i, last);
+        }
+        if (_batchNode)
+        {
+            //disable the switched particle
+            _batchNode->disableParticle(_atlasIndex+currentIndex);
+
+            //switch indexes
+            _particleData.atlasIndex[last] = currentIndex;
+        }
+
+        --_particleCount;
+        particleDied = true;
     }
-    else if (_positionType == PositionType::RELATIVE)
+
+    if (particleDied && _particleCount == 0 && _isAutoRemoveOnFinish)
     {
-        currentPosition = _position;
+        return false;
     }
 
+    const int count = _particleCount;
+    float* posx = _particleData.posx;
+    float* posy = _particleData.posy;
+
+    // Mode A: gravity, direction, tangential accel & radial accel
+    if (_emitterMode == Mode::GRAVITY)
     {
-        while (_particleIdx < _particleCount)
+        float* dirX = _particleData.modeA.dirX;
+        float* dirY = _particleData.modeA.dirY;
+        float* radialAccel = _particleData.modeA.radialAccel;
+        float* tangentialAccel = _particleData.modeA.tangentialAccel;
+        float gravityX = modeA.gravity.x;
+        float gravityY = modeA.gravity.y;
+        float posScale = dt * _yCoordFlipped;
+
+        for (int i = 0; i < count; ++i)
         {
-            tParticle *p = &_particles[_particleIdx];
+            // radial acceleration, tangential is radial rotated by 90 degrees
+            float x = posx[i];
+            float y = posy[i];
+            float lengthSquared = x * x + y * y;
+            float radialX = 0;
+            float radialY = 0;
+            if (lengthSquared > 0)
+            {
+                float invLength = 1.0f / sqrtf(lengthSquared);
+                radialX = x * invLength;
+                radialY = y * invLength;
+            }
 
-            // life
-            p->timeToLive -= dt;
+            // (gravity + radial + tangential) * dt
+            dirX[i] += (radialX * radialAccel[i] - radialY * tangentialAccel[i] + gravityX) * dt;
+            dirY[i] += (radialY * radialAccel[i] + radialX * tangentialAccel[i] + gravityY) * dt;
 
-            if (p->timeToLive > 0) 
-            {
-                // Mode A: gravity, direction, tangential accel & radial accel
-                if (_emitterMode == Mode::GRAVITY)
-                {
-                    Vec2 tmp, radial, tangential;
+            // this is cocos2d-x v3.0
+            posx[i] = x + dirX[i] * posScale;
+            posy[i] = y + dirY[i] * posScale;
+        }
+    }
 
-                    radial = Vec2::ZERO;
-                    // radial acceleration
-                    if (p->pos.x || p->pos.y)
-                    {
-                        radial = p->pos.getNormalized();
-                    }
-                    tangential = radial;
-                    radial = radial * p->modeA.radialAccel;
-
-                    // tangential acceleration
-                    float newy = tangential.x;
-                    tangential.x = -tangential.y;
-                    tangential.y = newy;
-                    tangential = tangential * p->modeA.tangentialAccel;
-
-                    // (gravity + radial + tangential) * dt
-                    tmp = radial + tangential + modeA.gravity;
-                    tmp = tmp * dt;
-                    p->modeA.dir = p->modeA.dir + tmp;
-                    
-                    // this is cocos2d-x v3.0
-//                    if (_configName.length()>0 && _yCoordFlipped != -1)
+    // Mode B: radius movement
+    else
+    {
+        float* angle = _particleData.modeB.angle;
+        float* radius = _particleData.modeB.radius;
+        float* degreesPerSecond = _particleData.modeB.degreesPerSecond;
+        float* deltaRadius = _particleData.modeB.deltaRadius;
 
-                    // this is cocos2d-x v3.0
-                    tmp = p->modeA.dir * dt * _yCoordFlipped;
-                    p->pos = p->pos + tmp;
-                }
+        // Update the angle and radius of the particle.
+        for (int i = 0; i < count; ++i)
+        {
+            angle[i] += degreesPerSecond[i] * dt;
+        }
+        for (int i = 0; i < count; ++i)
+        {
+            radius[i] += deltaRadius[i] * dt;
+        }
+        for (int i = 0; i < count; ++i)
+        {
+            posx[i] = - cosf(angle[i]) * radius[i];
+            posy[i] = - sinf(angle[i]) * radius[i] * _yCoordFlipped;
+        }
+    }
 
-                // Mode B: radius movement
-                else 
-                {                
-                    // Update the angle and radius of the particle.
-                    p->modeB.angle += p->modeB.degreesPerSecond * dt;
-                    p->modeB.radius += p->modeB.deltaRadius * dt;
+    // color
+    auto integrate = [=](float* value, const float* delta) {
+        for (int i = 0; i < count; ++i)
+        {
+            value[i] += delta[i] * dt;
+        }
+    };
+    integrate(_particleData.colorR, _particleData.deltaColorR);
+    integrate(_particleData.colorG, _particleData.deltaColorG);
+    integrate(_particleData.colorB, _particleData.deltaColorB);
+    integrate(_particleData.colorA, _particleData.deltaColorA);
 
-                    p->pos.x = - cosf(p->modeB.angle) * p->modeB.radius;
-                    p->pos.y = - sinf(p->modeB.angle) * p->modeB.radius;
-                    p->pos.y *= _yCoordFlipped;
-				}
+    // size
+    float* size = _particleData.size;
+    float* deltaSize = _particleData.deltaSize;
+    for (int i = 0; i < count; ++i)
+    {
+        size[i] = MAX(0, size[i] + deltaSize[i] * dt);
+    }
 
-                // color
-                p->color.r += (p->deltaColor.r * dt);
-                p->color.g += (p->deltaColor.g * dt);
-                p->color.b += (p->deltaColor.b * dt);
-                p->color.a += (p->deltaColor.a * dt);
+    // angle
+    integrate(_particleData.rotation, _particleData.deltaRotation);
 
-                // size
-                p->size += (p->deltaSize * dt);
-                p->size = MAX( 0, p->size );
+    return true;
+}
 
-                // angle
-                p->rotation += (p->deltaRotation * dt);
+void ParticleSystem::removeOnFinish()
+{
+    this->unscheduleUpdate();
+    if (_parent)
+    {
+        _parent->removeChild(this, true);
+    }
+}
 
-                //
-                // update values in quad
-                //
+void ParticleSystem::setRandomSeed(unsigned int seed)
+{
+    _randomSeed = seed;
 
-                Vec2    newPos;
+    // murmur3 finalizer, so nearby seeds give unrelated sequences
+    uint32_t x = seed;
+    x ^= x >> 16;
+    x *= 0x85ebca6b;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35;
+    x ^= x >> 16;
+    // xorshift gets stuck on zero
+    _randomState = x ? x : 0x9e3779b9;
+}
 
-                if (_positionType == PositionType::FREE || _positionType == PositionType::RELATIVE)
-                {
-                    Vec2 diff = currentPosition - p->startPos;
-                    newPos = p->pos - diff;
-                } 
-                else
-                {
-                    newPos = p->pos;
-                }
+void ParticleSystem::simulate(float seconds, float step)
+{
+    CCASSERT(step > 0, "simulate step must be positive");
 
-                // translate newPos to correct position, since matrix transform isn't performed in batchnode
-                // don't update the particle with the new position information, it will interfere with the radius and tangential calculations
-                if (_batchNode)
-                {
-                    newPos.x+=_position.x;
-                    newPos.y+=_position.y;
-                }
+    _emitterPosition = computeEmitterPosition();
 
-                updateQuadWithParticle(p, newPos);
-                //updateParticleImp(self, updateParticleSel, p, newPos);
+    // fixed steps keep the result independent of the frame rate
+    int steps = (int)(seconds / step);
+    float rest = seconds - steps * step;
+    for (int i = 0; i <= steps; ++i)
+    {
+        float dt = (i < steps) ? step : rest;
+        if (dt > 0 && !stepParticles(dt))
+        {
+            removeOnFinish();
+            return;
+        }
+    }
 
-                // update particle counter
-                ++_particleIdx;
-            } 
-            else 
-            {
-                // life < 0
-                int currentIndex = p->atlasIndex;
-                if( _particleIdx != _particleCount-1 )
-                {
-                    _particles[_particleIdx] = _particles[_particleCount-1];
-                }
-                if (_batchNode)
-                {
-                    //disable the switched particle
-                    _batchNode->disableParticle(_atlasIndex+currentIndex);
+    _particleIdx = _particleCount;
+    updateParticleQuads();
+    _transformSystemDirty = false;
 
-                    //switch indexes
-                    _particles[_particleCount-1].atlasIndex = currentIndex;
-                }
+    if (_visible && ! _batchNode)
+    {
+        postStep();
+    }
+}
 
+void ParticleSystem::setParallelUpdateEnabled(bool enabled)
+{
+    s_parallelUpdateEnabled = enabled;
+}
 
-                --_particleCount;
+bool ParticleSystem::isParallelUpdateEnabled()
+{
+    return s_parallelUpdateEnabled;
+}
 
-                if( _particleCount == 0 && _isAutoRemoveOnFinish )
-                {
-                    this->unscheduleUpdate();
-                    _parent->removeChild(this, true);
-                    return;
-                }
-            }
-        } //while
-        _transformSystemDirty = false;
+void ParticleSystem::updatePendingSystems()
+{
+    if (s_pendingSystems.empty())
+    {
+        return;
     }
-    
-    // only update gl buffer when visible
-    if (_visible && ! _batchNode)
+
+    // systems removed from the scene earlier in this frame are still retained
+    // by the list, so they can be finished safely
+    std::vector<ParticleSystem*> systems;
+    systems.swap(s_pendingSystems);
+
+    CC_PROFILER_START_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - parallel update");
+
+    // a system added to a batch node after registering shares the batch atlas,
+    // so it has to be simulated here on the main thread
+    for (auto system : systems)
     {
-        postStep();
+        if (system->_batchNode)
+        {
+            system->_pendingAlive = system->updateParticles(system->_pendingDelta);
+        }
     }
 
-    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+    // every other emitter only touches its own particles, quads and random state
+    ThreadPool::getInstance()->parallelFor(systems.size(), 1, [&systems](ssize_t begin, ssize_t end){
+        for (ssize_t i = begin; i < end; ++i)
+        {
+            ParticleSystem* system = systems[i];
+            if (!system->_batchNode)
+            {
+                system->_pendingAlive = system->updateParticles(system->_pendingDelta);
+            }
+        }
+    });
+
+    for (auto system : systems)
+    {
+        system->_pendingUpdate = false;
+        if (!system->_pendingAlive)
+        {
+            system->removeOnFinish();
+        }
+        else if (system->_visible && !system->_batchNode)
+        {
+            system->postStep();
+        }
+        system->release();
+    }
+
+    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - parallel update");
 }
 
 void ParticleSystem::updateWithNoTime(void)
@@ -832,10 +1132,8 @@ void ParticleSystem::updateWithNoTime(void)
     this->update(0.0f);
 }
 
-void ParticleSystem::updateQuadWithParticle(tParticle* particle, const Vec2& newPosition)
+void ParticleSystem::updateParticleQuads()
 {
-    CC_UNUSED_PARAM(particle);
-    CC_UNUSED_PARAM(newPosition);
     // should be overridden
 }
 
@@ -1133,7 +1431,7 @@ void ParticleSystem::setBatchNode(ParticleBatchNode* batchNode)
             //each particle needs a unique index
             for (int i = 0; i < _totalParticles; i++)
             {
-                _particles[i].atlasIndex=i;
+                _particleData.atlasIndex[i]=i;
             }
         }
     }
@@ -42,43 +42,75 @@ NS_CC_BEGIN
 class ParticleBatchNode;
 
 /**
-粒子数据结构
+粒子数据，每个属性单独存放在连续数组中 (SoA)，便于批量更新
 */
-typedef struct sParticle {
-    Vec2     pos;
-    Vec2     startPos;
+class CC_DLL ParticleData
+{
+public:
+    float* posx;
+    float* posy;
+    float* startPosX;
+    float* startPosY;
 
-    Color4F    color;
-    Color4F    deltaColor;
+    float* colorR;
+    float* colorG;
+    float* colorB;
+    float* colorA;
 
-    float        size;
-    float        deltaSize;
+    float* deltaColorR;
+    float* deltaColorG;
+    float* deltaColorB;
+    float* deltaColorA;
 
-    float        rotation;
-    float        deltaRotation;
+    float* size;
+    float* deltaSize;
 
-    float        timeToLive;
+    float* rotation;
+    float* deltaRotation;
 
-    unsigned int    atlasIndex;
+    float* timeToLive;
+
+    unsigned int* atlasIndex;
 
     //! 模式 A: 引力, 方向, 径向加速度, 切向加速度
     struct {
-        Vec2        dir;
-        float        radialAccel;
-        float        tangentialAccel;
+        float* dirX;
+        float* dirY;
+        float* radialAccel;
+        float* tangentialAccel;
     } modeA;
 
     //! 模式 B: 半径模式
     struct {
-        float        angle;
-        float        degreesPerSecond;
-        float        radius;
-        float        deltaRadius;
+        float* angle;
+        float* degreesPerSecond;
+        float* radius;
+        float* deltaRadius;
     } modeB;
 
-}tParticle;
+    ParticleData();
+    ~ParticleData();
+
+    //! 分配可容纳 count 个粒子的数组并清零，失败时保留原有数据
+    bool init(int count);
+    //! 释放所有数组
+    void release();
+
+    //! 可容纳的粒子数量
+    unsigned int getMaxCount() const { return _maxCount; }
+
+    //! 把第 src 个粒子的所有属性拷贝到第 dst 个
+    void copyParticle(int dst, int src);
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(ParticleData);
+
+    void assignArrays(float* buffer, size_t stride);
+
+    void* _buffer;
+    unsigned int _maxCount;
+};
 
-//typedef void (*CC_UPDATE_PARTICLE_IMP)(id, SEL, tParticle*, Vec2);
 
 class Texture2D;
 
@@ -182,8 +214,8 @@ public:
 
     //! 添加一个粒子到发射器
     bool addParticle();
-    //! 初始化一个粒子
-    void initParticle(tParticle* particle);
+    //! 一次添加 count 个粒子，超出容量的部分被忽略
+    void addParticles(int count);
     //! 停止发射粒子
     void stopSystem();
     //! 停止所有活着的粒子
@@ -191,13 +223,39 @@ public:
     //! 系统是否满了
     bool isFull();
 
-    //! 必须被子类重写
-    virtual void updateQuadWithParticle(tParticle* particle, const Vec2& newPosition);
+    //! 必须被子类重写，根据 _particleData 写入所有粒子的 quad
+    //! 可能在工作线程上调用，不能调用 OpenGL 或访问其他节点
+    virtual void updateParticleQuads();
     //! 必须被子类重写
     virtual void postStep();
 
     virtual void updateWithNoTime(void);
 
+    /** 设置随机数种子并重置随机序列。
+     相同的种子和相同的 update/simulate 调用序列会产生完全相同的粒子。
+     默认种子在创建时取自 rand()。
+     */
+    void setRandomSeed(unsigned int seed);
+    inline unsigned int getRandomSeed() const { return _randomSeed; }
+
+    /** 以固定步长 step 连续模拟 seconds 秒，中间不生成 quad，最后只生成一次。
+     用于在场景加载时让烟雾等效果"已经在运行"。结果只取决于种子和参数。
+     必须在主线程调用，发射器位置取调用时的位置。
+     */
+    void simulate(float seconds, float step = 1.0f / 30);
+
+    /** 开启后，没有加入 ParticleBatchNode 的粒子系统在 update() 中只登记自己，
+     由 Director 在所有定时器执行完后调用 updatePendingSystems() 在线程池上并行模拟。
+     每个粒子系统使用自己的随机数序列，结果与线程调度无关。默认关闭。
+     */
+    static void setParallelUpdateEnabled(bool enabled);
+    static bool isParallelUpdateEnabled();
+
+    /** 并行模拟所有登记的粒子系统，然后在当前线程上传顶点数据并处理自动移除。
+     由 Director 在每帧 visit 之前调用。
+     */
+    static void updatePendingSystems();
+
     virtual bool isAutoRemoveOnFinish() const;
     virtual void setAutoRemoveOnFinish(bool var);
 
@@ -409,6 +467,34 @@ CC_CONSTRUCTOR_ACCESS:
 protected:
     virtual void updateBlendFunc();
 
+    //! 发射器当前位置：FREE 模式为世界坐标，RELATIVE 模式为 _position，GROUPED 模式为零
+    Vec2 computeEmitterPosition();
+
+    //! 发射 count 个粒子，起始位置取 _emitterPosition
+    void emitParticles(int count);
+
+    //! 模拟 dt 秒(发射、移除死亡粒子、积分)，不生成 quad。
+    //! 粒子全部死亡且需要自动移除时返回 false
+    bool stepParticles(float dt);
+
+    //! stepParticles() 之后生成 quad，只访问本粒子系统的数据，可以在工作线程上执行。
+    //! 粒子全部死亡且需要自动移除时返回 false，此时不会更新 quad
+    bool updateParticles(float dt);
+
+    //! 自动移除：停止 update 并从父节点移除
+    void removeOnFinish();
+
+    //! 返回 [-1, 1) 之间的随机数，每个粒子系统独立的 xorshift32 序列
+    inline float randomMinus1To1()
+    {
+        uint32_t x = _randomState;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        _randomState = x;
+        return (x >> 8) * (2.0f / 16777216.0f) - 1.0f;
+    }
+
     /** 是否粒子被混合
      如何是下面的代码将被调用
      @code
@@ -465,8 +551,8 @@ protected:
         float rotatePerSecondVar;
     } modeB;
 
-    //! 粒子数组
-    tParticle *_particles;
+    //! 粒子数据
+    ParticleData _particleData;
 
     //Emitter name
     std::string _configName;
@@ -480,10 +566,6 @@ protected:
     //!  粒子idx值
     int _particleIdx;
 
-    // Optimization
-    //CC_UPDATE_PARTICLE_IMP    updateParticleImp;
-    //SEL                        updateParticleSel;
-
     /** 弱引用渲染精灵的SpriteBatchNode */
     ParticleBatchNode* _batchNode;
 
@@ -564,6 +646,19 @@ protected:
      */
     PositionType _positionType;
 
+    /** 随机数种子 */
+    unsigned int _randomSeed;
+    /** 随机数状态，不能为零 */
+    uint32_t _randomState;
+    /** 本次 update 使用的发射器位置，见 computeEmitterPosition() */
+    Vec2 _emitterPosition;
+    /** 等待并行模拟的时间 */
+    float _pendingDelta;
+    /** 是否已登记到并行模拟列表 */
+    bool _pendingUpdate;
+    /** 并行模拟的结果，见 updateParticles() */
+    bool _pendingAlive;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(ParticleSystem);
 };
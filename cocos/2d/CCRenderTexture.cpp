@@ -394,7 +394,7 @@ void RenderTexture::visit(Renderer *renderer, const Mat4 &parentTransform, bool
 	
     bool dirty = parentTransformUpdated || _transformUpdated;
     if(dirty)
-        _modelViewTransform = transform(parentTransform);
+        updateModelViewTransform(parentTransform);
     _transformUpdated = false;
     
     Director* director = Director::getInstance();
@@ -519,9 +519,12 @@ void Sprite::updateTransform(void)
             else
             {
                 CCASSERT( dynamic_cast<Sprite*>(_parent), "Logic error in Sprite. Parent must be a Sprite");
-                Mat4 nodeToParent = getNodeToParentTransform();
-                Mat4 parentTransform = static_cast<Sprite*>(_parent)->_transformToBatch;
-                _transformToBatch = parentTransform * nodeToParent;
+                const Mat4& nodeToParent = getNodeToParentTransform();
+                const Mat4& parentTransform = static_cast<Sprite*>(_parent)->_transformToBatch;
+                if (TransformIsAffine2D(parentTransform) && TransformIsAffine2D(nodeToParent))
+                    TransformConcatAffine2D(parentTransform, nodeToParent, &_transformToBatch);
+                else
+                    _transformToBatch = parentTransform * nodeToParent;
             }
 
             //
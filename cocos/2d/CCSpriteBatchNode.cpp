@@ -152,7 +152,7 @@ void SpriteBatchNode::visit(Renderer *renderer, const Mat4 &parentTransform, boo
 
     bool dirty = parentTransformUpdated || _transformUpdated;
     if(dirty)
-        _modelViewTransform = transform(parentTransform);
+        updateModelViewTransform(parentTransform);
     _transformUpdated = false;
 
     // IMPORTANT:
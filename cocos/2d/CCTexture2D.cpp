@@ -803,6 +803,76 @@ bool Texture2D::initWithImage(Image *image, PixelFormat format)
     }
 }
 
+bool Texture2D::canInitWithImageRows(Image *image)
+{
+    return image != nullptr && !image->isCompressed() && image->getNumberOfMipmaps() <= 1
+        && _pixelFormatInfoTables.find(image->getRenderFormat()) != _pixelFormatInfoTables.end();
+}
+
+bool Texture2D::initWithImageRows(Image *image, int rowOffset, int rowCount, PixelFormat format)
+{
+    CCASSERT(canInitWithImageRows(image), "Texture2D: only uncompressed images without mipmaps can be uploaded by rows");
+
+    int imageWidth = image->getWidth();
+    int imageHeight = image->getHeight();
+    rowCount = MIN(rowCount, imageHeight - rowOffset);
+    if (rowOffset < 0 || rowCount <= 0)
+    {
+        return false;
+    }
+
+    PixelFormat renderFormat = image->getRenderFormat();
+    ssize_t bytesPerRow = (ssize_t)imageWidth * _pixelFormatInfoTables.at(renderFormat).bpp / 8;
+    const unsigned char* rows = image->getData() + bytesPerRow * rowOffset;
+
+    // the first slice decides the texture format, the following ones are converted to it
+    PixelFormat pixelFormat = _pixelFormat;
+    if (rowOffset == 0)
+    {
+        pixelFormat = format != PixelFormat::NONE ? format : g_defaultAlphaPixelFormat;
+    }
+
+    unsigned char* outData = nullptr;
+    ssize_t outDataLen = 0;
+    pixelFormat = convertDataToFormat(rows, bytesPerRow * rowCount, renderFormat, pixelFormat, &outData, &outDataLen);
+
+    bool ret = true;
+    if (rowOffset == 0)
+    {
+        int maxTextureSize = Configuration::getInstance()->getMaxTextureSize();
+        if (imageWidth > maxTextureSize || imageHeight > maxTextureSize)
+        {
+            CCLOG("cocos2d: WARNING: Image (%u x %u) is bigger than the supported %u x %u", imageWidth, imageHeight, maxTextureSize, maxTextureSize);
+            ret = false;
+        }
+        else
+        {
+            // allocate the storage only, the rows are filled with glTexSubImage2D
+            MipmapInfo mipmap;
+            mipmap.address = nullptr;
+            mipmap.len = 0;
+            ret = initWithMipmaps(&mipmap, 1, pixelFormat, imageWidth, imageHeight);
+            if (image->hasPremultipliedAlpha())
+                _hasPremultipliedAlpha = image->isPremultipliedAlpha();
+            else
+                _hasPremultipliedAlpha = image->getFileType() == Image::Format::PVR && _PVRHaveAlphaPremultiplied;
+        }
+    }
+
+    if (ret)
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        ret = updateWithData(outData, 0, rowOffset, imageWidth, rowCount);
+    }
+
+    if (outData != nullptr && outData != rows)
+    {
+        free(outData);
+    }
+
+    return ret;
+}
+
 Texture2D::PixelFormat Texture2D::convertI8ToFormat(const unsigned char* data, ssize_t dataLen, PixelFormat format, unsigned char** outData, ssize_t* outDataLen)
 {
     switch (format)
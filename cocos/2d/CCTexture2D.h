@@ -240,6 +240,15 @@ public:
     **/
     bool initWithImage(Image * image, PixelFormat format);
 
+    /**
+	分段上传图像，用于把一张大图的上传分散到多帧中。
+	rowOffset 为 0 时分配纹理的存储空间，之后每次调用上传 [rowOffset, rowOffset + rowCount) 行，直到上传完整张图像。
+	只支持没有 mipmap 的非压缩图像，参见 canInitWithImageRows()。
+    */
+    bool initWithImageRows(Image * image, int rowOffset, int rowCount, PixelFormat format = PixelFormat::NONE);
+    /** 图像是否可以用 initWithImageRows() 分段上传 */
+    static bool canInitWithImageRows(Image * image);
+
     /** 指定大小、对齐方式、字体名和字体大小，根据输入的字符串初始化纹理 */
     bool initWithString(const char *text,  const std::string &fontName, float fontSize, const Size& dimensions = Size(0, 0), TextHAlignment hAlignment = TextHAlignment::CENTER, TextVAlignment vAlignment = TextVAlignment::TOP);
     /** 指定FontDefinition，根据输入的字符串初始化纹理*/
@@ -29,6 +29,8 @@ THE SOFTWARE.
 #include <stack>
 #include <cctype>
 #include <list>
+#include <algorithm>
+#include <chrono>
 
 #include "2d/CCTextureCache.h"
 #include "2d/CCTexture2D.h"
@@ -57,9 +59,11 @@ TextureCache * TextureCache::getInstance()
 }
 
 TextureCache::TextureCache()
-: _loadingThread(nullptr)
-, _asyncStructQueue(nullptr)
-, _imageInfoQueue(nullptr)
+: _asyncWorkerCount(std::max(1, std::min(4, (int)std::thread::hardware_concurrency() - 1)))
+, _uploadingStruct(nullptr)
+, _asyncUploadBudget(0.004f)
+, _asyncUploadStripSize(512 * 1024)
+, _asyncUploadTime(0)
 , _needQuit(false)
 , _asyncRefCount(0)
 {
@@ -72,7 +76,27 @@ TextureCache::~TextureCache()
     for( auto it=_textures.begin(); it!=_textures.end(); ++it)
         (it->second)->release();
 
-    CC_SAFE_DELETE(_loadingThread);
+    waitForQuit();
+
+    // requests that never reached the main thread
+    for (auto& queue : _asyncStructQueue)
+    {
+        for (auto asyncStruct : queue)
+            delete asyncStruct;
+        queue.clear();
+    }
+    if (_uploadingStruct)
+    {
+        _imageInfoQueue.push_back(_uploadingStruct);
+        _uploadingStruct = nullptr;
+    }
+    for (auto asyncStruct : _imageInfoQueue)
+    {
+        CC_SAFE_RELEASE(asyncStruct->image);
+        CC_SAFE_RELEASE(asyncStruct->texture);
+        delete asyncStruct;
+    }
+    _imageInfoQueue.clear();
 }
 
 void TextureCache::destroyInstance()
@@ -94,6 +118,11 @@ std::string TextureCache::getDescription() const
 }
 
 void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback)
+{
+    addImageAsync(path, callback, AsyncPriority::IMMEDIATE);
+}
+
+void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, AsyncPriority priority)
 {
     Texture2D *texture = nullptr;
 
@@ -109,16 +138,38 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
         return;
     }
 
-    // lazy init
-    if (_asyncStructQueue == nullptr)
-    {             
-        _asyncStructQueue = new queue<AsyncStruct*>();
-        _imageInfoQueue   = new deque<ImageInfo*>();        
+    // the file is already being loaded: share the decode
+    auto pending = _asyncStructMap.find(fullpath);
+    if (pending != _asyncStructMap.end())
+    {
+        AsyncStruct *asyncStruct = pending->second;
+        asyncStruct->callbacks.push_back(callback);
 
-        // create a new thread to load images
-        _loadingThread = new std::thread(&TextureCache::loadImage, this);
+        if (priority == AsyncPriority::IMMEDIATE && asyncStruct->priority == AsyncPriority::PREFETCH)
+        {
+            std::lock_guard<std::mutex> lock(_asyncStructQueueMutex);
+            auto& prefetchQueue = _asyncStructQueue[(int)AsyncPriority::PREFETCH];
+            auto queued = std::find(prefetchQueue.begin(), prefetchQueue.end(), asyncStruct);
+            if (queued != prefetchQueue.end())
+            {
+                prefetchQueue.erase(queued);
+                _asyncStructQueue[(int)AsyncPriority::IMMEDIATE].push_back(asyncStruct);
+            }
+            asyncStruct->priority = AsyncPriority::IMMEDIATE;
+        }
+        return;
+    }
 
+    // lazy init
+    if (_loadingThreads.empty())
+    {
         _needQuit = false;
+
+        // create the threads to load images
+        for (int i = 0; i < _asyncWorkerCount; ++i)
+        {
+            _loadingThreads.push_back(std::thread(&TextureCache::loadImage, this));
+        }
     }
 
     if (0 == _asyncRefCount)
@@ -129,125 +180,217 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
     ++_asyncRefCount;
 
     // generate async struct
-    AsyncStruct *data = new AsyncStruct(fullpath, callback);
+    AsyncStruct *data = new AsyncStruct(fullpath, priority);
+    data->callbacks.push_back(callback);
+    _asyncStructMap.insert(std::make_pair(fullpath, data));
 
     // add async struct into queue
     _asyncStructQueueMutex.lock();
-    _asyncStructQueue->push(data);
+    _asyncStructQueue[(int)priority].push_back(data);
     _asyncStructQueueMutex.unlock();
 
     _sleepCondition.notify_one();
 }
 
-void TextureCache::loadImage()
+void TextureCache::cancelImageAsync(const std::string &path)
 {
-    AsyncStruct *asyncStruct = nullptr;
+    auto it = _asyncStructMap.find(path);
+    if (it == _asyncStructMap.end())
+    {
+        it = _asyncStructMap.find(FileUtils::getInstance()->fullPathForFilename(path));
+        if (it == _asyncStructMap.end())
+            return;
+    }
+
+    AsyncStruct *asyncStruct = it->second;
+    _asyncStructMap.erase(it);
+
+    bool dequeued = false;
+    _asyncStructQueueMutex.lock();
+    auto& queue = _asyncStructQueue[(int)asyncStruct->priority];
+    auto queued = std::find(queue.begin(), queue.end(), asyncStruct);
+    if (queued != queue.end())
+    {
+        queue.erase(queued);
+        dequeued = true;
+    }
+    _asyncStructQueueMutex.unlock();
 
+    if (!dequeued)
+    {
+        // a worker owns it: drop the result when it comes back
+        asyncStruct->cancelled = true;
+        asyncStruct->callbacks.clear();
+        return;
+    }
+
+    delete asyncStruct;
+
+    --_asyncRefCount;
+    if (0 == _asyncRefCount)
+    {
+        Director::getInstance()->getScheduler()->unschedule(schedule_selector(TextureCache::addImageAsyncCallBack), this);
+    }
+}
+
+void TextureCache::cancelAllImageAsync()
+{
+    while (!_asyncStructMap.empty())
+    {
+        cancelImageAsync(_asyncStructMap.begin()->first);
+    }
+}
+
+void TextureCache::setAsyncWorkerCount(int count)
+{
+    CCASSERT(count > 0, "TextureCache: worker count must be positive");
+    CCASSERT(_loadingThreads.empty(), "TextureCache: setAsyncWorkerCount must be called before addImageAsync");
+    if (_loadingThreads.empty())
+    {
+        _asyncWorkerCount = std::max(1, count);
+    }
+}
+
+void TextureCache::loadImage()
+{
     while (true)
     {
-        std::queue<AsyncStruct*> *pQueue = _asyncStructQueue;
-        _asyncStructQueueMutex.lock();
-        if (pQueue->empty())
+        AsyncStruct *asyncStruct = nullptr;
         {
-            _asyncStructQueueMutex.unlock();
-            if (_needQuit) {
+            std::unique_lock<std::mutex> lock(_asyncStructQueueMutex);
+            _sleepCondition.wait(lock, [this] {
+                return _needQuit
+                    || !_asyncStructQueue[(int)AsyncPriority::IMMEDIATE].empty()
+                    || !_asyncStructQueue[(int)AsyncPriority::PREFETCH].empty();
+            });
+
+            if (_needQuit)
                 break;
-            }
-            else {
-                std::unique_lock<std::mutex> lk(_sleepMutex);
-                _sleepCondition.wait(lk);
-                continue;
-            }
-        }
-        else
-        {
-            asyncStruct = pQueue->front();
-            pQueue->pop();
-            _asyncStructQueueMutex.unlock();
-        }        
 
-        Image *image = nullptr;
-        bool generateImage = false;
+            auto& queue = _asyncStructQueue[(int)AsyncPriority::IMMEDIATE].empty()
+                ? _asyncStructQueue[(int)AsyncPriority::PREFETCH]
+                : _asyncStructQueue[(int)AsyncPriority::IMMEDIATE];
+            asyncStruct = queue.front();
+            queue.pop_front();
+        }
 
-        auto it = _textures.find(asyncStruct->filename);
-        if( it == _textures.end() )
+        // generate image
+        const std::string& filename = asyncStruct->filename;
+        Image *image = new Image();
+        if (!image->initWithImageFileThreadSafe(filename))
         {
-           _imageInfoMutex.lock();
-           ImageInfo *imageInfo;
-           size_t pos = 0;
-           size_t infoSize = _imageInfoQueue->size();
-           for (; pos < infoSize; pos++)
-           {
-               imageInfo = (*_imageInfoQueue)[pos];
-               if(imageInfo->asyncStruct->filename.compare(asyncStruct->filename))
-                   break;
-           }
-           _imageInfoMutex.unlock();
-           if(infoSize == 0 || pos < infoSize)
-               generateImage = true;
+            CC_SAFE_RELEASE_NULL(image);
+            CCLOG("can not load %s", filename.c_str());
         }
+        asyncStruct->image = image;
 
-        if (generateImage)
+        // hand it back to the main thread, even on failure so the callbacks still run
+        _imageInfoMutex.lock();
+        _imageInfoQueue.push_back(asyncStruct);
+        _imageInfoMutex.unlock();
+    }
+}
+
+void TextureCache::addImageAsyncCallBack(float dt)
+{
+    auto start = std::chrono::steady_clock::now();
+    float elapsed = 0;
+
+    // always make some progress, then keep uploading while the frame budget allows
+    do
+    {
+        AsyncStruct *asyncStruct = _uploadingStruct;
+        if (asyncStruct == nullptr)
         {
-            const std::string& filename = asyncStruct->filename;
-            // generate image      
-            image = new Image();
-            if (image && !image->initWithImageFileThreadSafe(filename))
+            // the image is generated in loading thread
+            _imageInfoMutex.lock();
+            if (_imageInfoQueue.empty())
             {
-                CC_SAFE_RELEASE(image);
-                CCLOG("can not load %s", filename.c_str());
-                continue;
+                _imageInfoMutex.unlock();
+                break;
             }
-        }    
+            asyncStruct = _imageInfoQueue.front();
+            _imageInfoQueue.pop_front();
+            _imageInfoMutex.unlock();
+        }
+
+        if (uploadAsyncStruct(asyncStruct))
+        {
+            _uploadingStruct = nullptr;
+            finishAsyncStruct(asyncStruct);
+        }
+        else
+        {
+            _uploadingStruct = asyncStruct;
+        }
 
-        // generate image info
-        ImageInfo *imageInfo = new ImageInfo();
-        imageInfo->asyncStruct = asyncStruct;
-        imageInfo->image = image;
+        elapsed = std::chrono::duration_cast<std::chrono::duration<float>>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < _asyncUploadBudget && _asyncRefCount > 0);
 
-        // put the image info into the queue
-        _imageInfoMutex.lock();
-        _imageInfoQueue->push_back(imageInfo);
-        _imageInfoMutex.unlock();
-    }
-    
-	if(_asyncStructQueue != nullptr)
-    {
-        delete _asyncStructQueue;
-	    _asyncStructQueue = nullptr;
-        delete _imageInfoQueue;
-	    _imageInfoQueue = nullptr;
-    }
+    _asyncUploadTime = _asyncRefCount > 0 ? elapsed : 0;
 }
 
-void TextureCache::addImageAsyncCallBack(float dt)
+bool TextureCache::uploadAsyncStruct(AsyncStruct *asyncStruct)
 {
-    // the image is generated in loading thread
-    std::deque<ImageInfo*> *imagesQueue = _imageInfoQueue;
+    Image *image = asyncStruct->image;
+    if (asyncStruct->cancelled || image == nullptr)
+    {
+        return true;
+    }
 
-    _imageInfoMutex.lock();
-    if (imagesQueue->empty())
+    if (asyncStruct->texture == nullptr)
     {
-        _imageInfoMutex.unlock();
+        if (_textures.find(asyncStruct->filename) != _textures.end())
+        {
+            // loaded synchronously in the meantime
+            return true;
+        }
+
+        // generate texture in render thread
+        asyncStruct->texture = new Texture2D();
+
+        bool split = _asyncUploadStripSize > 0 && image->getDataLen() > _asyncUploadStripSize
+            && Texture2D::canInitWithImageRows(image);
+        if (!split)
+        {
+            asyncStruct->texture->initWithImage(image);
+            return true;
+        }
     }
-    else
+
+    // upload the next strip of rows
+    ssize_t bytesPerRow = image->getDataLen() / image->getHeight();
+    int rows = (int)std::max((ssize_t)1, _asyncUploadStripSize / std::max((ssize_t)1, bytesPerRow));
+    if (!asyncStruct->texture->initWithImageRows(image, asyncStruct->uploadedRows, rows))
     {
-        ImageInfo *imageInfo = imagesQueue->front();
-        imagesQueue->pop_front();
-        _imageInfoMutex.unlock();
+        CCLOG("cocos2d: TextureCache: can not upload %s", asyncStruct->filename.c_str());
+        CC_SAFE_RELEASE_NULL(asyncStruct->texture);
+        return true;
+    }
 
-        AsyncStruct *asyncStruct = imageInfo->asyncStruct;
-        Image *image = imageInfo->image;
+    asyncStruct->uploadedRows += rows;
+    return asyncStruct->uploadedRows >= image->getHeight();
+}
 
-        const std::string& filename = asyncStruct->filename;
+void TextureCache::finishAsyncStruct(AsyncStruct *asyncStruct)
+{
+    const std::string& filename = asyncStruct->filename;
+
+    if (!asyncStruct->cancelled)
+    {
+        _asyncStructMap.erase(filename);
 
         Texture2D *texture = nullptr;
-        if (image)
+        auto it = _textures.find(filename);
+        if (it != _textures.end())
         {
-            // generate texture in render thread
-            texture = new Texture2D();
-
-            texture->initWithImage(image);
+            texture = it->second;
+            CC_SAFE_RELEASE_NULL(asyncStruct->texture);
+        }
+        else if (asyncStruct->texture)
+        {
+            texture = asyncStruct->texture;
+            asyncStruct->texture = nullptr;
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
             // cache the texture file name
@@ -259,27 +402,22 @@ void TextureCache::addImageAsyncCallBack(float dt)
 
             texture->autorelease();
         }
-        else
-        {
-            auto it = _textures.find(asyncStruct->filename);
-            if(it != _textures.end())
-                texture = it->second;
-        }
-        
-        asyncStruct->callback(texture);
-        if(image)
-        {
-            image->release();
-        }       
-        delete asyncStruct;
-        delete imageInfo;
 
-        --_asyncRefCount;
-        if (0 == _asyncRefCount)
+        for (const auto& callback : asyncStruct->callbacks)
         {
-            Director::getInstance()->getScheduler()->unschedule(schedule_selector(TextureCache::addImageAsyncCallBack), this);
+            callback(texture);
         }
     }
+
+    CC_SAFE_RELEASE(asyncStruct->texture);
+    CC_SAFE_RELEASE(asyncStruct->image);
+    delete asyncStruct;
+
+    --_asyncRefCount;
+    if (0 == _asyncRefCount)
+    {
+        Director::getInstance()->getScheduler()->unschedule(schedule_selector(TextureCache::addImageAsyncCallBack), this);
+    }
 }
 
 Texture2D * TextureCache::addImage(const std::string &path)
@@ -492,10 +630,17 @@ void TextureCache::reloadAllTextures()
 
 void TextureCache::waitForQuit()
 {
-    // notify sub thread to quick
+    // notify sub threads to quit
+    _asyncStructQueueMutex.lock();
     _needQuit = true;
-    _sleepCondition.notify_one();
-    if (_loadingThread) _loadingThread->join();
+    _asyncStructQueueMutex.unlock();
+    _sleepCondition.notify_all();
+
+    for (auto& thread : _loadingThreads)
+    {
+        thread.join();
+    }
+    _loadingThreads.clear();
 }
 
 std::string TextureCache::getCachedTextureInfo() const
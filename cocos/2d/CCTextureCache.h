@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include <thread>
 #include <condition_variable>
 #include <queue>
+#include <vector>
 #include <string>
 #include <unordered_map>
 #include <functional>
@@ -119,6 +120,41 @@ public:
     */
     virtual void addImageAsync(const std::string &filepath, const std::function<void(Texture2D*)>& callback);
 
+    /** 异步加载的优先级。IMMEDIATE 的请求总是先于 PREFETCH 的请求被解码 */
+    enum class AsyncPriority
+    {
+        IMMEDIATE,  ///< 马上需要显示的纹理
+        PREFETCH,   ///< 预加载，空闲时再解码
+    };
+
+    /** 和 addImageAsync(filepath, callback) 一样，但是可以指定优先级
+    * 同一个文件正在加载时不会重复解码，回调函数会被追加到已有的请求上；用 IMMEDIATE 再次请求一个还在排队的 PREFETCH 请求会提升它的优先级
+    */
+    void addImageAsync(const std::string &filepath, const std::function<void(Texture2D*)>& callback, AsyncPriority priority);
+
+    /** 取消一个异步加载请求，它的回调函数都不会被调用。还没有开始解码的请求会被直接移出队列 */
+    void cancelImageAsync(const std::string &filepath);
+
+    /** 取消所有的异步加载请求 */
+    void cancelAllImageAsync();
+
+    /** 设置解码线程的数量，必须在第一次调用 addImageAsync 之前设置。默认为 CPU 核心数减一，最多 4 个 */
+    void setAsyncWorkerCount(int count);
+    int getAsyncWorkerCount() const { return _asyncWorkerCount; }
+
+    /** 每帧上传异步纹理的时间预算 (秒)，默认 0.004。每帧至少会上传一张图像或一段 */
+    void setAsyncUploadBudget(float seconds) { _asyncUploadBudget = seconds; }
+    float getAsyncUploadBudget() const { return _asyncUploadBudget; }
+
+    /** 大于这个字节数的图像会用 glTexSubImage2D 分成多段，在多帧中上传。默认 512KB，0 表示不分段 */
+    void setAsyncUploadStripSize(ssize_t bytes) { _asyncUploadStripSize = bytes; }
+    ssize_t getAsyncUploadStripSize() const { return _asyncUploadStripSize; }
+
+    /** 还没有完成的异步加载请求数量 (排队、解码中和等待上传的) */
+    int getAsyncQueueDepth() const { return _asyncRefCount; }
+    /** 上一帧上传异步纹理所用的时间 (秒) */
+    float getAsyncUploadTime() const { return _asyncUploadTime; }
+
     /** 返回与给定图像相对应的Texture2D对象
     * 如果该图像没有被预加载，这个方法会创建一个新的Texture2D对象，并返回该Texture2D对象
     * 否则会返回一个指向预加载图像的引用（reference）
@@ -185,29 +221,42 @@ public:
     struct AsyncStruct
     {
     public:
-        AsyncStruct(const std::string& fn, std::function<void(Texture2D*)> f) : filename(fn), callback(f) {}
+        AsyncStruct(const std::string& fn, AsyncPriority p) : filename(fn), priority(p), image(nullptr), texture(nullptr), uploadedRows(0), cancelled(false) {}
 
         std::string filename;
-        std::function<void(Texture2D*)> callback;
+        std::vector<std::function<void(Texture2D*)>> callbacks;
+        AsyncPriority priority;
+        Image *image;       ///< 解码的结果，由解码线程设置
+        Texture2D *texture; ///< 正在分段上传的纹理
+        int uploadedRows;   ///< 已经上传的行数
+        bool cancelled;     ///< 只在主线程中访问
     };
 
 protected:
-    typedef struct _ImageInfo
-    {
-        AsyncStruct *asyncStruct;
-        Image        *image;
-    } ImageInfo;
-    
-    std::thread* _loadingThread;
+    bool uploadAsyncStruct(AsyncStruct *asyncStruct);
+    void finishAsyncStruct(AsyncStruct *asyncStruct);
 
-    std::queue<AsyncStruct*>* _asyncStructQueue;
-    std::deque<ImageInfo*>* _imageInfoQueue;
+protected:
+    std::vector<std::thread> _loadingThreads;
+    int _asyncWorkerCount;
 
+    // pending requests, guarded by _asyncStructQueueMutex
+    std::deque<AsyncStruct*> _asyncStructQueue[2];
     std::mutex _asyncStructQueueMutex;
+    std::condition_variable _sleepCondition;
+
+    // decoded requests waiting for the GL upload, guarded by _imageInfoMutex
+    std::deque<AsyncStruct*> _imageInfoQueue;
     std::mutex _imageInfoMutex;
 
-    std::mutex _sleepMutex;
-    std::condition_variable _sleepCondition;
+    // the request whose image is being uploaded in strips
+    AsyncStruct *_uploadingStruct;
+    float _asyncUploadBudget;
+    ssize_t _asyncUploadStripSize;
+    float _asyncUploadTime;
+
+    // requests in flight by full path, only touched by the main thread
+    std::unordered_map<std::string, AsyncStruct*> _asyncStructMap;
 
     bool _needQuit;
 
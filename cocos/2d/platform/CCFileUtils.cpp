@@ -28,10 +28,22 @@ THE SOFTWARE.
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
 #include "CCSAXParser.h"
+#include "CCPackFile.h"
 #include "tinyxml2.h"
 #include "unzip.h"
 #include <stack>
 
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT) && (CC_TARGET_PLATFORM != CC_PLATFORM_WP8)
+#define CC_FILEUTILS_USE_MMAP 1
+#define CC_FILEUTILS_USE_DIRENT 1
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 using namespace std;
 
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_IOS) && (CC_TARGET_PLATFORM != CC_PLATFORM_MAC)
@@ -367,6 +379,12 @@ bool FileUtils::writeToFile(ValueMap& dict, const std::string &fullPath)
     bool ret = tinyxml2::XML_SUCCESS == doc->SaveFile(fullPath.c_str());
     
     delete doc;
+    
+    // the file may have been looked up (and missed) before it was written
+    if (ret)
+    {
+        purgeMissingPaths();
+    }
     return ret;
 }
 
@@ -477,12 +495,24 @@ void FileUtils::destroyInstance()
     CC_SAFE_DELETE(s_sharedFileUtils);
 }
 
+// upper bound of remembered missing file names
+static const size_t MISSING_PATH_CACHE_SIZE = 1024;
+// search paths with more files than this are not indexed
+static const size_t SEARCH_PATH_INDEX_MAX_FILES = 100000;
+
 FileUtils::FileUtils()
+: _fileMappingThreshold(64 * 1024)
+, _searchPathIndexEnabled(false)
 {
+    resetLookupStats();
 }
 
 FileUtils::~FileUtils()
 {
+    for (auto iter = _packFiles.begin(); iter != _packFiles.end(); ++iter)
+    {
+        delete iter->second;
+    }
 }
 
 
@@ -496,6 +526,144 @@ bool FileUtils::init()
 void FileUtils::purgeCachedEntries()
 {
     _fullPathCache.clear();
+    purgeMissingPaths();
+    
+    // files may have been added to the search paths, list them again
+    _searchPathIndex.clear();
+    if (_searchPathIndexEnabled)
+    {
+        for (auto iter = _searchPathArray.cbegin(); iter != _searchPathArray.cend(); ++iter)
+        {
+            buildSearchPathIndex(*iter);
+        }
+    }
+}
+
+void FileUtils::addMissingPath(const std::string& filename)
+{
+    if (!_missingPathCache.insert(filename).second)
+    {
+        return;
+    }
+    
+    _missingPathOrder.push_back(filename);
+    if (_missingPathOrder.size() > MISSING_PATH_CACHE_SIZE)
+    {
+        _missingPathCache.erase(_missingPathOrder.front());
+        _missingPathOrder.pop_front();
+    }
+}
+
+void FileUtils::purgeMissingPaths()
+{
+    _missingPathCache.clear();
+    _missingPathOrder.clear();
+}
+
+#ifdef CC_FILEUTILS_USE_DIRENT
+// Collects the relative paths of all regular files below root + prefix.
+// Returns false if the directory can't be read or holds too many files.
+static bool listDirectory(const std::string& root, const std::string& prefix, std::unordered_set<std::string>& files)
+{
+    DIR* dir = opendir((root + prefix).c_str());
+    if (!dir)
+    {
+        return false;
+    }
+    
+    bool ok = true;
+    struct dirent* entry = nullptr;
+    while (ok && (entry = readdir(dir)) != nullptr)
+    {
+        const char* name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+        {
+            continue;
+        }
+        
+        std::string relativePath = prefix + name;
+        bool isDirectory = false;
+        bool isFile = false;
+#ifdef DT_DIR
+        if (entry->d_type == DT_DIR)
+        {
+            isDirectory = true;
+        }
+        else if (entry->d_type == DT_REG)
+        {
+            isFile = true;
+        }
+        else if (entry->d_type == DT_LNK || entry->d_type == DT_UNKNOWN)
+#endif
+        {
+            // symbolic links and file systems without d_type need a stat call
+            struct stat st;
+            if (stat((root + relativePath).c_str(), &st) == 0)
+            {
+                isDirectory = S_ISDIR(st.st_mode);
+                isFile = S_ISREG(st.st_mode);
+            }
+        }
+        
+        if (isDirectory)
+        {
+            ok = listDirectory(root, relativePath + "/", files);
+        }
+        else if (isFile)
+        {
+            files.insert(relativePath);
+            ok = files.size() <= SEARCH_PATH_INDEX_MAX_FILES;
+        }
+    }
+    closedir(dir);
+    return ok;
+}
+#endif
+
+void FileUtils::buildSearchPathIndex(const std::string& searchPath)
+{
+#ifdef CC_FILEUTILS_USE_DIRENT
+    if (searchPath.empty() || _packFiles.find(searchPath) != _packFiles.end()
+        || _searchPathIndex.find(searchPath) != _searchPathIndex.end())
+    {
+        return;
+    }
+    
+    std::unordered_set<std::string> files;
+    if (listDirectory(searchPath, "", files))
+    {
+        _searchPathIndex[searchPath].swap(files);
+    }
+    else
+    {
+        CCLOG("cocos2d: FileUtils: search path %s is not indexed", searchPath.c_str());
+    }
+#else
+    CC_UNUSED_PARAM(searchPath);
+#endif
+}
+
+void FileUtils::setSearchPathIndexEnabled(bool enabled)
+{
+    if (_searchPathIndexEnabled == enabled)
+    {
+        return;
+    }
+    
+    _searchPathIndexEnabled = enabled;
+    _searchPathIndex.clear();
+    if (enabled)
+    {
+        for (auto iter = _searchPathArray.cbegin(); iter != _searchPathArray.cend(); ++iter)
+        {
+            buildSearchPathIndex(*iter);
+        }
+    }
+}
+
+void FileUtils::resetLookupStats()
+{
+    memset(&_lookupStats, 0, sizeof(_lookupStats));
 }
 
 static Data getData(const std::string& filename, bool forString)
@@ -554,6 +722,15 @@ static Data getData(const std::string& filename, bool forString)
 
 std::string FileUtils::getStringFromFile(const std::string& filename)
 {
+    if (!_packFiles.empty() && !filename.empty())
+    {
+        Data packed = getDataFromPackFile(fullPathForFilename(filename));
+        if (!packed.isNull())
+        {
+            return std::string((const char*)packed.getBytes(), packed.getSize());
+        }
+    }
+    
     Data data = getData(filename, true);
     if (data.isNull())
     	return "";
@@ -562,16 +739,128 @@ std::string FileUtils::getStringFromFile(const std::string& filename)
     return ret;
 }
 
+#ifdef CC_FILEUTILS_USE_MMAP
+// Loads a regular file with a single open and fstat. Files of at least
+// mapThreshold bytes are mapped (never if mapThreshold is negative), smaller
+// ones are read through the same descriptor unless mapOnly is set.
+// Returns Data::Null if the file can't be loaded this way.
+static Data loadFile(const std::string& fullPath, ssize_t mapThreshold, bool mapOnly)
+{
+    int fd = open(fullPath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return Data::Null;
+    }
+    
+    Data ret;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        size_t size = static_cast<size_t>(st.st_size);
+        if (mapThreshold >= 0 && st.st_size >= mapThreshold)
+        {
+            // a private writable mapping gives copy-on-write pages to decoders that
+            // patch the buffer in place (e.g. encrypted pvr.ccz), the file is never written
+            void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED)
+            {
+                std::shared_ptr<void> mapping(addr, [size](void* p) { munmap(p, size); });
+                ret.setSharedBytes(static_cast<unsigned char*>(addr), static_cast<ssize_t>(size), mapping);
+            }
+        }
+        
+        if (ret.isNull() && !mapOnly)
+        {
+            unsigned char* buffer = (unsigned char*)malloc(size);
+            size_t done = 0;
+            while (buffer && done < size)
+            {
+                ssize_t n = read(fd, buffer + done, size - done);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    break;
+                done += static_cast<size_t>(n);
+            }
+            
+            if (done > 0)
+                ret.fastSet(buffer, static_cast<ssize_t>(done));
+            else
+                free(buffer);
+        }
+    }
+    // the mapping stays valid after the descriptor is closed
+    close(fd);
+    return ret;
+}
+#endif
+
 Data FileUtils::getDataFromFile(const std::string& filename)
 {
+    if (!_packFiles.empty() && !filename.empty())
+    {
+        Data packed = getDataFromPackFile(fullPathForFilename(filename));
+        if (!packed.isNull())
+        {
+            return packed;
+        }
+    }
+    
+#ifdef CC_FILEUTILS_USE_MMAP
+    if (!filename.empty())
+    {
+        // anything loadFile can't handle (not a regular file, empty) goes through fopen
+        Data ret = loadFile(fullPathForFilename(filename), _fileMappingThreshold, false);
+        if (!ret.isNull())
+        {
+            return ret;
+        }
+    }
+#endif
     return getData(filename, false);
 }
 
+Data FileUtils::getMappedDataFromFile(const std::string& filename)
+{
+    if (filename.empty())
+    {
+        return Data::Null;
+    }
+#ifdef CC_FILEUTILS_USE_MMAP
+    return loadFile(fullPathForFilename(filename), 0, true);
+#else
+    return Data::Null;
+#endif
+}
+
+void FileUtils::setFileMappingThreshold(ssize_t threshold)
+{
+    _fileMappingThreshold = threshold;
+}
+
+ssize_t FileUtils::getFileMappingThreshold() const
+{
+    return _fileMappingThreshold;
+}
+
 unsigned char* FileUtils::getFileData(const std::string& filename, const char* mode, ssize_t *size)
 {
     unsigned char * buffer = nullptr;
     CCASSERT(!filename.empty() && size != nullptr && mode != nullptr, "Invalid parameters.");
     *size = 0;
+    if (!_packFiles.empty() && !filename.empty())
+    {
+        Data packed = getDataFromPackFile(fullPathForFilename(filename));
+        if (!packed.isNull())
+        {
+            // the caller frees the result, so copy out of the (possibly mapped) pack
+            unsigned char* copied = (unsigned char*)malloc(packed.getSize());
+            memcpy(copied, packed.getBytes(), packed.getSize());
+            *size = packed.getSize();
+            return copied;
+        }
+    }
+    
     do
     {
         // read the file from hardware
@@ -666,11 +955,39 @@ std::string FileUtils::getPathForFilename(const std::string& filename, const std
         file = filename.substr(pos+1);
     }
     
+    if (!_packFiles.empty())
+    {
+        auto packIter = _packFiles.find(searchPath);
+        if (packIter != _packFiles.end())
+        {
+            // one hash probe in the pack index instead of a stat call
+            std::string name = file_path + resolutionDirectory + file;
+            ++_lookupStats.fileChecksAvoided;
+            return packIter->second->fileExists(name) ? searchPath + name : "";
+        }
+    }
+    
+    if (!_searchPathIndex.empty())
+    {
+        auto indexIter = _searchPathIndex.find(searchPath);
+        if (indexIter != _searchPathIndex.end())
+        {
+            // the index holds normalized paths only, anything else goes to the file system
+            std::string name = file_path + resolutionDirectory + file;
+            if (name.find("./") == std::string::npos && name.find("//") == std::string::npos)
+            {
+                ++_lookupStats.fileChecksAvoided;
+                return indexIter->second.count(name) ? searchPath + name : "";
+            }
+        }
+    }
+    
     // searchPath + file_path + resourceDirectory
     std::string path = searchPath;
     path += file_path;
     path += resolutionDirectory;
     
+    ++_lookupStats.fileChecks;
     path = getFullPathForDirectoryAndFilename(path, file);
     
     //CCLOG("getPathForFilename, fullPath = %s", path.c_str());
@@ -694,9 +1011,18 @@ std::string FileUtils::fullPathForFilename(const std::string &filename)
     auto cacheIter = _fullPathCache.find(filename);
     if( cacheIter != _fullPathCache.end() )
     {
+        ++_lookupStats.cacheHits;
         return cacheIter->second;
     }
     
+    // Already known to be missing ?
+    if (_missingPathCache.find(filename) != _missingPathCache.end())
+    {
+        ++_lookupStats.missingCacheHits;
+        _lookupStats.fileChecksAvoided += _searchPathArray.size() * _searchResolutionsOrderArray.size();
+        return filename;
+    }
+    
     // Get the new file name.
     const std::string newFilename( getNewFilename(filename) );
     
@@ -712,11 +1038,15 @@ std::string FileUtils::fullPathForFilename(const std::string &filename)
             {
                 // Using the filename passed in as key.
                 _fullPathCache.insert(std::make_pair(filename, fullpath));
+                ++_lookupStats.resolved;
                 return fullpath;
             }
         }
     }
     
+    ++_lookupStats.unresolved;
+    addMissingPath(filename);
+    
     CCLOG("cocos2d: fullPathForFilename: No file found at %s. Possible missing file.", filename.c_str());
 
     // XXX: Should it return nullptr ? or an empty string ?
@@ -733,6 +1063,7 @@ void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& search
 {
     bool existDefault = false;
     _fullPathCache.clear();
+    purgeMissingPaths();
     _searchResolutionsOrderArray.clear();
     for(auto iter = searchResolutionsOrder.cbegin(); iter != searchResolutionsOrder.cend(); ++iter)
     {
@@ -762,6 +1093,7 @@ void FileUtils::addSearchResolutionsOrder(const std::string &order)
         resOrder.append("/");
         
     _searchResolutionsOrderArray.push_back(resOrder);
+    purgeMissingPaths();
 }
 
 const std::vector<std::string>& FileUtils::getSearchResolutionsOrder()
@@ -779,6 +1111,7 @@ void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
     bool existDefaultRootPath = false;
     
     _fullPathCache.clear();
+    purgeMissingPaths();
     _searchPathArray.clear();
     for (auto iter = searchPaths.cbegin(); iter != searchPaths.cend(); ++iter)
     {
@@ -806,6 +1139,46 @@ void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
         //CCLOG("Default root path doesn't exist, adding it.");
         _searchPathArray.push_back(_defaultResRootPath);
     }
+    
+    // keep the packs that are still searched, unmount the others
+    std::unordered_map<std::string, PackFile*> oldPackFiles;
+    oldPackFiles.swap(_packFiles);
+    for (auto iter = _searchPathArray.cbegin(); iter != _searchPathArray.cend(); ++iter)
+    {
+        auto packIter = oldPackFiles.find(*iter);
+        if (packIter != oldPackFiles.end())
+        {
+            _packFiles.insert(*packIter);
+            oldPackFiles.erase(packIter);
+        }
+        else
+        {
+            mountPackFile(*iter);
+        }
+    }
+    for (auto iter = oldPackFiles.begin(); iter != oldPackFiles.end(); ++iter)
+    {
+        delete iter->second;
+    }
+    
+    // index the new search paths, drop the ones no longer searched
+    std::unordered_map<std::string, std::unordered_set<std::string>> oldIndex;
+    oldIndex.swap(_searchPathIndex);
+    if (_searchPathIndexEnabled)
+    {
+        for (auto iter = _searchPathArray.cbegin(); iter != _searchPathArray.cend(); ++iter)
+        {
+            auto indexIter = oldIndex.find(*iter);
+            if (indexIter != oldIndex.end())
+            {
+                _searchPathIndex[*iter].swap(indexIter->second);
+            }
+            else
+            {
+                buildSearchPathIndex(*iter);
+            }
+        }
+    }
 }
 
 void FileUtils::addSearchPath(const std::string &searchpath)
@@ -820,11 +1193,65 @@ void FileUtils::addSearchPath(const std::string &searchpath)
         path += "/";
     }
     _searchPathArray.push_back(path);
+    purgeMissingPaths();
+    mountPackFile(path);
+    if (_searchPathIndexEnabled)
+    {
+        buildSearchPathIndex(path);
+    }
+}
+
+void FileUtils::mountPackFile(const std::string& searchPath)
+{
+    static const std::string packSuffix = ".ccpk/";
+    if (searchPath.length() <= packSuffix.length()
+        || searchPath.compare(searchPath.length() - packSuffix.length(), packSuffix.length(), packSuffix) != 0
+        || _packFiles.find(searchPath) != _packFiles.end())
+    {
+        return;
+    }
+    
+    PackFile* pack = PackFile::open(searchPath.substr(0, searchPath.length() - 1));
+    if (pack)
+    {
+        _fullPathCache.clear();
+        _packFiles[searchPath] = pack;
+    }
+}
+
+PackFile* FileUtils::getPackFileForPath(const std::string& fullPath, std::string* name) const
+{
+    for (auto iter = _packFiles.cbegin(); iter != _packFiles.cend(); ++iter)
+    {
+        const std::string& mountPath = iter->first;
+        if (fullPath.length() > mountPath.length()
+            && fullPath.compare(0, mountPath.length(), mountPath) == 0)
+        {
+            if (name)
+            {
+                *name = fullPath.substr(mountPath.length());
+            }
+            return iter->second;
+        }
+    }
+    return nullptr;
+}
+
+Data FileUtils::getDataFromPackFile(const std::string& fullPath) const
+{
+    std::string name;
+    PackFile* pack = getPackFileForPath(fullPath, &name);
+    if (pack)
+    {
+        return pack->getFileData(name);
+    }
+    return Data::Null;
 }
 
 void FileUtils::setFilenameLookupDictionary(const ValueMap& filenameLookupDict)
 {
     _fullPathCache.clear();    
+    purgeMissingPaths();
     _filenameLookupDict = filenameLookupDict;
 }
 
@@ -869,16 +1296,33 @@ bool FileUtils::isFileExist(const std::string& filename) const
     // If filename is absolute path, we don't need to consider 'search paths' and 'resolution orders'.
     if (isAbsolutePath(filename))
     {
+        std::string name;
+        PackFile* pack = getPackFileForPath(filename, &name);
+        if (pack)
+        {
+            return pack->fileExists(name);
+        }
         return isFileExistInternal(filename);
     }
     
+    FileUtils* self = const_cast<FileUtils*>(this);
+    
     // Already Cached ?
     auto cacheIter = _fullPathCache.find(filename);
     if( cacheIter != _fullPathCache.end() )
     {
+        ++self->_lookupStats.cacheHits;
         return true;
     }
     
+    // Already known to be missing ?
+    if (_missingPathCache.find(filename) != _missingPathCache.end())
+    {
+        ++self->_lookupStats.missingCacheHits;
+        self->_lookupStats.fileChecksAvoided += _searchPathArray.size() * _searchResolutionsOrderArray.size();
+        return false;
+    }
+    
     // Get the new file name.
     const std::string newFilename( getNewFilename(filename) );
     
@@ -888,16 +1332,20 @@ bool FileUtils::isFileExist(const std::string& filename) const
     {
         for (auto resolutionIt = _searchResolutionsOrderArray.cbegin(); resolutionIt != _searchResolutionsOrderArray.cend(); ++resolutionIt)
         {
-            fullpath = const_cast<FileUtils*>(this)->getPathForFilename(newFilename, *resolutionIt, *searchIt);
+            fullpath = self->getPathForFilename(newFilename, *resolutionIt, *searchIt);
             
             if (!fullpath.empty())
             {
                 // Using the filename passed in as key.
-                const_cast<FileUtils*>(this)->_fullPathCache.insert(std::make_pair(filename, fullpath));
+                self->_fullPathCache.insert(std::make_pair(filename, fullpath));
+                ++self->_lookupStats.resolved;
                 return true;
             }
         }
     }
+    
+    ++self->_lookupStats.unresolved;
+    self->addMissingPath(filename);
     return false;
 }
 
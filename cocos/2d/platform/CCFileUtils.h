@@ -33,9 +33,13 @@ THE SOFTWARE.
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
+#include <deque>
 
 NS_CC_BEGIN
 
+class PackFile;
+
 /**
  * @addtogroup platform
  * @{
@@ -75,6 +79,8 @@ public:
      *        例如：在CocosPlayer这个示例中，每次你从CocosBuilder运行程序的时候，
      * 	      所有的资源都会下载到可写的文件夹里面。
      * 	      在js程序运行之前，这个方法应该被调用来清空文件查找缓存
+     *        未找到文件的缓存也会被清空: 一个文件名在查找失败后会一直被当作不存在,
+     *        直到查找路径, 解析顺序变化或调用此方法. 在查找路径中下载或写入新文件后需要调用它.
      *       
      */
     virtual void purgeCachedEntries();
@@ -90,6 +96,20 @@ public:
      */
     virtual Data getDataFromFile(const std::string& filename);
     
+    /**
+     *  以只读内存映射的方式获得文件内容, 数据不会被复制到堆上.
+     *  返回的 Data 持有映射, 最后一个引用释放时解除映射. 映射是写时复制的, 修改缓冲区不会写回文件.
+     *  @return 平台不支持或映射失败时返回空的 Data.
+     */
+    virtual Data getMappedDataFromFile(const std::string& filename);
+    
+    /**
+     *  设置或获得 getDataFromFile 使用内存映射的文件大小下限(字节), 默认为 64KB.
+     *  小于该值的文件仍然整体读入内存, 负数表示不使用内存映射 (ZipFile 也不再映射压缩包).
+     */
+    void setFileMappingThreshold(ssize_t threshold);
+    ssize_t getFileMappingThreshold() const;
+    
     /**
      *  获取资源文件数据
      *
@@ -251,6 +271,7 @@ public:
      *        在Android上，默认的资源根路径是 "assets/".
      *        	如果把"/mnt/sdcard/" 和"resources-large" 传递到 查找路径的vector中,因为它是一个相对路径，
      * 	        所以"resources-large" 会被转换成 "assets/resources-large" 
+     *        以 ".ccpk" 结尾的查找路径会被当作资源包(见 PackFile)挂载, 包内文件的完整路径为 "资源包路径/包内路径".
      *
      *  @param searchPaths 包含查找路径的array
      *  @see fullPathForFilename(const char*)
@@ -261,7 +282,7 @@ public:
     virtual void setSearchPaths(const std::vector<std::string>& searchPaths);
     
     /**
-      * 添加查找路径
+      * 添加查找路径, 以 ".ccpk" 结尾的路径会被当作资源包挂载
       *
       * @since v2.1
       */
@@ -329,6 +350,31 @@ public:
 
     /**返回完整路径的缓存 */
     const std::unordered_map<std::string, std::string>& getFullPathCache() const { return _fullPathCache; }
+    
+    /**
+     *  开启后, 在设置查找路径时为每个查找路径建立一次目录索引, 查找文件时用索引代替文件系统检查.
+     *  @note 索引区分大小写. 在查找路径中新增文件(例如下载更新)后需要调用 purgeCachedEntries() 重建索引.
+     *        不能列出目录的平台(如 Android 的 assets)会自动退回到文件系统检查. 默认关闭.
+     */
+    void setSearchPathIndexEnabled(bool enabled);
+    bool isSearchPathIndexEnabled() const { return _searchPathIndexEnabled; }
+    
+    /** 返回每个查找路径的目录索引(相对路径集合), 只包含成功建立索引的查找路径 */
+    const std::unordered_map<std::string, std::unordered_set<std::string>>& getSearchPathIndex() const { return _searchPathIndex; }
+    
+    /** 文件查找的统计信息, 可以通过 Console 的 "fileutils" 命令查看 */
+    struct LookupStats
+    {
+        unsigned int cacheHits;         ///< 命中完整路径缓存
+        unsigned int missingCacheHits;  ///< 命中未找到文件的缓存
+        unsigned int resolved;          ///< 遍历查找路径后找到
+        unsigned int unresolved;        ///< 遍历查找路径后未找到
+        unsigned int fileChecks;        ///< 实际检查文件系统的次数
+        unsigned int fileChecksAvoided; ///< 由缓存, 目录索引或资源包索引代替的文件系统检查次数
+    };
+    
+    const LookupStats& getLookupStats() const { return _lookupStats; }
+    void resetLookupStats();
 
 protected:
     /**
@@ -381,6 +427,36 @@ protected:
      */
     virtual std::string getFullPathForDirectoryAndFilename(const std::string& directory, const std::string& filename);
     
+    /**
+     *  记录一个没有找到的文件名. 缓存有大小上限, 超出时丢弃最早的记录
+     */
+    void addMissingPath(const std::string& filename);
+    
+    /**
+     *  清空未找到文件的缓存, 查找路径, 解析顺序或文件名查找词典变化时调用
+     */
+    void purgeMissingPaths();
+    
+    /**
+     *  为一个查找路径建立目录索引, 目录无法列出或文件过多时不建立
+     */
+    void buildSearchPathIndex(const std::string& searchPath);
+    
+    /**
+     *  如果查找路径以 ".ccpk" 结尾并且还没有挂载, 打开这个资源包
+     */
+    void mountPackFile(const std::string& searchPath);
+    
+    /**
+     *  返回包含这个完整路径的已挂载资源包, name 返回包内的文件名. 不在资源包中时返回 nullptr
+     */
+    PackFile* getPackFileForPath(const std::string& fullPath, std::string* name) const;
+    
+    /**
+     *  如果完整路径位于已挂载的资源包中, 从资源包读取数据, 否则返回空的 Data
+     */
+    Data getDataFromPackFile(const std::string& fullPath) const;
+    
     
     /**基于键值查找文件名的Dictionary变量
      * 常下面的这些方法中使用：
@@ -418,6 +494,30 @@ protected:
      */
     std::unordered_map<std::string, std::string> _fullPathCache;
     
+    /**
+     * getDataFromFile 使用内存映射的文件大小下限, 负数表示关闭.
+     */
+    ssize_t _fileMappingThreshold;
+    
+    /**
+     * 已挂载的资源包, 以查找路径(以 '/' 结尾)为键
+     */
+    std::unordered_map<std::string, PackFile*> _packFiles;
+    
+    /**
+     * 未找到的文件名的缓存, _missingPathOrder 按加入顺序记录, 用于限制大小
+     */
+    std::unordered_set<std::string> _missingPathCache;
+    std::deque<std::string> _missingPathOrder;
+    
+    /**
+     * 查找路径的目录索引, 以查找路径为键, 值为该路径下所有文件的相对路径
+     */
+    std::unordered_map<std::string, std::unordered_set<std::string>> _searchPathIndex;
+    bool _searchPathIndexEnabled;
+    
+    LookupStats _lookupStats;
+    
     /**
      *   FileUtils的单例指针
      */
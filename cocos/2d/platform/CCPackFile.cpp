@@ -0,0 +1,379 @@
+/****************************************************************************
+ Copyright (c) 2014 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/platform/CCPackFile.h"
+#include "2d/platform/CCFileUtils.h"
+#include "base/ccMacros.h"
+
+#include <zlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT) && (CC_TARGET_PLATFORM != CC_PLATFORM_WP8)
+#define CC_PACKFILE_USE_PREAD 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <limits>
+#endif
+
+NS_CC_BEGIN
+
+static const uint32_t PACK_VERSION = 1;
+
+// on-disk layout, see tools/packer/make_pack.py
+struct PackFile::Header
+{
+    char magic[4];          // "CCPK"
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t slotCount;     // power of two, greater than entryCount
+    uint32_t alignment;
+    uint32_t namesSize;
+    uint32_t reserved[2];
+};
+
+struct PackFile::Entry
+{
+    uint64_t hash;
+    uint64_t offset;
+    uint32_t size;          // uncompressed size
+    uint32_t storedSize;    // size inside the pack
+    uint32_t nameOffset;
+    uint16_t nameLength;
+    uint8_t compression;
+    uint8_t reserved;
+};
+
+// header, hash slots (entry index + 1, 0 = empty), entries, names
+uint64_t PackFile::indexSizeOf(const Header& header)
+{
+    static_assert(sizeof(Header) == 32, "pack header must be 32 bytes");
+    static_assert(sizeof(Entry) == 32, "pack entry must be 32 bytes");
+    
+    return sizeof(Header)
+        + (uint64_t)header.slotCount * sizeof(uint32_t)
+        + (uint64_t)header.entryCount * sizeof(Entry)
+        + header.namesSize;
+}
+
+PackFile* PackFile::open(const std::string& fullPath)
+{
+    PackFile* pack = new PackFile();
+    if (!pack->initWithFile(fullPath))
+    {
+        CCLOG("cocos2d: PackFile: can't open %s", fullPath.c_str());
+        delete pack;
+        return nullptr;
+    }
+    return pack;
+}
+
+uint64_t PackFile::hashName(const char* name, size_t length)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= (unsigned char)name[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+PackFile::PackFile()
+: _fileSize(0)
+, _fd(-1)
+, _file(nullptr)
+, _slots(nullptr)
+, _slotMask(0)
+, _entries(nullptr)
+, _entryCount(0)
+, _names(nullptr)
+, _namesSize(0)
+{
+}
+
+PackFile::~PackFile()
+{
+    // outstanding Data slices keep _archive alive on their own
+#ifdef CC_PACKFILE_USE_PREAD
+    if (_fd >= 0)
+    {
+        close(_fd);
+    }
+#endif
+    if (_file)
+    {
+        fclose(_file);
+    }
+}
+
+bool PackFile::initWithFile(const std::string& fullPath)
+{
+    _path = fullPath;
+    
+    auto fileUtils = FileUtils::getInstance();
+    Data mapped = fileUtils->getMappedDataFromFile(fullPath);
+    if (!mapped.isNull())
+    {
+        _archive = std::make_shared<Data>(std::move(mapped));
+    }
+    else
+    {
+        uint64_t fileSize = 0;
+        if (openForReading(&fileSize))
+        {
+            // no mapping, keep only the index in memory and read entries on demand
+            Header header;
+            bool ok = fileSize >= sizeof(header) && readRange(0, (unsigned char*)&header, sizeof(header));
+            uint64_t indexSize = ok ? indexSizeOf(header) : 0;
+            ok = ok && indexSize <= fileSize;
+            if (ok)
+            {
+                unsigned char* index = (unsigned char*)malloc((size_t)indexSize);
+                memcpy(index, &header, sizeof(header));
+                ok = readRange(sizeof(header), index + sizeof(header), (ssize_t)(indexSize - sizeof(header)));
+                _index.fastSet(index, (ssize_t)indexSize);
+            }
+            
+            return ok && parseIndex(_index.getBytes(), _index.getSize(), fileSize);
+        }
+        
+        // e.g. packs inside the Android apk, which can only be loaded as a whole
+        Data whole = fileUtils->getDataFromFile(fullPath);
+        if (whole.isNull())
+        {
+            return false;
+        }
+        _archive = std::make_shared<Data>(std::move(whole));
+    }
+    
+    return parseIndex(_archive->getBytes(), _archive->getSize(), (uint64_t)_archive->getSize());
+}
+
+bool PackFile::parseIndex(const unsigned char* index, ssize_t indexSize, uint64_t fileSize)
+{
+    if (indexSize < (ssize_t)sizeof(Header))
+    {
+        return false;
+    }
+    
+    const Header* header = reinterpret_cast<const Header*>(index);
+    if (memcmp(header->magic, "CCPK", 4) != 0 || header->version != PACK_VERSION)
+    {
+        CCLOG("cocos2d: PackFile: %s is not a version %u pack", _path.c_str(), PACK_VERSION);
+        return false;
+    }
+    
+    uint32_t slotCount = header->slotCount;
+    if (slotCount == 0 || (slotCount & (slotCount - 1)) != 0 || slotCount <= header->entryCount)
+    {
+        return false;
+    }
+    
+    uint64_t size = indexSizeOf(*header);
+    if (size > (uint64_t)indexSize || size > fileSize)
+    {
+        return false;
+    }
+    
+    _fileSize = fileSize;
+    _slots = reinterpret_cast<const uint32_t*>(index + sizeof(Header));
+    _slotMask = slotCount - 1;
+    _entries = reinterpret_cast<const Entry*>(_slots + slotCount);
+    _entryCount = header->entryCount;
+    _names = reinterpret_cast<const char*>(_entries + _entryCount);
+    _namesSize = header->namesSize;
+    return true;
+}
+
+const PackFile::Entry* PackFile::findEntry(const std::string& name) const
+{
+    if (!_slots || name.empty())
+    {
+        return nullptr;
+    }
+    
+    uint64_t hash = hashName(name.data(), name.size());
+    
+    // linear probing, the table always has empty slots
+    uint32_t i = (uint32_t)hash & _slotMask;
+    for (uint32_t probes = 0; probes <= _slotMask; ++probes, i = (i + 1) & _slotMask)
+    {
+        uint32_t slot = _slots[i];
+        if (slot == 0 || slot > _entryCount)
+        {
+            return nullptr;
+        }
+        
+        const Entry* entry = &_entries[slot - 1];
+        if (entry->hash == hash
+            && entry->nameLength == name.size()
+            && (uint64_t)entry->nameOffset + entry->nameLength <= _namesSize
+            && memcmp(_names + entry->nameOffset, name.data(), name.size()) == 0)
+        {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+bool PackFile::fileExists(const std::string& name) const
+{
+    return findEntry(name) != nullptr;
+}
+
+bool PackFile::openForReading(uint64_t* fileSize)
+{
+#ifdef CC_PACKFILE_USE_PREAD
+    _fd = ::open(_path.c_str(), O_RDONLY);
+    if (_fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(_fd, &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        return false;
+    }
+    *fileSize = (uint64_t)st.st_size;
+    return true;
+#else
+    _file = fopen(_path.c_str(), "rb");
+    if (!_file || _fseeki64(_file, 0, SEEK_END) != 0)
+    {
+        return false;
+    }
+    *fileSize = (uint64_t)_ftelli64(_file);
+    return true;
+#endif
+}
+
+bool PackFile::readRange(uint64_t offset, unsigned char* buffer, ssize_t size) const
+{
+#ifdef CC_PACKFILE_USE_PREAD
+    // off_t is 32 bits on 32-bit Android builds without large file support
+    if (_fd < 0 || offset + (uint64_t)size > (uint64_t)std::numeric_limits<off_t>::max())
+    {
+        CCLOG("cocos2d: PackFile: can't read past 2GB of %s on this platform", _path.c_str());
+        return false;
+    }
+    
+    // pread doesn't move a shared file position, loader threads can read at the same time
+    ssize_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = pread(_fd, buffer + done, size - done, (off_t)(offset + done));
+        if (n <= 0)
+        {
+            return false;
+        }
+        done += n;
+    }
+    return true;
+#else
+    std::lock_guard<std::mutex> lock(_fileMutex);
+    return _file
+        && _fseeki64(_file, (__int64)offset, SEEK_SET) == 0
+        && fread(buffer, 1, size, _file) == (size_t)size;
+#endif
+}
+
+Data PackFile::getFileData(const std::string& name) const
+{
+    const Entry* entry = findEntry(name);
+    if (!entry || entry->size == 0)
+    {
+        return Data::Null;
+    }
+    
+    if (entry->offset + entry->storedSize > _fileSize)
+    {
+        CCLOG("cocos2d: PackFile: entry %s is out of range in %s", name.c_str(), _path.c_str());
+        return Data::Null;
+    }
+    
+    Data ret;
+    if (entry->compression == (uint8_t)Compression::NONE && entry->storedSize == entry->size)
+    {
+        if (_archive)
+        {
+            // zero copy, the slice keeps the mapping alive
+            ret.setSharedBytes(_archive->getBytes() + entry->offset, entry->size, _archive);
+        }
+        else
+        {
+            unsigned char* buffer = (unsigned char*)malloc(entry->size);
+            if (readRange(entry->offset, buffer, entry->size))
+            {
+                ret.fastSet(buffer, entry->size);
+            }
+            else
+            {
+                free(buffer);
+            }
+        }
+    }
+    else if (entry->compression == (uint8_t)Compression::ZLIB)
+    {
+        Data stored;
+        const unsigned char* source = nullptr;
+        if (_archive)
+        {
+            source = _archive->getBytes() + entry->offset;
+        }
+        else
+        {
+            unsigned char* buffer = (unsigned char*)malloc(entry->storedSize);
+            if (!readRange(entry->offset, buffer, entry->storedSize))
+            {
+                free(buffer);
+                return Data::Null;
+            }
+            stored.fastSet(buffer, entry->storedSize);
+            source = buffer;
+        }
+        
+        // the uncompressed size is known, so inflate in one call without growing the buffer
+        unsigned char* buffer = (unsigned char*)malloc(entry->size);
+        uLongf length = entry->size;
+        if (uncompress(buffer, &length, source, entry->storedSize) == Z_OK && length == entry->size)
+        {
+            ret.fastSet(buffer, entry->size);
+        }
+        else
+        {
+            CCLOG("cocos2d: PackFile: failed to inflate %s in %s", name.c_str(), _path.c_str());
+            free(buffer);
+        }
+    }
+    else
+    {
+        CCLOG("cocos2d: PackFile: unsupported entry %s in %s (compression %u)", name.c_str(), _path.c_str(), (unsigned)entry->compression);
+    }
+    
+    return ret;
+}
+
+NS_CC_END
@@ -0,0 +1,121 @@
+/****************************************************************************
+ Copyright (c) 2014 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCPACKFILE_H__
+#define __CCPACKFILE_H__
+
+#include "base/CCPlatformMacros.h"
+#include "base/CCData.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <memory>
+#include <mutex>
+#include <string>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup platform
+ * @{
+ */
+
+/** @brief 带哈希索引的资源包(.ccpk), 由 tools/packer/make_pack.py 生成.
+ 
+ 文件头之后依次是哈希槽, 文件条目和文件名表, 查找文件只需要一次哈希探测.
+ 每个文件按对齐方式存储, 可以不压缩(读取时直接引用内存映射)或单独使用 zlib 压缩.
+ 通过把资源包路径加入 FileUtils 的搜索路径来挂载, 例如 addSearchPath("res/assets.ccpk").
+ 所有字段均为小端字节序.
+ */
+class CC_DLL PackFile
+{
+public:
+    enum class Compression
+    {
+        NONE = 0,
+        ZLIB = 1,
+    };
+
+    /** 打开资源包并加载索引, 失败时返回 nullptr. 返回的对象由调用者 delete. */
+    static PackFile* open(const std::string& fullPath);
+
+    /** 资源包文件名使用的哈希(64 位 FNV-1a), 打包工具必须使用相同的算法 */
+    static uint64_t hashName(const char* name, size_t length);
+
+    ~PackFile();
+
+    /** 返回资源包的完整路径 */
+    inline const std::string& getPath() const { return _path; }
+
+    /** 返回资源包内的文件数量 */
+    inline ssize_t getFileCount() const { return _entryCount; }
+
+    /** 检查资源包内是否有这个文件, name 为相对于包根目录的路径, 例如 "Images/grossini.png" */
+    bool fileExists(const std::string& name) const;
+
+    /** 读取资源包内文件的内容.
+     不压缩的文件在资源包被内存映射时直接引用映射, 不复制数据; 否则读取或解压到新的缓冲区.
+     @return 文件不存在或读取失败时返回空的 Data.
+     */
+    Data getFileData(const std::string& name) const;
+
+private:
+    struct Header;
+    struct Entry;
+
+    static uint64_t indexSizeOf(const Header& header);
+
+    PackFile();
+    bool initWithFile(const std::string& fullPath);
+    bool openForReading(uint64_t* fileSize);
+    bool parseIndex(const unsigned char* index, ssize_t indexSize, uint64_t fileSize);
+    const Entry* findEntry(const std::string& name) const;
+    bool readRange(uint64_t offset, unsigned char* buffer, ssize_t size) const;
+
+    std::string _path;
+    uint64_t _fileSize;
+
+    // the whole pack (mapped when possible), or null when entries are read from disk
+    std::shared_ptr<Data> _archive;
+    // copy of the index when the pack is not kept in memory
+    Data _index;
+    // kept open for reading entries when the pack is not in memory, reads go
+    // through pread() where available, otherwise seek + read under the mutex
+    int _fd;
+    FILE* _file;
+    mutable std::mutex _fileMutex;
+
+    const uint32_t* _slots;
+    uint32_t _slotMask;
+    const Entry* _entries;
+    uint32_t _entryCount;
+    const char* _names;
+    uint32_t _namesSize;
+};
+
+// end of platform group
+/// @}
+
+NS_CC_END
+
+#endif // __CCPACKFILE_H__
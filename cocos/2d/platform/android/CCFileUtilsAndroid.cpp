@@ -242,6 +242,15 @@ Data FileUtilsAndroid::getData(const std::string& filename, bool forString)
 
 std::string FileUtilsAndroid::getStringFromFile(const std::string& filename)
 {
+    if (!_packFiles.empty() && !filename.empty())
+    {
+        Data packed = getDataFromPackFile(fullPathForFilename(filename));
+        if (!packed.isNull())
+        {
+            return std::string((const char*)packed.getBytes(), packed.getSize());
+        }
+    }
+
     Data data = getData(filename, true);
     if (data.isNull())
         return "";
@@ -252,6 +261,15 @@ std::string FileUtilsAndroid::getStringFromFile(const std::string& filename)
     
 Data FileUtilsAndroid::getDataFromFile(const std::string& filename)
 {
+    if (!_packFiles.empty() && !filename.empty())
+    {
+        Data packed = getDataFromPackFile(fullPathForFilename(filename));
+        if (!packed.isNull())
+        {
+            return packed;
+        }
+    }
+
     return getData(filename, false);
 }
 
@@ -264,6 +282,19 @@ unsigned char* FileUtilsAndroid::getFileData(const std::string& filename, const
         return 0;
     }
     
+    if (!_packFiles.empty() && !filename.empty())
+    {
+        Data packed = getDataFromPackFile(fullPathForFilename(filename));
+        if (!packed.isNull())
+        {
+            // the caller frees the result, so copy out of the (possibly mapped) pack
+            unsigned char* copied = (unsigned char*)malloc(packed.getSize());
+            memcpy(copied, packed.getBytes(), packed.getSize());
+            *size = packed.getSize();
+            return copied;
+        }
+    }
+    
     string fullPath = fullPathForFilename(filename);
     
     if (fullPath[0] != '/')
@@ -429,6 +429,8 @@ bool FileUtilsApple::writeToFile(ValueMap& dict, const std::string &fullPath)
     // do it atomically
     [nsDict writeToFile:file atomically:YES];
     
+    // the file may have been looked up (and missed) before it was written
+    purgeMissingPaths();
     return true;
 }
 
@@ -39,6 +39,20 @@ THE SOFTWARE.
 #define GL_DEPTH24_STENCIL8			GL_DEPTH24_STENCIL8_OES
 #define GL_WRITE_ONLY				GL_WRITE_ONLY_OES
 
+#define glMapBufferRange			glMapBufferRangeEXT
+#define GL_MAP_WRITE_BIT			GL_MAP_WRITE_BIT_EXT
+#define GL_MAP_INVALIDATE_RANGE_BIT	GL_MAP_INVALIDATE_RANGE_BIT_EXT
+#define GL_MAP_INVALIDATE_BUFFER_BIT	GL_MAP_INVALIDATE_BUFFER_BIT_EXT
+#define GL_MAP_UNSYNCHRONIZED_BIT	GL_MAP_UNSYNCHRONIZED_BIT_EXT
+
+#define glFenceSync					glFenceSyncAPPLE
+#define glClientWaitSync			glClientWaitSyncAPPLE
+#define glDeleteSync				glDeleteSyncAPPLE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE	GL_SYNC_GPU_COMMANDS_COMPLETE_APPLE
+#define GL_SYNC_FLUSH_COMMANDS_BIT	GL_SYNC_FLUSH_COMMANDS_BIT_APPLE
+#define GL_TIMEOUT_EXPIRED			GL_TIMEOUT_EXPIRED_APPLE
+#define GL_WAIT_FAILED				GL_WAIT_FAILED_APPLE
+
 #include <OpenGLES/ES2/gl.h>
 #include <OpenGLES/ES2/glext.h>
 
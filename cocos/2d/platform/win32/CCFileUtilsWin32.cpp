@@ -195,6 +195,15 @@ static Data getData(const std::string& filename, bool forString)
 
 std::string FileUtilsWin32::getStringFromFile(const std::string& filename)
 {
+    if (!_packFiles.empty() && !filename.empty())
+    {
+        Data packed = getDataFromPackFile(fullPathForFilename(filename));
+        if (!packed.isNull())
+        {
+            return std::string((const char*)packed.getBytes(), packed.getSize());
+        }
+    }
+
     Data data = getData(filename, true);
 	if (data.isNull())
 	{
@@ -207,6 +216,15 @@ std::string FileUtilsWin32::getStringFromFile(const std::string& filename)
     
 Data FileUtilsWin32::getDataFromFile(const std::string& filename)
 {
+    if (!_packFiles.empty() && !filename.empty())
+    {
+        Data packed = getDataFromPackFile(fullPathForFilename(filename));
+        if (!packed.isNull())
+        {
+            return packed;
+        }
+    }
+
     return getData(filename, false);
 }
 
@@ -214,6 +232,19 @@ unsigned char* FileUtilsWin32::getFileData(const std::string& filename, const ch
 {
     unsigned char * pBuffer = NULL;
     *size = 0;
+    if (!_packFiles.empty() && !filename.empty())
+    {
+        Data packed = getDataFromPackFile(fullPathForFilename(filename));
+        if (!packed.isNull())
+        {
+            // the caller frees the result, so copy out of the (possibly mapped) pack
+            unsigned char* copied = (unsigned char*)malloc(packed.getSize());
+            memcpy(copied, packed.getBytes(), packed.getSize());
+            *size = packed.getSize();
+            return copied;
+        }
+    }
+    
     do
     {
         // read the file from hardware
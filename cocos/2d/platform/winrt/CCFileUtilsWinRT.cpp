@@ -185,6 +185,15 @@ static Data getData(const std::string& filename, bool forString)
 
 std::string CCFileUtilsWinRT::getStringFromFile(const std::string& filename)
 {
+    if (!_packFiles.empty() && !filename.empty())
+    {
+        Data packed = getDataFromPackFile(fullPathForFilename(filename));
+        if (!packed.isNull())
+        {
+            return std::string((const char*)packed.getBytes(), packed.getSize());
+        }
+    }
+
     Data data = getData(filename, true);
 	if (data.isNull())
 	{
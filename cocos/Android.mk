@@ -51,6 +51,7 @@ cocos2d.cpp \
 2d/CCMotionStreak.cpp \
 2d/CCNode.cpp \
 2d/CCNodeGrid.cpp \
+2d/CCCullingNode.cpp \
 2d/CCParallaxNode.cpp \
 2d/CCParticleBatchNode.cpp \
 2d/CCParticleExamples.cpp \
@@ -87,6 +88,7 @@ cocos2d.cpp \
 2d/platform/CCGLViewProtocol.cpp \
 2d/platform/CCFileUtils.cpp \
 2d/platform/CCSAXParser.cpp \
+2d/platform/CCPackFile.cpp \
 2d/platform/CCThread.cpp \
 2d/platform/CCImage.cpp \
 math/CCAffineTransform.cpp \
@@ -123,6 +125,7 @@ base/CCNS.cpp \
 base/CCProfiling.cpp \
 base/CCRef.cpp \
 base/CCScheduler.cpp \
+base/CCThreadPool.cpp \
 base/CCTouch.cpp \
 base/CCValue.cpp \
 base/ZipUtils.cpp \
@@ -141,6 +144,7 @@ renderer/CCGroupCommand.cpp \
 renderer/CCQuadCommand.cpp \
 renderer/CCRenderCommand.cpp \
 renderer/CCRenderer.cpp \
+renderer/CCStreamBuffer.cpp \
 renderer/CCGLProgramCache.cpp \
 renderer/ccShaders.cpp \
 deprecated/CCArray.cpp \
@@ -25,25 +25,104 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/ccMacros.h"
 
+#include <algorithm>
+#include <typeinfo>
+
+// __thread is not available on older iOS deployment targets, so POSIX
+// platforms keep the current pool in a pthread key
+#if defined(_MSC_VER)
+#define CC_POOL_USE_DECLSPEC_THREAD 1
+#else
+#include <pthread.h>
+#endif
+
 NS_CC_BEGIN
 
+struct AutoreleasePool::Block
+{
+    // 8KB on 64 bit platforms including the header
+    static const int CAPACITY = 1022;
+    
+    Block* next;
+    size_t count;
+    Ref* objects[CAPACITY];
+};
+
+namespace
+{
+#ifdef CC_POOL_USE_DECLSPEC_THREAD
+    // Top of the pool stack of the calling thread, nullptr if the thread has no pool yet
+    __declspec(thread) AutoreleasePool* s_currentPool = nullptr;
+    
+    inline AutoreleasePool* getThreadPool()
+    {
+        return s_currentPool;
+    }
+    
+    inline void setThreadPool(AutoreleasePool* pool)
+    {
+        s_currentPool = pool;
+    }
+#else
+    // Top of the pool stack of the calling thread, nullptr if the thread has no pool yet
+    pthread_key_t s_currentPoolKey;
+    pthread_once_t s_currentPoolKeyOnce = PTHREAD_ONCE_INIT;
+    
+    void createCurrentPoolKey()
+    {
+        pthread_key_create(&s_currentPoolKey, nullptr);
+    }
+    
+    inline AutoreleasePool* getThreadPool()
+    {
+        pthread_once(&s_currentPoolKeyOnce, createCurrentPoolKey);
+        return static_cast<AutoreleasePool*>(pthread_getspecific(s_currentPoolKey));
+    }
+    
+    inline void setThreadPool(AutoreleasePool* pool)
+    {
+        pthread_once(&s_currentPoolKeyOnce, createCurrentPoolKey);
+        pthread_setspecific(s_currentPoolKey, pool);
+    }
+#endif
+    
+    // Guards AutoreleasePool::s_freeBlocks
+    std::mutex s_freeBlocksMutex;
+    const int MAX_FREE_BLOCKS = 64;
+    
+    const size_t INSTRUMENTED_FRAMES = 60;
+}
+
+AutoreleasePool::Block* AutoreleasePool::s_freeBlocks = nullptr;
+int AutoreleasePool::s_freeBlockCount = 0;
+
 AutoreleasePool::AutoreleasePool()
-: _name("")
+: _firstBlock(nullptr)
+, _currentBlock(nullptr)
+, _spareBlocks(nullptr)
+, _objectCount(0)
+, _previousPool(getThreadPool())
+, _name("")
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
 , _isClearing(false)
 #endif
 {
-    _managedObjectArray.reserve(150);
+    setThreadPool(this);
     PoolManager::getInstance()->push(this);
 }
 
 AutoreleasePool::AutoreleasePool(const std::string &name)
-: _name(name)
+: _firstBlock(nullptr)
+, _currentBlock(nullptr)
+, _spareBlocks(nullptr)
+, _objectCount(0)
+, _previousPool(getThreadPool())
+, _name(name)
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
 , _isClearing(false)
 #endif
 {
-    _managedObjectArray.reserve(150);
+    setThreadPool(this);
     PoolManager::getInstance()->push(this);
 }
 
@@ -52,24 +131,114 @@ AutoreleasePool::~AutoreleasePool()
     CCLOGINFO("deallocing AutoreleasePool: %p", this);
     clear();
     
-    PoolManager::getInstance()->pop();
+    if (getThreadPool() == this)
+    {
+        setThreadPool(_previousPool);
+    }
+    PoolManager::getInstance()->pop(this);
+    
+    // Hand the blocks over to the pools created later
+    std::lock_guard<std::mutex> lock(s_freeBlocksMutex);
+    while (_spareBlocks)
+    {
+        Block* block = _spareBlocks;
+        _spareBlocks = block->next;
+        
+        if (s_freeBlockCount < MAX_FREE_BLOCKS)
+        {
+            block->next = s_freeBlocks;
+            s_freeBlocks = block;
+            ++s_freeBlockCount;
+        }
+        else
+        {
+            delete block;
+        }
+    }
+}
+
+AutoreleasePool::Block* AutoreleasePool::acquireBlock()
+{
+    Block* block = _spareBlocks;
+    if (block)
+    {
+        _spareBlocks = block->next;
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(s_freeBlocksMutex);
+        if (s_freeBlocks)
+        {
+            block = s_freeBlocks;
+            s_freeBlocks = block->next;
+            --s_freeBlockCount;
+        }
+    }
+    
+    if (block == nullptr)
+    {
+        block = new Block();
+    }
+    
+    block->next = nullptr;
+    block->count = 0;
+    return block;
 }
 
 void AutoreleasePool::addObject(Ref* object)
 {
-    _managedObjectArray.push_back(object);
+    if (_currentBlock == nullptr || _currentBlock->count == Block::CAPACITY)
+    {
+        Block* block = acquireBlock();
+        if (_currentBlock)
+            _currentBlock->next = block;
+        else
+            _firstBlock = block;
+        _currentBlock = block;
+    }
+    
+    _currentBlock->objects[_currentBlock->count++] = object;
+    ++_objectCount;
 }
 
 void AutoreleasePool::clear()
 {
+    if (PoolManager::s_instrumentationEnabled && this == PoolManager::getInstance()->_curReleasePool)
+    {
+        PoolManager::getInstance()->recordFrame();
+    }
+    
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     _isClearing = true;
 #endif
-    for (const auto &obj : _managedObjectArray)
+    // Detach the objects first, releasing them may autorelease new objects into this pool.
+    // Those are kept until the next clear.
+    Block* releasing = _firstBlock;
+    _firstBlock = _currentBlock = nullptr;
+    _objectCount = 0;
+    
+    Block* last = nullptr;
+    for (Block* block = releasing; block; block = block->next)
     {
-        obj->release();
+        Ref** objects = block->objects;
+        size_t count = block->count;
+        for (size_t i = 0; i < count; ++i)
+        {
+#if defined(__GNUC__)
+            // the reference counts are scattered over the heap, start loading the next ones early
+            if (i + 8 < count)
+                __builtin_prefetch(objects[i + 8]);
+#endif
+            objects[i]->release();
+        }
+        last = block;
+    }
+    
+    if (last)
+    {
+        last->next = _spareBlocks;
+        _spareBlocks = releasing;
     }
-    _managedObjectArray.clear();
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     _isClearing = false;
 #endif
@@ -77,22 +246,29 @@ void AutoreleasePool::clear()
 
 bool AutoreleasePool::contains(Ref* object) const
 {
-    for (const auto& obj : _managedObjectArray)
+    for (Block* block = _firstBlock; block; block = block->next)
     {
-        if (obj == object)
-            return true;
+        for (size_t i = 0; i < block->count; ++i)
+        {
+            if (block->objects[i] == object)
+                return true;
+        }
     }
     return false;
 }
 
 void AutoreleasePool::dump()
 {
-    CCLOG("autorelease pool: %s, number of managed object %d\n", _name.c_str(), static_cast<int>(_managedObjectArray.size()));
+    CCLOG("autorelease pool: %s, number of managed object %d\n", _name.c_str(), static_cast<int>(_objectCount));
     CCLOG("%20s%20s%20s", "Object pointer", "Object id", "reference count");
-    for (const auto &obj : _managedObjectArray)
+    for (Block* block = _firstBlock; block; block = block->next)
     {
-        CC_UNUSED_PARAM(obj);
-        CCLOG("%20p%20u\n", obj, obj->getReferenceCount());
+        for (size_t i = 0; i < block->count; ++i)
+        {
+            Ref* obj = block->objects[i];
+            CC_UNUSED_PARAM(obj);
+            CCLOG("%20p%20u\n", obj, obj->getReferenceCount());
+        }
     }
 }
 
@@ -104,15 +280,15 @@ void AutoreleasePool::dump()
 //--------------------------------------------------------------------
 
 PoolManager* PoolManager::s_singleInstance = nullptr;
+bool PoolManager::s_instrumentationEnabled = false;
 
 PoolManager* PoolManager::getInstance()
 {
     if (s_singleInstance == nullptr)
     {
         s_singleInstance = new PoolManager();
-        // Add the first auto release pool
+        // Add the first auto release pool, it pushes itself
         s_singleInstance->_curReleasePool = new AutoreleasePool("cocos2d autorelease pool");
-        s_singleInstance->_releasePoolStack.push_back(s_singleInstance->_curReleasePool);
     }
     return s_singleInstance;
 }
@@ -124,6 +300,11 @@ void PoolManager::destroyInstance()
 }
 
 PoolManager::PoolManager()
+: _curReleasePool(nullptr)
+, _frameCountsIndex(0)
+, _currentFrameCount(0)
+, _recordedFrames(0)
+, _maxFrameCount(0)
 {
 }
 
@@ -131,23 +312,21 @@ PoolManager::~PoolManager()
 {
     CCLOGINFO("deallocing PoolManager: %p", this);
     
-    while (!_releasePoolStack.empty())
-    {
-        AutoreleasePool* pool = _releasePoolStack.back();
-        _releasePoolStack.pop_back();
-        
-        delete pool;
-    }
+    // Only the engine pool is owned by the manager, pools created on the stack pop themselves
+    delete _curReleasePool;
+    _curReleasePool = nullptr;
 }
 
 
 AutoreleasePool* PoolManager::getCurrentPool() const
 {
-    return _curReleasePool;
+    AutoreleasePool* pool = getThreadPool();
+    return pool ? pool : _curReleasePool;
 }
 
 bool PoolManager::isObjectInPools(Ref* obj) const
 {
+    std::lock_guard<std::mutex> lock(_poolStackMutex);
     for (const auto& pool : _releasePoolStack)
     {
         if (pool->contains(obj))
@@ -156,24 +335,129 @@ bool PoolManager::isObjectInPools(Ref* obj) const
     return false;
 }
 
+void PoolManager::addToCurrentPool(Ref* object, const void* site)
+{
+    AutoreleasePool* pool = getThreadPool();
+    if (pool == nullptr)
+    {
+        pool = getInstance()->getCurrentPool();
+    }
+    
+    pool->addObject(object);
+    
+    if (s_instrumentationEnabled)
+    {
+        getInstance()->recordAutorelease(object, site);
+    }
+}
+
 void PoolManager::push(AutoreleasePool *pool)
 {
+    std::lock_guard<std::mutex> lock(_poolStackMutex);
     _releasePoolStack.push_back(pool);
-    _curReleasePool = pool;
 }
 
-void PoolManager::pop()
+void PoolManager::pop(AutoreleasePool *pool)
 {
-    // Can not pop the pool that created by engine
-    CC_ASSERT(_releasePoolStack.size() >= 1);
+    std::lock_guard<std::mutex> lock(_poolStackMutex);
     
-    _releasePoolStack.pop_back();
+    // Pools of one thread are destroyed in reverse order, but other threads may have pushed since
+    auto iter = std::find(_releasePoolStack.rbegin(), _releasePoolStack.rend(), pool);
+    if (iter != _releasePoolStack.rend())
+    {
+        _releasePoolStack.erase(std::next(iter).base());
+    }
+}
+
+void PoolManager::setInstrumentationEnabled(bool enabled)
+{
+    s_instrumentationEnabled = enabled;
+}
+
+void PoolManager::resetInstrumentation()
+{
+    std::lock_guard<std::mutex> lock(_instrumentationMutex);
+    _autoreleaseSites.clear();
+    _frameCounts.clear();
+    _frameCountsIndex = 0;
+    _currentFrameCount = 0;
+    _recordedFrames = 0;
+    _maxFrameCount = 0;
+}
+
+void PoolManager::recordAutorelease(Ref* object, const void* site)
+{
+    const char* typeName = typeid(*object).name();
     
-    // Should update _curReleasePool if a temple pool is released
-    if (_releasePoolStack.size() > 1)
+    std::lock_guard<std::mutex> lock(_instrumentationMutex);
+    auto& info = _autoreleaseSites[site];
+    ++info.count;
+    info.typeName = typeName;
+    ++_currentFrameCount;
+}
+
+void PoolManager::recordFrame()
+{
+    std::lock_guard<std::mutex> lock(_instrumentationMutex);
+    if (_frameCounts.size() < INSTRUMENTED_FRAMES)
     {
-        _curReleasePool = _releasePoolStack.back();
+        _frameCounts.push_back(_currentFrameCount);
     }
+    else
+    {
+        _frameCounts[_frameCountsIndex] = _currentFrameCount;
+    }
+    _frameCountsIndex = (_frameCountsIndex + 1) % INSTRUMENTED_FRAMES;
+    
+    _maxFrameCount = std::max(_maxFrameCount, _currentFrameCount);
+    ++_recordedFrames;
+    _currentFrameCount = 0;
+}
+
+std::string PoolManager::getInstrumentationInfo(int topSites) const
+{
+    std::lock_guard<std::mutex> lock(_instrumentationMutex);
+    
+    std::string info;
+    char buffer[256];
+    
+    snprintf(buffer, sizeof(buffer), "Autorelease instrumentation is %s, %u frames recorded, max %u objects per frame\n",
+             s_instrumentationEnabled ? "on" : "off", _recordedFrames, _maxFrameCount);
+    info += buffer;
+    
+    if (!_frameCounts.empty())
+    {
+        unsigned int total = 0;
+        info += "Recent frames:";
+        // oldest first
+        for (size_t i = 0; i < _frameCounts.size(); ++i)
+        {
+            unsigned int count = _frameCounts[(_frameCountsIndex + i) % _frameCounts.size()];
+            total += count;
+            snprintf(buffer, sizeof(buffer), " %u", count);
+            info += buffer;
+        }
+        snprintf(buffer, sizeof(buffer), "\nAverage: %u objects per frame\n", total / static_cast<unsigned int>(_frameCounts.size()));
+        info += buffer;
+    }
+    
+    std::vector<std::pair<const void*, SiteInfo>> sites(_autoreleaseSites.begin(), _autoreleaseSites.end());
+    std::sort(sites.begin(), sites.end(), [](const std::pair<const void*, SiteInfo>& s1, const std::pair<const void*, SiteInfo>& s2) {
+        return s1.second.count > s2.second.count;
+    });
+    
+    if (topSites >= 0 && sites.size() > static_cast<size_t>(topSites))
+    {
+        sites.resize(topSites);
+    }
+    
+    for (const auto& site : sites)
+    {
+        snprintf(buffer, sizeof(buffer), "%10u  %p  %s\n", site.second.count, site.first, site.second.typeName);
+        info += buffer;
+    }
+    
+    return info;
 }
 
 NS_CC_END
@@ -28,6 +28,9 @@ THE SOFTWARE.
 #include <stack>
 #include <vector>
 #include <string>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
 #include "base/CCRef.h"
 
 NS_CC_BEGIN
@@ -101,15 +104,36 @@ public:
      */
     void dump();
     
+    /**
+     * 返回pool中的对象数量。
+     */
+    size_t getObjectCount() const { return _objectCount; }
+    
 private:
+    /** 保存固定数量对象指针的块 */
+    struct Block;
+    
+    Block* acquireBlock();
+    
+    /** 销毁的pool留下的空闲块，所有线程共享 */
+    static Block* s_freeBlocks;
+    static int s_freeBlockCount;
+    
     /**
-     * 内部数组管理pool中的对象。
+     * 管理pool中对象的块链表。
      *
-     * 尽管数组中包含了添加到pool的对象，
-     * 对象的Ref::release()方法是在数组外被调用以保证不影响对象的引用计数。
+     * 尽管块中包含了添加到pool的对象，
+     * 对象的Ref::release()方法是在块外被调用以保证不影响对象的引用计数。
      * 所以对象可以调用Ref::release()来销毁，即使对象已被添加到pool。
+     * clear()之后块会留给下一次使用，pool销毁时还给共享的空闲块列表。
      */
-    std::vector<Ref*> _managedObjectArray;
+    Block* _firstBlock;
+    Block* _currentBlock;
+    Block* _spareBlocks;
+    size_t _objectCount;
+    
+    /** 同一线程中在这个pool之前的当前pool */
+    AutoreleasePool* _previousPool;
     std::string _name;
     
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
@@ -140,10 +164,32 @@ public:
     /**
      * 获取当前pool，引擎至少会创建一个AutoreleasePool。
      * 你可以创建自己的AutoreleasePool，并添加到AutoreleasePool栈。
+     * 每个线程有自己的当前pool，没有创建过pool的线程使用引擎创建的pool。
      */
     AutoreleasePool *getCurrentPool() const;
 
     bool isObjectInPools(Ref* obj) const;
+    
+    /**
+     * 把对象加入当前线程的当前pool，Ref::autorelease()使用。
+     * site 是调用 autorelease() 的位置，只在开启统计时使用。
+     */
+    static void addToCurrentPool(Ref* object, const void* site);
+    
+    /**
+     * 开启或关闭自动释放统计: 记录每帧自动释放的对象数和调用autorelease()最多的位置。
+     * 开启后每次autorelease()都要加锁，只在调试时使用。
+     */
+    void setInstrumentationEnabled(bool enabled);
+    bool isInstrumentationEnabled() const { return s_instrumentationEnabled; }
+    
+    /** 清空统计数据 */
+    void resetInstrumentation();
+    
+    /**
+     * 返回统计信息: 最近的每帧自动释放数，以及次数最多的 topSites 个调用位置 (地址和对象类型)。
+     */
+    std::string getInstrumentationInfo(int topSites = 10) const;
 
     /**
      * @js NA
@@ -156,12 +202,35 @@ private:
     ~PoolManager();
     
     void push(AutoreleasePool *pool);
-    void pop();
+    void pop(AutoreleasePool *pool);
+    
+    void recordAutorelease(Ref* object, const void* site);
+    void recordFrame();
     
     static PoolManager* s_singleInstance;
+    static bool s_instrumentationEnabled;
     
+    /** 所有线程的pool，由 _poolStackMutex 保护 */
     std::deque<AutoreleasePool*> _releasePoolStack;
+    mutable std::mutex _poolStackMutex;
+    
+    /** 引擎创建的pool，每帧由 Director 清理 */
     AutoreleasePool *_curReleasePool;
+    
+    struct SiteInfo
+    {
+        unsigned int count;
+        const char* typeName;
+    };
+    
+    /** 统计数据，由 _instrumentationMutex 保护 */
+    mutable std::mutex _instrumentationMutex;
+    std::unordered_map<const void*, SiteInfo> _autoreleaseSites;
+    std::vector<unsigned int> _frameCounts;
+    size_t _frameCountsIndex;
+    unsigned int _currentFrameCount;
+    unsigned int _recordedFrames;
+    unsigned int _maxFrameCount;
 };
 
 // end of base_nodes group
@@ -47,6 +47,8 @@ Configuration::Configuration()
 , _supportsBGRA8888(false)
 , _supportsDiscardFramebuffer(false)
 , _supportsShareableVAO(false)
+, _supportsMapBufferRange(false)
+, _supportsFenceSync(false)
 , _maxSamplesAllowed(0)
 , _maxTextureUnits(0)
 , _glExtensions(nullptr)
@@ -142,6 +144,12 @@ void Configuration::gatherGPUInfo()
     _supportsShareableVAO = checkForGLExtension("vertex_array_object");
 	_valueDict["gl.supports_vertex_array_object"] = Value(_supportsShareableVAO);
 
+    _supportsMapBufferRange = checkForGLExtension("map_buffer_range");
+    _valueDict["gl.supports_map_buffer_range"] = Value(_supportsMapBufferRange);
+
+    _supportsFenceSync = checkForGLExtension("GL_ARB_sync") || checkForGLExtension("GL_APPLE_sync");
+    _valueDict["gl.supports_fence_sync"] = Value(_supportsFenceSync);
+
     CHECK_GL_ERROR_DEBUG();
 }
 
@@ -247,6 +255,16 @@ bool Configuration::supportsShareableVAO() const
 #endif
 }
 
+bool Configuration::supportsMapBufferRange() const
+{
+    return _supportsMapBufferRange;
+}
+
+bool Configuration::supportsFenceSync() const
+{
+    return _supportsFenceSync;
+}
+
 //
 // generic getters for properties
 //
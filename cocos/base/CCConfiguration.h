@@ -110,6 +110,12 @@ public:
      */
 	bool supportsShareableVAO() const;
 
+    /** 是否支持 glMapBufferRange (GL_ARB_map_buffer_range / GL_EXT_map_buffer_range). */
+    bool supportsMapBufferRange() const;
+
+    /** 是否支持同步对象(sync objects), 即 glFenceSync/glClientWaitSync (GL_ARB_sync / GL_APPLE_sync). */
+    bool supportsFenceSync() const;
+
     /** 检查是否支持 OpenGL */
     bool checkForGLExtension(const std::string &searchName) const;
 
@@ -149,6 +155,8 @@ protected:
     bool            _supportsBGRA8888;
     bool            _supportsDiscardFramebuffer;
     bool            _supportsShareableVAO;
+    bool            _supportsMapBufferRange;
+    bool            _supportsFenceSync;
     GLint           _maxSamplesAllowed;
     GLint           _maxTextureUnits;
     char *          _glExtensions;
@@ -56,6 +56,7 @@
 
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
+#include "base/CCAutoreleasePool.h"
 #include "base/CCPlatformConfig.h"
 #include "base/CCConfiguration.h"
 #include "2d/CCScene.h"
@@ -180,6 +181,18 @@ static void printFileUtils(int fd)
     for( const auto &item : cache) {
         mydprintf(fd, "%s -> %s\n", item.first.c_str(), item.second.c_str());
     }
+
+    mydprintf(fd, "\nSearch Path Index: %s\n", fu->isSearchPathIndexEnabled() ? "on" : "off");
+    for( const auto &item : fu->getSearchPathIndex()) {
+        mydprintf(fd, "%s: %d files\n", item.first.c_str(), (int)item.second.size());
+    }
+
+    const FileUtils::LookupStats& stats = fu->getLookupStats();
+    unsigned int lookups = stats.cacheHits + stats.missingCacheHits + stats.resolved + stats.unresolved;
+    float hitRate = lookups ? 100.0f * (stats.cacheHits + stats.missingCacheHits) / lookups : 0.0f;
+    mydprintf(fd, "\nLookups: %u (cache hits: %u, missing cache hits: %u, resolved: %u, unresolved: %u, hit rate: %.1f%%)\n",
+              lookups, stats.cacheHits, stats.missingCacheHits, stats.resolved, stats.unresolved, hitRate);
+    mydprintf(fd, "File system checks: %u, avoided: %u\n", stats.fileChecks, stats.fileChecksAvoided);
     sendPrompt(fd);
 }
 #endif
@@ -267,6 +280,24 @@ Console::Console()
 {
     // VS2012 doesn't support initializer list, so we create a new array and assign its elements to '_command'.
 	Command commands[] = {     
+        { "autorelease", "Turn on / off the autorelease instrumentation or print its report. Args: [on | off | reset | ]", [](int fd, const std::string& args) {
+            Scheduler *sched = Director::getInstance()->getScheduler();
+            if( args.compare("on")==0 || args.compare("off")==0) {
+                bool state = (args.compare("on") == 0);
+                sched->performFunctionInCocosThread( [=](){
+                    PoolManager::getInstance()->setInstrumentationEnabled(state);
+                });
+            } else if( args.compare("reset")==0) {
+                sched->performFunctionInCocosThread( [](){
+                    PoolManager::getInstance()->resetInstrumentation();
+                });
+            } else {
+                sched->performFunctionInCocosThread( [=](){
+                    mydprintf(fd, "%s", PoolManager::getInstance()->getInstrumentationInfo().c_str());
+                    sendPrompt(fd);
+                });
+            }
+        } },
         { "config", "Print the Configuration object", std::bind(&Console::commandConfig, this, std::placeholders::_1, std::placeholders::_2) },
         { "debugmsg", "Whether or not to forward the debug messages on the console. Args: [on | off]", [&](int fd, const std::string& args) {
             if( args.compare("on")==0 || args.compare("off")==0) {
@@ -276,7 +307,7 @@ Console::Console()
             }
         } },
         { "exit", "Close connection to the console", std::bind(&Console::commandExit, this, std::placeholders::_1, std::placeholders::_2) },
-        { "fileutils", "Flush or print the FileUtils info. Args: [flush | ] ", std::bind(&Console::commandFileUtils, this, std::placeholders::_1, std::placeholders::_2) },
+        { "fileutils", "Flush or print the FileUtils info, reset its lookup counters or turn on / off the search path index. Args: [flush | reset | index on | index off | ] ", std::bind(&Console::commandFileUtils, this, std::placeholders::_1, std::placeholders::_2) },
         { "fps", "Turn on / off the FPS. Args: [on | off] ", [](int fd, const std::string& args) {
             if( args.compare("on")==0 || args.compare("off")==0) {
                 bool state = (args.compare("on") == 0);
@@ -456,7 +487,16 @@ void Console::commandFileUtils(int fd, const std::string &args)
 
     if( args.compare("flush") == 0 )
     {
-        FileUtils::getInstance()->purgeCachedEntries();
+        sched->performFunctionInCocosThread( [](){ FileUtils::getInstance()->purgeCachedEntries(); } );
+    }
+    else if( args.compare("reset") == 0 )
+    {
+        sched->performFunctionInCocosThread( [](){ FileUtils::getInstance()->resetLookupStats(); } );
+    }
+    else if( args.compare("index on") == 0 || args.compare("index off") == 0 )
+    {
+        bool enabled = (args.compare("index on") == 0);
+        sched->performFunctionInCocosThread( [=](){ FileUtils::getInstance()->setSearchPathIndexEnabled(enabled); } );
     }
     else if( args.length()==0)
     {
@@ -464,7 +504,7 @@ void Console::commandFileUtils(int fd, const std::string &args)
     }
     else
     {
-        mydprintf(fd, "Unsupported argument: '%s'. Supported arguments: 'flush' or nothing", args.c_str());
+        mydprintf(fd, "Unsupported argument: '%s'. Supported arguments: 'flush', 'reset', 'index on', 'index off' or nothing", args.c_str());
     }
 }
 
@@ -65,14 +65,21 @@ Data::~Data()
 Data& Data::operator= (const Data& other)
 {
     CCLOGINFO("In the copy assignment of Data.");
-    copy(other._bytes, other._size);
+    if (this != &other)
+    {
+        copy(other._bytes, other._size);
+    }
     return *this;
 }
 
 Data& Data::operator= (Data&& other)
 {
     CCLOGINFO("In the move assignment of Data.");
-    move(other);
+    if (this != &other)
+    {
+        clear();
+        move(other);
+    }
     return *this;
 }
 
@@ -80,6 +87,7 @@ void Data::move(Data& other)
 {
     _bytes = other._bytes;
     _size = other._size;
+    _owner = std::move(other._owner);
     
     other._bytes = nullptr;
     other._size = 0;
@@ -114,13 +122,36 @@ void Data::copy(unsigned char* bytes, const ssize_t size)
 
 void Data::fastSet(unsigned char* bytes, const ssize_t size)
 {
+    _owner.reset();
+    _bytes = bytes;
+    _size = size;
+}
+
+void Data::setSharedBytes(unsigned char* bytes, const ssize_t size, const std::shared_ptr<void>& owner)
+{
+    clear();
+    
     _bytes = bytes;
     _size = size;
+    _owner = owner;
+}
+
+bool Data::isShared() const
+{
+    return _owner != nullptr;
 }
 
 void Data::clear()
 {
-    free(_bytes);
+    if (_owner)
+    {
+        // the buffer belongs to the owner, e.g. a file mapping
+        _owner.reset();
+    }
+    else
+    {
+        free(_bytes);
+    }
     _bytes = nullptr;
     _size = 0;
 }
@@ -30,6 +30,7 @@
 #include <stdint.h> // for ssize_t on android
 #include <string>   // for ssize_t on linux
 #include "CCStdC.h" // for ssize_t on window
+#include <memory>
 
 NS_CC_BEGIN
 
@@ -74,6 +75,15 @@ public:
      */
     void fastSet(unsigned char* bytes, const ssize_t size);
     
+    /** 引用由 `owner` 管理生命周期的缓冲区(例如只读内存映射的文件), 不复制内容.
+     *  @param owner 缓冲区的持有者, Data 在清空或析构时只释放对它的引用, 不会调用 'free'.
+     *  @note 拷贝这样的 Data 会得到一份独立的 'malloc' 缓冲区.
+     */
+    void setSharedBytes(unsigned char* bytes, const ssize_t size, const std::shared_ptr<void>& owner);
+    
+    /** 缓冲区是否由外部持有者管理(见 Data::setSharedBytes). */
+    bool isShared() const;
+    
     /** 清空 Data, 释放缓冲区内存, 重置 Data 缓冲区长度. */
     void clear();
     
@@ -86,6 +96,7 @@ private:
 private:
     unsigned char* _bytes;
     ssize_t _size;
+    std::shared_ptr<void> _owner;
 };
 
 NS_CC_END
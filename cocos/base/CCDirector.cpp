@@ -47,6 +47,7 @@ THE SOFTWARE.
 #include "renderer/CCGLProgramStateCache.h"
 #include "2d/CCTransition.h"
 #include "2d/CCTextureCache.h"
+#include "2d/CCParticleSystem.h"
 #include "2d/CCFontFreeType.h"
 #include "base/CCScheduler.h"
 #include "base/ccMacros.h"
@@ -57,6 +58,7 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/CCProfiling.h"
 #include "base/CCConfiguration.h"
+#include "base/CCThreadPool.h"
 #include "renderer/CCRenderer.h"
 #include "base/CCNS.h"
 #include "math/CCMath.h"
@@ -118,7 +120,7 @@ bool Director::init(void)
     // FPS
     _accumDt = 0.0f;
     _frameRate = 0.0f;
-    _FPSLabel = _drawnBatchesLabel = _drawnVerticesLabel = nullptr;
+    _FPSLabel = _drawnBatchesLabel = _drawnVerticesLabel = _transformsLabel = _textureUploadLabel = nullptr;
     _totalFrames = _frames = 0;
     _lastUpdate = new struct timeval;
 
@@ -170,6 +172,8 @@ Director::~Director(void)
     CC_SAFE_RELEASE(_FPSLabel);
     CC_SAFE_RELEASE(_drawnVerticesLabel);
     CC_SAFE_RELEASE(_drawnBatchesLabel);
+    CC_SAFE_RELEASE(_transformsLabel);
+    CC_SAFE_RELEASE(_textureUploadLabel);
 
     CC_SAFE_RELEASE(_runningScene);
     CC_SAFE_RELEASE(_notificationNode);
@@ -271,6 +275,8 @@ void Director::drawScene()
     if (! _paused)
     {
         _scheduler->update(_deltaTime);
+        // particle systems deferred by ParticleSystem::setParallelUpdateEnabled()
+        ParticleSystem::updatePendingSystems();
         _eventDispatcher->dispatchEvent(_eventAfterUpdate);
     }
 
@@ -285,6 +291,8 @@ void Director::drawScene()
 
     pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
 
+    Node::resetTransformStats();
+
     // draw the scene
     if (_runningScene)
     {
@@ -941,6 +949,8 @@ void Director::purgeDirector()
     CC_SAFE_RELEASE_NULL(_FPSLabel);
     CC_SAFE_RELEASE_NULL(_drawnBatchesLabel);
     CC_SAFE_RELEASE_NULL(_drawnVerticesLabel);
+    CC_SAFE_RELEASE_NULL(_transformsLabel);
+    CC_SAFE_RELEASE_NULL(_textureUploadLabel);
 
     // purge bitmap cache
     FontFNT::purgeCachedData();
@@ -963,6 +973,8 @@ void Director::purgeDirector()
     
     destroyTextureCache();
 
+    ThreadPool::destroyInstance();
+
     CHECK_GL_ERROR_DEBUG();
     
     // OpenGL view
@@ -1048,11 +1060,15 @@ void Director::showStats()
 {
     static unsigned long prevCalls = 0;
     static unsigned long prevVerts = 0;
+    static unsigned long prevMatrices = 0;
+    static unsigned long prevTranslations = 0;
+    static int prevTextureQueue = -1;
+    static float prevTextureUploadTime = -1;
 
     ++_frames;
     _accumDt += _deltaTime;
     
-    if (_displayStats && _FPSLabel && _drawnBatchesLabel && _drawnVerticesLabel)
+    if (_displayStats && _FPSLabel && _drawnBatchesLabel && _drawnVerticesLabel && _transformsLabel && _textureUploadLabel)
     {
         char buffer[30];
 
@@ -1080,8 +1096,31 @@ void Director::showStats()
             prevVerts = currentVerts;
         }
 
+        // matrices multiplied (4x4 or 2D affine) / matrices only re-translated by Node::visit
+        const auto& transformStats = Node::getTransformStats();
+        auto currentMatrices = (unsigned long)(transformStats.fullMultiplies + transformStats.affineMultiplies);
+        auto currentTranslations = (unsigned long)transformStats.translations;
+        if( currentMatrices != prevMatrices || currentTranslations != prevTranslations ) {
+            snprintf(buffer, sizeof(buffer), "Matrices:%6lu/%lu", currentMatrices, currentTranslations);
+            _transformsLabel->setString(buffer);
+            prevMatrices = currentMatrices;
+            prevTranslations = currentTranslations;
+        }
+
+        // async texture requests in flight / time spent uploading them this frame
+        int currentTextureQueue = _textureCache->getAsyncQueueDepth();
+        float currentTextureUploadTime = _textureCache->getAsyncUploadTime();
+        if( currentTextureQueue != prevTextureQueue || currentTextureUploadTime != prevTextureUploadTime ) {
+            snprintf(buffer, sizeof(buffer), "Tex async:%4d/%.2f", currentTextureQueue, currentTextureUploadTime * 1000);
+            _textureUploadLabel->setString(buffer);
+            prevTextureQueue = currentTextureQueue;
+            prevTextureUploadTime = currentTextureUploadTime;
+        }
+
         Mat4 identity = Mat4::IDENTITY;
 
+        _textureUploadLabel->visit(_renderer, identity, false);
+        _transformsLabel->visit(_renderer, identity, false);
         _drawnVerticesLabel->visit(_renderer, identity, false);
         _drawnBatchesLabel->visit(_renderer, identity, false);
         _FPSLabel->visit(_renderer, identity, false);
@@ -1113,6 +1152,8 @@ void Director::createStatsLabel()
         CC_SAFE_RELEASE_NULL(_FPSLabel);
         CC_SAFE_RELEASE_NULL(_drawnBatchesLabel);
         CC_SAFE_RELEASE_NULL(_drawnVerticesLabel);
+        CC_SAFE_RELEASE_NULL(_transformsLabel);
+        CC_SAFE_RELEASE_NULL(_textureUploadLabel);
         _textureCache->removeTextureForKey("/cc_fps_images");
         FileUtils::getInstance()->purgeCachedEntries();
     }
@@ -1161,10 +1202,23 @@ void Director::createStatsLabel()
     _drawnVerticesLabel->initWithString("00000", texture, 12, 32, '.');
     _drawnVerticesLabel->setScale(scaleFactor);
 
+    _transformsLabel = LabelAtlas::create();
+    _transformsLabel->retain();
+    _transformsLabel->setIgnoreContentScaleFactor(true);
+    _transformsLabel->initWithString("00000", texture, 12, 32, '.');
+    _transformsLabel->setScale(scaleFactor);
+
+    _textureUploadLabel = LabelAtlas::create();
+    _textureUploadLabel->retain();
+    _textureUploadLabel->setIgnoreContentScaleFactor(true);
+    _textureUploadLabel->initWithString("0", texture, 12, 32, '.');
+    _textureUploadLabel->setScale(scaleFactor);
 
     Texture2D::setDefaultAlphaPixelFormat(currentFormat);
 
     const int height_spacing = 22 / CC_CONTENT_SCALE_FACTOR();
+    _textureUploadLabel->setPosition(Vec2(0, height_spacing*4) + CC_DIRECTOR_STATS_POSITION);
+    _transformsLabel->setPosition(Vec2(0, height_spacing*3) + CC_DIRECTOR_STATS_POSITION);
     _drawnVerticesLabel->setPosition(Vec2(0, height_spacing*2) + CC_DIRECTOR_STATS_POSITION);
     _drawnBatchesLabel->setPosition(Vec2(0, height_spacing*1) + CC_DIRECTOR_STATS_POSITION);
     _FPSLabel->setPosition(Vec2(0, height_spacing*0)+CC_DIRECTOR_STATS_POSITION);
@@ -458,6 +458,8 @@ protected:
     LabelAtlas *_FPSLabel;
     LabelAtlas *_drawnBatchesLabel;
     LabelAtlas *_drawnVerticesLabel;
+    LabelAtlas *_transformsLabel;
+    LabelAtlas *_textureUploadLabel;
     
     /** Director 是否暂停了 */
     bool _paused;
@@ -31,8 +31,10 @@ NS_CC_BEGIN
 EventCustom::EventCustom(const std::string& eventName)
 : Event(Type::CUSTOM)
 , _userData(nullptr)
-, _eventName(eventName)
+, _eventName(nullptr)
 {
+    // one registry lookup gives both the key and the interned name
+    _listenerKey = EventListener::getListenerKey(eventName, &_eventName);
 }
 
 NS_CC_END
@@ -26,6 +26,7 @@
 #define __cocos2d_libs__CCCustomEvent__
 
 #include "base/CCEvent.h"
+#include "base/CCEventListener.h"
 
 NS_CC_BEGIN
 
@@ -42,10 +43,14 @@ public:
     inline void* getUserData() const { return _userData; };
     
     /** 获取事件名称 */
-    inline const std::string& getEventName() const { return _eventName; };
+    inline const std::string& getEventName() const { return *_eventName; };
+
+    /** 获取事件名称对应的整数, 即监听这个事件的 EventListenerCustom 的 ListenerKey */
+    inline EventListener::ListenerKey getListenerKey() const { return _listenerKey; };
 protected:
     void* _userData;       ///< 用户数据
-    std::string _eventName;
+    EventListener::ListenerKey _listenerKey;
+    const std::string* _eventName;    ///< 指向注册表中的名称, 构造事件时不复制字符串
 };
 
 NS_CC_END
@@ -66,28 +66,52 @@ private:
 
 NS_CC_BEGIN
 
-static EventListener::ListenerID __getListenerID(Event* event)
+// Keys of the listener IDs used by the engine, registered on first use
+struct BuiltinListenerKeys
 {
-    EventListener::ListenerID ret;
+    EventListener::ListenerKey touchOneByOne;
+    EventListener::ListenerKey touchAllAtOnce;
+    EventListener::ListenerKey mouse;
+    EventListener::ListenerKey keyboard;
+    EventListener::ListenerKey acceleration;
+    EventListener::ListenerKey focus;
+};
+
+static const BuiltinListenerKeys& __getBuiltinListenerKeys()
+{
+    static const BuiltinListenerKeys keys = {
+        EventListener::getListenerKey(EventListenerTouchOneByOne::LISTENER_ID),
+        EventListener::getListenerKey(EventListenerTouchAllAtOnce::LISTENER_ID),
+        EventListener::getListenerKey(EventListenerMouse::LISTENER_ID),
+        EventListener::getListenerKey(EventListenerKeyboard::LISTENER_ID),
+        EventListener::getListenerKey(EventListenerAcceleration::LISTENER_ID),
+        EventListener::getListenerKey(EventListenerFocus::LISTENER_ID)
+    };
+    return keys;
+}
+
+static EventListener::ListenerKey __getListenerKey(Event* event)
+{
+    EventListener::ListenerKey ret = 0;
     switch (event->getType())
     {
         case Event::Type::ACCELERATION:
-            ret = EventListenerAcceleration::LISTENER_ID;
+            ret = __getBuiltinListenerKeys().acceleration;
             break;
         case Event::Type::CUSTOM:
             {
                 auto customEvent = static_cast<EventCustom*>(event);
-                ret = customEvent->getEventName();
+                ret = customEvent->getListenerKey();
             }
             break;
         case Event::Type::KEYBOARD:
-            ret = EventListenerKeyboard::LISTENER_ID;
+            ret = __getBuiltinListenerKeys().keyboard;
             break;
         case Event::Type::MOUSE:
-            ret = EventListenerMouse::LISTENER_ID;
+            ret = __getBuiltinListenerKeys().mouse;
             break;
         case Event::Type::FOCUS:
-            ret = EventListenerFocus::LISTENER_ID;
+            ret = __getBuiltinListenerKeys().focus;
             break;
         case Event::Type::TOUCH:
             // Touch listener is very special, it contains two kinds of listeners, EventListenerTouchOneByOne and EventListenerTouchAllAtOnce.
@@ -102,6 +126,65 @@ static EventListener::ListenerID __getListenerID(Event* event)
     return ret;
 }
 
+static bool __isNodeInScene(Node* node, Node* rootNode)
+{
+    while (node->getParent())
+    {
+        node = node->getParent();
+    }
+    return node == rootNode;
+}
+
+// Same order as Node::sortAllChildren, falls back to the position in the children array on ties
+static bool __isSiblingVisitedBefore(Node* n1, Node* n2)
+{
+    if (n1->getLocalZOrder() != n2->getLocalZOrder())
+        return n1->getLocalZOrder() < n2->getLocalZOrder();
+    if (n1->getOrderOfArrival() != n2->getOrderOfArrival())
+        return n1->getOrderOfArrival() < n2->getOrderOfArrival();
+    
+    const auto& children = n1->getParent()->getChildren();
+    return children.getIndex(n1) < children.getIndex(n2);
+}
+
+// Whether n1 is visited before n2 in a scene graph traversal: children with a negative local
+// Z order come before their parent, the others after it. Both nodes must share the same root.
+static bool __isNodeVisitedBefore(Node* n1, Node* n2)
+{
+    if (n1 == n2)
+        return false;
+    
+    int depth1 = 0;
+    for (Node* n = n1->getParent(); n; n = n->getParent())
+        ++depth1;
+    
+    int depth2 = 0;
+    for (Node* n = n2->getParent(); n; n = n->getParent())
+        ++depth2;
+    
+    for (; depth1 > depth2; --depth1)
+    {
+        if (n1->getParent() == n2)
+            return n1->getLocalZOrder() < 0;
+        n1 = n1->getParent();
+    }
+    
+    for (; depth2 > depth1; --depth2)
+    {
+        if (n2->getParent() == n1)
+            return n2->getLocalZOrder() >= 0;
+        n2 = n2->getParent();
+    }
+    
+    while (n1->getParent() != n2->getParent())
+    {
+        n1 = n1->getParent();
+        n2 = n2->getParent();
+    }
+    
+    return __isSiblingVisitedBefore(n1, n2);
+}
+
 EventDispatcher::EventListenerVector::EventListenerVector() :
  _fixedListeners(nullptr),
  _sceneGraphListeners(nullptr),
@@ -194,16 +277,17 @@ void EventDispatcher::EventListenerVector::clear()
 
 
 EventDispatcher::EventDispatcher()
-: _inDispatch(0)
+: _sceneGraphRoot(nullptr)
+, _inDispatch(0)
 , _isEnabled(false)
-, _nodePriorityIndex(0)
+, _hasEmptyListeners(false)
 {
     _toAddedListeners.reserve(50);
     
     // fixed #4129: Mark the following listener IDs for internal use.
     // Therefore, internal listeners would not be cleaned when removeAllEventListeners is invoked.
-    _internalCustomListenerIDs.insert(EVENT_COME_TO_FOREGROUND);
-    _internalCustomListenerIDs.insert(EVENT_COME_TO_BACKGROUND);
+    _internalCustomListenerIDs.insert(EventListener::getListenerKey(EVENT_COME_TO_FOREGROUND));
+    _internalCustomListenerIDs.insert(EventListener::getListenerKey(EVENT_COME_TO_BACKGROUND));
 }
 
 EventDispatcher::~EventDispatcher()
@@ -214,70 +298,56 @@ EventDispatcher::~EventDispatcher()
     removeAllEventListeners();
 }
 
-void EventDispatcher::visitTarget(Node* node, bool isRootNode)
-{    
-    int i = 0;
-    auto& children = node->getChildren();
-    
-    auto childrenCount = children.size();
-    
-    if(childrenCount > 0)
+void EventDispatcher::updateSceneGraphOrder(Node* rootNode)
+{
+    if (rootNode != _sceneGraphRoot)
     {
-        Node* child = nullptr;
-        // visit children zOrder < 0
-        for( ; i < childrenCount; i++ )
-        {
-            child = children.at(i);
-            
-            if ( child && child->getLocalZOrder() < 0 )
-                visitTarget(child, false);
-            else
-                break;
-        }
+        // The running scene was replaced, rank every node which has listeners
+        _sceneGraphRoot = rootNode;
+        _sceneGraphNodes.clear();
+        _nodePriorityMap.clear();
         
-        if (_nodeListenersMap.find(node) != _nodeListenersMap.end())
+        for (const auto& e : _nodeListenersMap)
         {
-            _globalZOrderNodeMap[node->getGlobalZOrder()].push_back(node);
+            _nodesToReorder.insert(e.first);
         }
-        
-        for( ; i < childrenCount; i++ )
+    }
+    
+    if (_nodesToReorder.empty())
+        return;
+    
+    // Take out the nodes to be re-ranked, those which have left the scene and the slots
+    // cleared by removeNodeFromSceneGraphOrder, the others keep their relative order
+    auto removed = std::remove_if(_sceneGraphNodes.begin(), _sceneGraphNodes.end(), [&](Node* node){
+        if (node == nullptr)
+            return true;
+        if (_nodesToReorder.find(node) != _nodesToReorder.end() || !__isNodeInScene(node, rootNode))
         {
-            child = children.at(i);
-            if (child)
-                visitTarget(child, false);
+            _nodePriorityMap.erase(node);
+            return true;
         }
-    }
-    else
+        return false;
+    });
+    _sceneGraphNodes.erase(removed, _sceneGraphNodes.end());
+    
+    auto sortedCount = _sceneGraphNodes.size();
+    for (auto& node : _nodesToReorder)
     {
-        if (_nodeListenersMap.find(node) != _nodeListenersMap.end())
+        if (_nodeListenersMap.find(node) != _nodeListenersMap.end() && __isNodeInScene(node, rootNode))
         {
-            _globalZOrderNodeMap[node->getGlobalZOrder()].push_back(node);
+            _sceneGraphNodes.push_back(node);
         }
     }
+    _nodesToReorder.clear();
     
-    if (isRootNode)
+    auto middle = _sceneGraphNodes.begin() + sortedCount;
+    std::sort(middle, _sceneGraphNodes.end(), __isNodeVisitedBefore);
+    std::inplace_merge(_sceneGraphNodes.begin(), middle, _sceneGraphNodes.end(), __isNodeVisitedBefore);
+    
+    int index = 0;
+    for (auto& node : _sceneGraphNodes)
     {
-        std::vector<float> globalZOrders;
-        globalZOrders.reserve(_globalZOrderNodeMap.size());
-        
-        for (const auto& e : _globalZOrderNodeMap)
-        {
-            globalZOrders.push_back(e.first);
-        }
-        
-        std::sort(globalZOrders.begin(), globalZOrders.end(), [](const float a, const float b){
-            return a < b;
-        });
-        
-        for (const auto& globalZ : globalZOrders)
-        {
-            for (const auto& n : _globalZOrderNodeMap[globalZ])
-            {
-                _nodePriorityMap[n] = ++_nodePriorityIndex;
-            }
-        }
-        
-        _globalZOrderNodeMap.clear();
+        _nodePriorityMap[node] = ++index;
     }
 }
 
@@ -330,7 +400,7 @@ void EventDispatcher::removeEventListenersForTarget(Node* target, bool recursive
 {
     // Ensure the node is removed from these immediately also.
     // Don't want any dangling pointers or the possibility of dealing with deleted objects..
-    _nodePriorityMap.erase(target);
+    removeNodeFromSceneGraphOrder(target);
     _dirtyNodes.erase(target);
 
     auto listenerIter = _nodeListenersMap.find(target);
@@ -410,10 +480,28 @@ void EventDispatcher::dissociateNodeAndEventListener(Node* node, EventListener*
         {
             _nodeListenersMap.erase(found);
             delete listeners;
+            removeNodeFromSceneGraphOrder(node);
         }
     }
 }
 
+void EventDispatcher::removeNodeFromSceneGraphOrder(Node* node)
+{
+    _nodesToReorder.erase(node);
+    
+    // A node's rank is its position in _sceneGraphNodes plus one. Only clear the slot so the
+    // other ranks stay valid, updateSceneGraphOrder compacts the list. Removing a whole
+    // subtree stays linear this way.
+    auto iter = _nodePriorityMap.find(node);
+    if (iter != _nodePriorityMap.end())
+    {
+        size_t index = iter->second - 1;
+        CCASSERT(index < _sceneGraphNodes.size() && _sceneGraphNodes[index] == node, "Scene graph order is out of sync");
+        _sceneGraphNodes[index] = nullptr;
+        _nodePriorityMap.erase(iter);
+    }
+}
+
 void EventDispatcher::addEventListener(EventListener* listener)
 {
     if (_inDispatch == 0)
@@ -431,13 +519,13 @@ void EventDispatcher::addEventListener(EventListener* listener)
 void EventDispatcher::forceAddEventListener(EventListener* listener)
 {
     EventListenerVector* listeners = nullptr;
-    EventListener::ListenerID listenerID = listener->getListenerID();
-    auto itr = _listenerMap.find(listenerID);
+    EventListener::ListenerKey listenerKey = listener->getListenerKey();
+    auto itr = _listenerMap.find(listenerKey);
     if (itr == _listenerMap.end())
     {
         
         listeners = new EventListenerVector();
-        _listenerMap.insert(std::make_pair(listenerID, listeners));
+        _listenerMap.insert(std::make_pair(listenerKey, listeners));
     }
     else
     {
@@ -448,7 +536,7 @@ void EventDispatcher::forceAddEventListener(EventListener* listener)
     
     if (listener->getFixedPriority() == 0)
     {
-        setDirty(listenerID, DirtyFlag::SCENE_GRAPH_PRIORITY);
+        setDirty(listenerKey, DirtyFlag::SCENE_GRAPH_PRIORITY);
         
         auto node = listener->getAssociatedNode();
         CCASSERT(node != nullptr, "Invalid scene graph priority!");
@@ -462,7 +550,7 @@ void EventDispatcher::forceAddEventListener(EventListener* listener)
     }
     else
     {
-        setDirty(listenerID, DirtyFlag::FIXED_PRIORITY);
+        setDirty(listenerKey, DirtyFlag::FIXED_PRIORITY);
     }
 }
 
@@ -539,6 +627,19 @@ void EventDispatcher::debugCheckNodeHasNoEventListenersOnDestruction(Node* node)
         CCASSERT(dirtyNode != node,
                  "Node should have no event listeners registered for it upon destruction!");
     }
+    
+    // Check the scene graph order
+    for (Node * orderedNode : _sceneGraphNodes)
+    {
+        CCASSERT(orderedNode != node,
+                 "Node should have no event listeners registered for it upon destruction!");
+    }
+    
+    for (Node * reorderNode : _nodesToReorder)
+    {
+        CCASSERT(reorderNode != node,
+                 "Node should have no event listeners registered for it upon destruction!");
+    }
 }
 
 #endif  // #if CC_NODE_DEBUG_VERIFY_EVENT_LISTENERS && COCOS2D_DEBUG > 0
@@ -604,7 +705,9 @@ void EventDispatcher::removeEventListener(EventListener* listener)
         }
     };
     
-    for (auto iter = _listenerMap.begin(); iter != _listenerMap.end();)
+    // a listener can only be in the listeners of its own ID
+    auto iter = _listenerMap.find(listener->getListenerKey());
+    if (iter != _listenerMap.end())
     {
         auto listeners = iter->second;
         auto fixedPriorityListeners = listeners->getFixedPriorityListeners();
@@ -614,14 +717,14 @@ void EventDispatcher::removeEventListener(EventListener* listener)
         if (isFound)
         {
             // fixed #4160: Dirty flag need to be updated after listeners were removed.
-            setDirty(listener->getListenerID(), DirtyFlag::SCENE_GRAPH_PRIORITY);
+            setDirty(listener->getListenerKey(), DirtyFlag::SCENE_GRAPH_PRIORITY);
         }
         else
         {
             removeListenerInVector(fixedPriorityListeners);
             if (isFound)
             {
-                setDirty(listener->getListenerID(), DirtyFlag::FIXED_PRIORITY);
+                setDirty(listener->getListenerKey(), DirtyFlag::FIXED_PRIORITY);
             }
         }
         
@@ -639,18 +742,11 @@ void EventDispatcher::removeEventListener(EventListener* listener)
 
         if (iter->second->empty())
         {
-            _priorityDirtyFlagMap.erase(listener->getListenerID());
+            _priorityDirtyFlagMap.erase(listener->getListenerKey());
             auto list = iter->second;
-            iter = _listenerMap.erase(iter);
+            _listenerMap.erase(iter);
             CC_SAFE_DELETE(list);
         }
-        else
-        {
-            ++iter;
-        }
-        
-        if (isFound)
-            break;
     }
 
     if (isFound)
@@ -690,7 +786,7 @@ void EventDispatcher::setPriority(EventListener* listener, int fixedPriority)
                 if (listener->getFixedPriority() != fixedPriority)
                 {
                     listener->setFixedPriority(fixedPriority);
-                    setDirty(listener->getListenerID(), DirtyFlag::FIXED_PRIORITY);
+                    setDirty(listener->getListenerKey(), DirtyFlag::FIXED_PRIORITY);
                 }
                 return;
             }
@@ -776,11 +872,11 @@ void EventDispatcher::dispatchEvent(Event* event)
         return;
     }
     
-    auto listenerID = __getListenerID(event);
+    auto listenerKey = __getListenerKey(event);
     
-    sortEventListeners(listenerID);
+    sortEventListeners(listenerKey);
     
-    auto iter = _listenerMap.find(listenerID);
+    auto iter = _listenerMap.find(listenerKey);
     if (iter != _listenerMap.end())
     {
         auto listeners = iter->second;
@@ -807,11 +903,11 @@ void EventDispatcher::dispatchCustomEvent(const std::string &eventName, void *op
 
 void EventDispatcher::dispatchTouchEvent(EventTouch* event)
 {
-    sortEventListeners(EventListenerTouchOneByOne::LISTENER_ID);
-    sortEventListeners(EventListenerTouchAllAtOnce::LISTENER_ID);
+    sortEventListeners(__getBuiltinListenerKeys().touchOneByOne);
+    sortEventListeners(__getBuiltinListenerKeys().touchAllAtOnce);
     
-    auto oneByOneListeners = getListeners(EventListenerTouchOneByOne::LISTENER_ID);
-    auto allAtOnceListeners = getListeners(EventListenerTouchAllAtOnce::LISTENER_ID);
+    auto oneByOneListeners = getListeners(__getBuiltinListenerKeys().touchOneByOne);
+    auto allAtOnceListeners = getListeners(__getBuiltinListenerKeys().touchAllAtOnce);
     
     // If there aren't any touch listeners, return directly.
     if (nullptr == oneByOneListeners && nullptr == allAtOnceListeners)
@@ -851,7 +947,10 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
                 
                 if (eventCode == EventTouch::EventCode::BEGAN)
                 {
-                    if (listener->onTouchBegan)
+                    // Listeners with hit test enabled only claim touches inside their node, skip the others
+                    // without calling into them, a swallowing listener still ends the loop below.
+                    if (listener->onTouchBegan
+                        && (!listener->_hitTestEnabled || listener->isInHitTestBounds((*touchesIter)->getLocation())))
                     {
                         isClaimed = listener->onTouchBegan(*touchesIter, event);
                         if (isClaimed && listener->_isRegistered)
@@ -1002,9 +1101,9 @@ void EventDispatcher::updateListeners(Event* event)
 {
     CCASSERT(_inDispatch > 0, "If program goes here, there should be event in dispatch.");
     
-    auto onUpdateListeners = [this](const EventListener::ListenerID& listenerID)
+    auto onUpdateListeners = [this](EventListener::ListenerKey listenerKey)
     {
-        auto listenersIter = _listenerMap.find(listenerID);
+        auto listenersIter = _listenerMap.find(listenerKey);
         if (listenersIter == _listenerMap.end())
             return;
 
@@ -1056,17 +1155,22 @@ void EventDispatcher::updateListeners(Event* event)
         {
             listeners->clearFixedListeners();
         }
+
+        if (listeners->empty())
+        {
+            _hasEmptyListeners = true;
+        }
     };
 
     
     if (event->getType() == Event::Type::TOUCH)
     {
-        onUpdateListeners(EventListenerTouchOneByOne::LISTENER_ID);
-        onUpdateListeners(EventListenerTouchAllAtOnce::LISTENER_ID);
+        onUpdateListeners(__getBuiltinListenerKeys().touchOneByOne);
+        onUpdateListeners(__getBuiltinListenerKeys().touchAllAtOnce);
     }
     else
     {
-        onUpdateListeners(__getListenerID(event));
+        onUpdateListeners(__getListenerKey(event));
     }
     
     if (_inDispatch > 1)
@@ -1074,18 +1178,23 @@ void EventDispatcher::updateListeners(Event* event)
     
     CCASSERT(_inDispatch == 1, "_inDispatch should be 1 here.");
     
-    for (auto iter = _listenerMap.begin(); iter != _listenerMap.end();)
+    // Listener vectors only become empty above, so the map is swept only when that happened.
+    if (_hasEmptyListeners)
     {
-        if (iter->second->empty())
-        {
-            _priorityDirtyFlagMap.erase(iter->first);
-            delete iter->second;
-            iter = _listenerMap.erase(iter);
-        }
-        else
+        for (auto iter = _listenerMap.begin(); iter != _listenerMap.end();)
         {
-            ++iter;
+            if (iter->second->empty())
+            {
+                _priorityDirtyFlagMap.erase(iter->first);
+                delete iter->second;
+                iter = _listenerMap.erase(iter);
+            }
+            else
+            {
+                ++iter;
+            }
         }
+        _hasEmptyListeners = false;
     }
     
     if (!_toAddedListeners.empty())
@@ -1109,8 +1218,9 @@ void EventDispatcher::updateDirtyFlagForSceneGraph()
             {
                 for (auto& l : *iter->second)
                 {
-                    setDirty(l->getListenerID(), DirtyFlag::SCENE_GRAPH_PRIORITY);
+                    setDirty(l->getListenerKey(), DirtyFlag::SCENE_GRAPH_PRIORITY);
                 }
+                _nodesToReorder.insert(node);
             }
         }
         
@@ -1118,11 +1228,11 @@ void EventDispatcher::updateDirtyFlagForSceneGraph()
     }
 }
 
-void EventDispatcher::sortEventListeners(const EventListener::ListenerID& listenerID)
+void EventDispatcher::sortEventListeners(EventListener::ListenerKey listenerKey)
 {
     DirtyFlag dirtyFlag = DirtyFlag::NONE;
     
-    auto dirtyIter = _priorityDirtyFlagMap.find(listenerID);
+    auto dirtyIter = _priorityDirtyFlagMap.find(listenerKey);
     if (dirtyIter != _priorityDirtyFlagMap.end())
     {
         dirtyFlag = dirtyIter->second;
@@ -1135,7 +1245,7 @@ void EventDispatcher::sortEventListeners(const EventListener::ListenerID& listen
 
         if ((int)dirtyFlag & (int)DirtyFlag::FIXED_PRIORITY)
         {
-            sortEventListenersOfFixedPriority(listenerID);
+            sortEventListenersOfFixedPriority(listenerKey);
         }
         
         if ((int)dirtyFlag & (int)DirtyFlag::SCENE_GRAPH_PRIORITY)
@@ -1143,7 +1253,7 @@ void EventDispatcher::sortEventListeners(const EventListener::ListenerID& listen
             auto rootNode = Director::getInstance()->getRunningScene();
             if (rootNode)
             {
-                sortEventListenersOfSceneGraphPriority(listenerID, rootNode);
+                sortEventListenersOfSceneGraphPriority(listenerKey, rootNode);
             }
             else
             {
@@ -1153,9 +1263,9 @@ void EventDispatcher::sortEventListeners(const EventListener::ListenerID& listen
     }
 }
 
-void EventDispatcher::sortEventListenersOfSceneGraphPriority(const EventListener::ListenerID& listenerID, Node* rootNode)
+void EventDispatcher::sortEventListenersOfSceneGraphPriority(EventListener::ListenerKey listenerKey, Node* rootNode)
 {
-    auto listeners = getListeners(listenerID);
+    auto listeners = getListeners(listenerKey);
     
     if (listeners == nullptr)
         return;
@@ -1164,29 +1274,55 @@ void EventDispatcher::sortEventListenersOfSceneGraphPriority(const EventListener
     if (sceneGraphListeners == nullptr)
         return;
 
-    // Reset priority index
-    _nodePriorityIndex = 0;
-    _nodePriorityMap.clear();
-
-    visitTarget(rootNode, true);
+    updateSceneGraphOrder(rootNode);
+    
+    // Look up the rank of every listener once instead of inside the comparator,
+    // nodes which are not in the scene have no rank and go last.
+    struct SortItem
+    {
+        EventListener* listener;
+        float globalZOrder;
+        int priority;
+    };
+    
+    std::vector<SortItem> items;
+    items.reserve(sceneGraphListeners->size());
+    for (auto& l : *sceneGraphListeners)
+    {
+        auto node = l->getAssociatedNode();
+        auto iter = _nodePriorityMap.find(node);
+        if (iter != _nodePriorityMap.end())
+            items.push_back({l, node->getGlobalZOrder(), iter->second});
+        else
+            items.push_back({l, 0, 0});
+    }
     
     // After sort: priority < 0, > 0
-    std::sort(sceneGraphListeners->begin(), sceneGraphListeners->end(), [this](const EventListener* l1, const EventListener* l2) {
-        return _nodePriorityMap[l1->getAssociatedNode()] > _nodePriorityMap[l2->getAssociatedNode()];
+    std::stable_sort(items.begin(), items.end(), [](const SortItem& i1, const SortItem& i2) {
+        if ((i1.priority == 0) != (i2.priority == 0))
+            return i2.priority == 0;
+        if (i1.globalZOrder != i2.globalZOrder)
+            return i1.globalZOrder > i2.globalZOrder;
+        return i1.priority > i2.priority;
     });
     
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        (*sceneGraphListeners)[i] = items[i].listener;
+    }
+    
 #if DUMP_LISTENER_ITEM_PRIORITY_INFO
     log("-----------------------------------");
     for (auto& l : *sceneGraphListeners)
     {
-        log("listener priority: node ([%s]%p), priority (%d)", typeid(*l->_node).name(), l->_node, _nodePriorityMap[l->_node]);
+        log("listener priority: node ([%s]%p), priority (%d)", typeid(*l->getAssociatedNode()).name(), l->getAssociatedNode(), _nodePriorityMap[l->getAssociatedNode()]);
     }
 #endif
 }
 
-void EventDispatcher::sortEventListenersOfFixedPriority(const EventListener::ListenerID& listenerID)
+void EventDispatcher::sortEventListenersOfFixedPriority(EventListener::ListenerKey listenerKey)
 {
-    auto listeners = getListeners(listenerID);
+    auto listeners = getListeners(listenerKey);
 
     if (listeners == nullptr)
         return;
@@ -1221,9 +1357,9 @@ void EventDispatcher::sortEventListenersOfFixedPriority(const EventListener::Lis
     
 }
 
-EventDispatcher::EventListenerVector* EventDispatcher::getListeners(const EventListener::ListenerID& listenerID)
+EventDispatcher::EventListenerVector* EventDispatcher::getListeners(EventListener::ListenerKey listenerKey)
 {
-    auto iter = _listenerMap.find(listenerID);
+    auto iter = _listenerMap.find(listenerKey);
     if (iter != _listenerMap.end())
     {
         return iter->second;
@@ -1232,9 +1368,9 @@ EventDispatcher::EventListenerVector* EventDispatcher::getListeners(const EventL
     return nullptr;
 }
 
-void EventDispatcher::removeEventListenersForListenerID(const EventListener::ListenerID& listenerID)
+void EventDispatcher::removeEventListenersForListenerID(EventListener::ListenerKey listenerKey)
 {
-    auto listenerItemIter = _listenerMap.find(listenerID);
+    auto listenerItemIter = _listenerMap.find(listenerKey);
     if (listenerItemIter != _listenerMap.end())
     {
         auto listeners = listenerItemIter->second;
@@ -1270,9 +1406,9 @@ void EventDispatcher::removeEventListenersForListenerID(const EventListener::Lis
         removeAllListenersInVector(sceneGraphPriorityListeners);
         removeAllListenersInVector(fixedPriorityListeners);
         
-        // Remove the dirty flag according the 'listenerID'.
+        // Remove the dirty flag according the 'listenerKey'.
         // No need to check whether the dispatcher is dispatching event.
-        _priorityDirtyFlagMap.erase(listenerID);
+        _priorityDirtyFlagMap.erase(listenerKey);
         
         if (!_inDispatch)
         {
@@ -1284,7 +1420,7 @@ void EventDispatcher::removeEventListenersForListenerID(const EventListener::Lis
     
     for (auto iter = _toAddedListeners.begin(); iter != _toAddedListeners.end();)
     {
-        if ((*iter)->getListenerID() == listenerID)
+        if ((*iter)->getListenerKey() == listenerKey)
         {
             (*iter)->setRegistered(false);
             (*iter)->release();
@@ -1301,23 +1437,23 @@ void EventDispatcher::removeEventListenersForType(EventListener::Type listenerTy
 {
     if (listenerType == EventListener::Type::TOUCH_ONE_BY_ONE)
     {
-        removeEventListenersForListenerID(EventListenerTouchOneByOne::LISTENER_ID);
+        removeEventListenersForListenerID(__getBuiltinListenerKeys().touchOneByOne);
     }
     else if (listenerType == EventListener::Type::TOUCH_ALL_AT_ONCE)
     {
-        removeEventListenersForListenerID(EventListenerTouchAllAtOnce::LISTENER_ID);
+        removeEventListenersForListenerID(__getBuiltinListenerKeys().touchAllAtOnce);
     }
     else if (listenerType == EventListener::Type::MOUSE)
     {
-        removeEventListenersForListenerID(EventListenerMouse::LISTENER_ID);
+        removeEventListenersForListenerID(__getBuiltinListenerKeys().mouse);
     }
     else if (listenerType == EventListener::Type::ACCELERATION)
     {
-        removeEventListenersForListenerID(EventListenerAcceleration::LISTENER_ID);
+        removeEventListenersForListenerID(__getBuiltinListenerKeys().acceleration);
     }
     else if (listenerType == EventListener::Type::KEYBOARD)
     {
-        removeEventListenersForListenerID(EventListenerKeyboard::LISTENER_ID);
+        removeEventListenersForListenerID(__getBuiltinListenerKeys().keyboard);
     }
     else
     {
@@ -1327,13 +1463,14 @@ void EventDispatcher::removeEventListenersForType(EventListener::Type listenerTy
 
 void EventDispatcher::removeCustomEventListeners(const std::string& customEventName)
 {
-    removeEventListenersForListenerID(customEventName);
+    removeEventListenersForListenerID(EventListener::getListenerKey(customEventName));
 }
 
 void EventDispatcher::removeAllEventListeners()
 {
     bool cleanMap = true;
-    std::vector<EventListener::ListenerID> types(_listenerMap.size());
+    std::vector<EventListener::ListenerKey> types;
+    types.reserve(_listenerMap.size());
     
     for (const auto& e : _listenerMap)
     {
@@ -1384,12 +1521,12 @@ void EventDispatcher::setDirtyForNode(Node* node)
     }
 }
 
-void EventDispatcher::setDirty(const EventListener::ListenerID& listenerID, DirtyFlag flag)
+void EventDispatcher::setDirty(EventListener::ListenerKey listenerKey, DirtyFlag flag)
 {    
-    auto iter = _priorityDirtyFlagMap.find(listenerID);
+    auto iter = _priorityDirtyFlagMap.find(listenerKey);
     if (iter == _priorityDirtyFlagMap.end())
     {
-        _priorityDirtyFlagMap.insert(std::make_pair(listenerID, flag));
+        _priorityDirtyFlagMap.insert(std::make_pair(listenerKey, flag));
     }
     else
     {
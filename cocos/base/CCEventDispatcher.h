@@ -191,22 +191,22 @@ protected:
     void forceAddEventListener(EventListener* listener);
     
     /** 获取指定侦听器类型的事件监听器列表 . */
-    EventListenerVector* getListeners(const EventListener::ListenerID& listenerID);
+    EventListenerVector* getListeners(EventListener::ListenerKey listenerKey);
     
     /** 更新'脏标记'(dirty flag) */
     void updateDirtyFlagForSceneGraph();
     
     /** 移除所有使用相同事件侦听器ID的侦听器*/
-    void removeEventListenersForListenerID(const EventListener::ListenerID& listenerID);
+    void removeEventListenersForListenerID(EventListener::ListenerKey listenerKey);
     
     /** 事件侦听器排序 */
-    void sortEventListeners(const EventListener::ListenerID& listenerID);
+    void sortEventListeners(EventListener::ListenerKey listenerKey);
     
     /** 通过场景图的优先级排序指定类型的侦听器 */
-    void sortEventListenersOfSceneGraphPriority(const EventListener::ListenerID& listenerID, Node* rootNode);
+    void sortEventListenersOfSceneGraphPriority(EventListener::ListenerKey listenerKey, Node* rootNode);
     
     /** 通过固定优先级排序指定类型的侦听器 */
-    void sortEventListenersOfFixedPriority(const EventListener::ListenerID& listenerID);
+    void sortEventListenersOfFixedPriority(EventListener::ListenerKey listenerKey);
     
     /** 更新所有侦听器
      *  1) 在事件分发过程中移除所有已经标记为'移除'的侦听器项.
@@ -236,25 +236,34 @@ protected:
     };
     
     /** 为一个指定的侦听器ID设置一个'脏标志'(dirty flag) */
-    void setDirty(const EventListener::ListenerID& listenerID, DirtyFlag flag);
+    void setDirty(EventListener::ListenerKey listenerKey, DirtyFlag flag);
     
-    /** 遍历场景图获取每一个节点的绘制顺序，该函数在以场景图优先级排序的事件侦听器之前被调用 */
-    void visitTarget(Node* node, bool isRootNode);
+    /** 只对被标记的节点重新计算遍历顺序并合并到已排好序的节点中，该函数在以场景图优先级排序的事件侦听器之前被调用 */
+    void updateSceneGraphOrder(Node* rootNode);
+    
+    /** 从场景图顺序中移除节点 */
+    void removeNodeFromSceneGraphOrder(Node* node);
     
     /** 侦听器映射图 */
-    std::unordered_map<EventListener::ListenerID, EventListenerVector*> _listenerMap;
+    std::unordered_map<EventListener::ListenerKey, EventListenerVector*> _listenerMap;
     
     /** '脏标志'(dirty flag)映射图 */
-    std::unordered_map<EventListener::ListenerID, DirtyFlag> _priorityDirtyFlagMap;
+    std::unordered_map<EventListener::ListenerKey, DirtyFlag> _priorityDirtyFlagMap;
     
     /** 节点和事件侦听器的映射图 */
     std::unordered_map<Node*, std::vector<EventListener*>*> _nodeListenersMap;
     
-    /** 节点映射和它的事件优先级 */
+    /** 节点映射和它的遍历顺序 */
     std::unordered_map<Node*, int> _nodePriorityMap;
     
-    /** key: 全局Z轴次序, value: 排好序的节点 */
-    std::unordered_map<float, std::vector<Node*>> _globalZOrderNodeMap;
+    /** 按遍历顺序排好序的带有场景图优先级侦听器的节点, 已移除的节点留下 nullptr, 下次排序时再压缩 */
+    std::vector<Node*> _sceneGraphNodes;
+    
+    /** _sceneGraphNodes 所属的场景 */
+    Node* _sceneGraphRoot;
+    
+    /** 需要重新计算遍历顺序的节点 */
+    std::set<Node*> _nodesToReorder;
     
     /** 在事件分发后需要被添加的侦听器 */
     std::vector<EventListener*> _toAddedListeners;
@@ -268,9 +277,10 @@ protected:
     /** 是否要使分发事件可用 */
     bool _isEnabled;
     
-    int _nodePriorityIndex;
+    /** 事件分发过程中是否有侦听器列表变为空, 为真时在分发结束后清理 */
+    bool _hasEmptyListeners;
     
-    std::set<std::string> _internalCustomListenerIDs;
+    std::set<EventListener::ListenerKey> _internalCustomListenerIDs;
 };
 
 
@@ -24,9 +24,63 @@
 
 #include "base/CCEventListener.h"
 #include "2d/platform/CCCommon.h"
+#include "base/ccMacros.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 NS_CC_BEGIN
 
+namespace
+{
+
+// Interned listener IDs. Entries are never removed, so keys and the strings they refer to stay valid.
+struct ListenerIDRegistry
+{
+    std::mutex mutex;
+    std::unordered_map<EventListener::ListenerID, EventListener::ListenerKey> keys;
+    std::vector<const EventListener::ListenerID*> ids;
+};
+
+// Not destroyed at exit: listeners and events may still be released during static destruction.
+ListenerIDRegistry& getRegistry()
+{
+    static ListenerIDRegistry* registry = new ListenerIDRegistry();
+    return *registry;
+}
+
+}
+
+EventListener::ListenerKey EventListener::getListenerKey(const ListenerID& listenerID, const ListenerID** internedID)
+{
+    auto& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    auto iter = registry.keys.find(listenerID);
+    if (iter == registry.keys.end())
+    {
+        auto key = static_cast<ListenerKey>(registry.ids.size());
+        iter = registry.keys.insert(std::make_pair(listenerID, key)).first;
+        registry.ids.push_back(&iter->first);
+    }
+
+    if (internedID)
+    {
+        *internedID = &iter->first;
+    }
+    return iter->second;
+}
+
+const EventListener::ListenerID& EventListener::getListenerIDForKey(ListenerKey key)
+{
+    auto& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    CCASSERT(key < registry.ids.size(), "Invalid listener key");
+    return *registry.ids[key];
+}
+
 EventListener::EventListener()
 {}
     
@@ -40,6 +94,7 @@ bool EventListener::init(Type t, const ListenerID& listenerID, const std::functi
     _onEvent = callback;
     _type = t;
     _listenerID = listenerID;
+    _listenerKey = getListenerKey(listenerID);
     _isRegistered = false;
     _paused = true;
     _isEnabled = true;
@@ -60,6 +60,19 @@ public:
 
     typedef std::string ListenerID;
 
+    /** ListenerID 注册后对应的整数. 同一个 ListenerID 总是对应同一个整数, 事件派发器内部用它代替字符串查找监听器. */
+    typedef unsigned int ListenerKey;
+
+    /** 获取 ListenerID 对应的整数, 第一次使用时注册. 线程安全.
+     *  @param internedID 不为空时返回注册表中保存的 ListenerID, 一直有效, 与 getListenerIDForKey 的结果相同.
+     *  @note 注册表只增不减, 每个出现过的 ListenerID (包括 EventCustom 的事件名) 都会一直占用内存.
+     *        不要用不断变化的字符串(例如拼接了计数或时间)作为事件名.
+     */
+    static ListenerKey getListenerKey(const ListenerID& listenerID, const ListenerID** internedID = nullptr);
+
+    /** 获取整数对应的 ListenerID. 返回的引用一直有效. 线程安全. */
+    static const ListenerID& getListenerIDForKey(ListenerKey key);
+
 protected:
     /** 构造函数 */
     EventListener();
@@ -118,6 +131,9 @@ protected:
      */
     inline const ListenerID& getListenerID() const { return _listenerID; };
 
+    /** 获取监听器ID对应的整数 */
+    inline ListenerKey getListenerKey() const { return _listenerKey; };
+
     /** 为监听器设置固定优先级
      *  @note 此方法仅用于 `fixed priority listeners`, 它需要传人一个非零(non-zero)值.
      *  0 被保留用于场景图像监听器的优先级
@@ -144,6 +160,7 @@ protected:
 
     Type _type;                             /// Event listener 事件监听器的类型
     ListenerID _listenerID;                 /// Event listener 事件监听器的ID
+    ListenerKey _listenerKey;               /// 监听器ID对应的整数
     bool _isRegistered;                     /// 监听器(listener)是否被加入到派发器(dispatcher) .
 
     int   _fixedPriority;   // 数值越高，优先级越高. 0 是场景图像的基础优先级.
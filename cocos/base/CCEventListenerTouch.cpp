@@ -25,6 +25,7 @@
 #include "base/CCEventListenerTouch.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventTouch.h"
+#include "2d/CCNode.h"
 
 #include <algorithm>
 
@@ -38,6 +39,11 @@ EventListenerTouchOneByOne::EventListenerTouchOneByOne()
 , onTouchEnded(nullptr)
 , onTouchCancelled(nullptr)
 , _needSwallow(false)
+, _hitTestEnabled(false)
+, _hitTestBoundsUsable(false)
+, _hitTestVersion(0)
+, _hitTestParent(nullptr)
+, _hitTestBoundsValid(false)
 {
 }
 
@@ -66,6 +72,52 @@ bool EventListenerTouchOneByOne::isSwallowTouches()
     return _needSwallow;
 }
 
+void EventListenerTouchOneByOne::setHitTestEnabled(bool enabled)
+{
+    _hitTestEnabled = enabled;
+    _hitTestBoundsValid = false;
+}
+
+bool EventListenerTouchOneByOne::isHitTestEnabled() const
+{
+    return _hitTestEnabled;
+}
+
+bool EventListenerTouchOneByOne::isInHitTestBounds(const Vec2& location)
+{
+    if (_node == nullptr)
+        return true;
+    
+    // The model view version changes whenever visit recomputes the node's matrix,
+    // which includes changes anywhere up the parent chain, so the key is O(1).
+    // Version 0 means the node has a transform visit hasn't applied yet: don't cache.
+    unsigned int version = _node->getModelViewVersion();
+    Node* parent = _node->getParent();
+    const Size& contentSize = _node->getContentSize();
+    if (!_hitTestBoundsValid || version == 0 || version != _hitTestVersion
+        || parent != _hitTestParent || !_hitTestContentSize.equals(contentSize))
+    {
+        Mat4 transform = _node->getNodeToWorldTransform();
+        
+        // Touches are mapped back through the full inverse matrix for 3D transforms,
+        // a bounding box in the XY plane can't tell those apart, so let the listener decide.
+        _hitTestBoundsUsable = TransformIsAffine2D(transform);
+        if (_hitTestBoundsUsable)
+        {
+            Rect bounds = RectApplyTransform(Rect(0, 0, contentSize.width, contentSize.height), transform);
+            
+            // The margin keeps float error from rejecting touches right on the edge
+            _hitTestBounds.setRect(bounds.origin.x - 1, bounds.origin.y - 1, bounds.size.width + 2, bounds.size.height + 2);
+        }
+        _hitTestVersion = version;
+        _hitTestParent = parent;
+        _hitTestContentSize = contentSize;
+        _hitTestBoundsValid = true;
+    }
+    
+    return !_hitTestBoundsUsable || _hitTestBounds.containsPoint(location);
+}
+
 EventListenerTouchOneByOne* EventListenerTouchOneByOne::create()
 {
     auto ret = new EventListenerTouchOneByOne();
@@ -107,6 +159,7 @@ EventListenerTouchOneByOne* EventListenerTouchOneByOne::clone()
         
         ret->_claimedTouches = _claimedTouches;
         ret->_needSwallow = _needSwallow;
+        ret->_hitTestEnabled = _hitTestEnabled;
     }
     else
     {
@@ -28,6 +28,7 @@
 
 #include "base/CCEventListener.h"
 #include "base/CCTouch.h"
+#include "math/CCMath.h"
 
 #include <vector>
 
@@ -45,6 +46,11 @@ public:
     void setSwallowTouches(bool needSwallow);
     bool isSwallowTouches();
     
+    /** 声明 onTouchBegan 只接受落在关联节点内容区域 (0, 0, contentSize) 内的触摸,
+     *  EventDispatcher 会用缓存的节点世界包围盒先排除区域外的触摸, 不再调用 onTouchBegan */
+    void setHitTestEnabled(bool enabled);
+    bool isHitTestEnabled() const;
+    
     /// Overrides
     virtual EventListenerTouchOneByOne* clone() override;
     virtual bool checkAvailable() override;
@@ -60,9 +66,20 @@ private:
     EventListenerTouchOneByOne();
     bool init();
     
+    /** 触摸点是否可能落在关联节点内, 节点的模型视图矩阵版本, 父节点或内容大小改变后才重新计算世界包围盒 */
+    bool isInHitTestBounds(const Vec2& location);
+    
     std::vector<Touch*> _claimedTouches;
     bool _needSwallow;
     
+    bool _hitTestEnabled;
+    bool _hitTestBoundsUsable;
+    Rect _hitTestBounds;
+    unsigned int _hitTestVersion;
+    Node* _hitTestParent;
+    Size _hitTestContentSize;
+    bool _hitTestBoundsValid;
+    
     friend class EventDispatcher;
 };
 
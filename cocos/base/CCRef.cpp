@@ -32,6 +32,10 @@ THE SOFTWARE.
 #include <algorithm>    // std::find
 #endif
 
+#if defined(_MSC_VER)
+#include <intrin.h>     // _ReturnAddress
+#endif
+
 NS_CC_BEGIN
 
 #if CC_USE_MEM_LEAK_DETECTION
@@ -135,7 +139,12 @@ void Ref::release()
 
 Ref* Ref::autorelease()
 {
-    PoolManager::getInstance()->getCurrentPool()->addObject(this);
+    // The caller is reported as the allocation site when the PoolManager instrumentation is on
+#if defined(_MSC_VER)
+    PoolManager::addToCurrentPool(this, _ReturnAddress());
+#else
+    PoolManager::addToCurrentPool(this, __builtin_return_address(0));
+#endif
     return this;
 }
 
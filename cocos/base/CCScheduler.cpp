@@ -32,6 +32,10 @@ THE SOFTWARE.
 #include "2d/ccCArray.h"
 #include "2d/CCScriptSupport.h"
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+
 NS_CC_BEGIN
 
 // data structures
@@ -61,13 +65,185 @@ typedef struct _hashSelectorEntry
 {
     ccArray             *timers;
     void                *target;
-    int                 timerIndex;
-    Timer               *currentTimer;
-    bool                currentTimerSalvaged;
     bool                paused;
     UT_hash_handle      hh;
 } tHashTimerEntry;
 
+// Queue used by performFunctionInCocosThread: many producers, one consumer (the cocos thread).
+// The functions live in a ring of preallocated cells (Dmitry Vyukov's bounded MPMC queue, used with
+// a single consumer): a producer claims a cell with one CAS on enqueuePos and publishes it through
+// the cell's sequence, so posting takes no lock, and std::function keeps small captures inline,
+// so it does not allocate either.
+// When the ring is full the functions go to a locked overflow list. While that list is not empty
+// every producer appends to it, which keeps the functions posted by one thread in order.
+typedef struct _functionQueue
+{
+    static const size_t CAPACITY = 1024; // power of 2
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        std::function<void()> function;
+    };
+
+    _functionQueue()
+    : enqueuePos(0)
+    , dequeuePos(0)
+    , overflowing(false)
+    , overflowed(0)
+    , drained(0)
+    , deferred(0)
+    {
+        for (size_t i = 0; i < CAPACITY; ++i)
+        {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    void push(const std::function<void()>& function)
+    {
+        if (!overflowing.load(std::memory_order_acquire) && pushRing(function))
+            return;
+
+        std::lock_guard<std::mutex> lock(overflowMutex);
+        // the consumer may have emptied the overflow list in the meantime
+        if (!overflowing.load(std::memory_order_relaxed) && pushRing(function))
+            return;
+
+        overflowing.store(true, std::memory_order_release);
+        overflow.push_back(function);
+        ++overflowed;
+    }
+
+    bool pushRing(const std::function<void()>& function)
+    {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell& cell = cells[pos & (CAPACITY - 1)];
+            ssize_t diff = (ssize_t)(cell.sequence.load(std::memory_order_acquire) - pos);
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.function = function;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                // full: the cell still holds the function posted CAPACITY positions ago
+                return false;
+            }
+            else
+            {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool popRing(std::function<void()>& function, size_t limit)
+    {
+        if (dequeuePos == limit)
+            return false;
+
+        Cell& cell = cells[dequeuePos & (CAPACITY - 1)];
+        // claimed by a producer which has not finished writing it yet
+        if (cell.sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+            return false;
+
+        function = std::move(cell.function);
+        cell.function = nullptr;
+        cell.sequence.store(dequeuePos + CAPACITY, std::memory_order_release);
+        ++dequeuePos;
+        return true;
+    }
+
+    bool popOverflow(std::function<void()>& function)
+    {
+        std::lock_guard<std::mutex> lock(overflowMutex);
+        if (overflow.empty())
+            return false;
+
+        function = std::move(overflow.front());
+        overflow.pop_front();
+        if (overflow.empty())
+        {
+            overflowing.store(false, std::memory_order_release);
+        }
+        return true;
+    }
+
+    // Runs the functions posted before the call. The ones they post run in the next call.
+    // With a budget, stops once 'budget' seconds have elapsed; at least one function runs.
+    void drain(float budget)
+    {
+        size_t ringLimit = enqueuePos.load(std::memory_order_acquire);
+        if (dequeuePos == ringLimit && !overflowing.load(std::memory_order_acquire))
+            return;
+
+        size_t overflowLimit = 0;
+        if (overflowing.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> lock(overflowMutex);
+            overflowLimit = overflow.size();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto outOfTime = [&]() {
+            return budget > 0 && std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count() >= budget;
+        };
+
+        // the ring holds the older functions: the overflow list is only used while the ring is full
+        std::function<void()> function;
+        while (popRing(function, ringLimit))
+        {
+            function();
+            function = nullptr;
+            ++drained;
+            if (outOfTime())
+            {
+                deferred += (ringLimit - dequeuePos) + overflowLimit;
+                return;
+            }
+        }
+
+        for (; overflowLimit > 0 && popOverflow(function); --overflowLimit)
+        {
+            function();
+            function = nullptr;
+            ++drained;
+            if (outOfTime())
+            {
+                deferred += overflowLimit - 1;
+                return;
+            }
+        }
+    }
+
+    Cell cells[CAPACITY];
+
+    // written by the producers, keep it away from the consumer's fields
+    char pad0[64];
+    std::atomic<size_t> enqueuePos;
+    char pad1[64];
+    size_t dequeuePos;
+
+    std::mutex overflowMutex;
+    std::deque<std::function<void()>> overflow;   // guarded by overflowMutex
+    std::atomic<bool> overflowing;
+    uint64_t overflowed;                          // guarded by overflowMutex
+
+    // consumer only
+    uint64_t drained;
+    uint64_t deferred;
+} tFunctionQueue;
+
+// Timer::_heapIndex values besides a position in the heap
+static const ssize_t TIMER_IDLE = -1;   // not counting: paused, unscheduled or waiting for its first tick
+static const ssize_t TIMER_FIRING = -2; // taken out of the heap, fires in the current tick
+
 // implementation Timer
 
 Timer::Timer()
@@ -79,6 +255,11 @@ Timer::Timer()
 , _repeat(0)
 , _delay(0.0f)
 , _interval(0.0f)
+, _startTime(0)
+, _fireTime(0)
+, _heapIndex(TIMER_IDLE)
+, _started(false)
+, _pending(false)
 {
 }
 
@@ -252,29 +433,208 @@ Scheduler::Scheduler(void)
 , _updatesPosList(nullptr)
 , _hashForUpdates(nullptr)
 , _hashForTimers(nullptr)
-, _currentTarget(nullptr)
-, _currentTargetSalvaged(false)
+, _timerClock(0)
 , _updateHashLocked(false)
 #if CC_ENABLE_SCRIPT_BINDING
 , _scriptHandlerEntries(20)
 #endif
 {
-    // I don't expect to have more than 30 functions to all per frame
-    _functionsToPerform.reserve(30);
+    _functionsToPerform = new tFunctionQueue();
+    _performFunctionBudget = 0;
 }
 
 Scheduler::~Scheduler(void)
 {
     unscheduleAll();
+
+    for (auto timer : _timersToStart)
+    {
+        timer->release();
+    }
+
+    delete _functionsToPerform;
 }
 
 void Scheduler::removeHashElement(_hashSelectorEntry *element)
 {
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        stopTimer(static_cast<Timer*>(element->timers->arr[i]));
+    }
     ccArrayFree(element->timers);
     HASH_DEL(_hashForTimers, element);
     free(element);
 }
 
+void Scheduler::queueTimer(Timer *timer)
+{
+    // like Timer::update(), a timer only starts counting after the first tick it sees
+    timer->_started = false;
+    if (! timer->_pending)
+    {
+        timer->_pending = true;
+        timer->retain();
+        _timersToStart.push_back(timer);
+    }
+}
+
+void Scheduler::stopTimer(Timer *timer)
+{
+    if (timer->_heapIndex >= 0)
+    {
+        removeTimer(timer);
+    }
+    timer->_heapIndex = TIMER_IDLE;
+    // still referenced by _timersToStart, skipped there
+    timer->_pending = false;
+}
+
+void Scheduler::setTimerInterval(Timer *timer, float interval)
+{
+    timer->setInterval(interval);
+    if (timer->_heapIndex >= 0)
+    {
+        removeTimer(timer);
+        pushTimer(timer);
+    }
+}
+
+void Scheduler::pauseTimers(tHashTimerEntry *element)
+{
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        Timer *timer = static_cast<Timer*>(element->timers->arr[i]);
+        if (timer->_heapIndex >= 0 || timer->_heapIndex == TIMER_FIRING)
+        {
+            // keep the progress, resumeTimers() continues from it
+            timer->_elapsed = (float)(_timerClock - timer->_startTime);
+            stopTimer(timer);
+        }
+        timer->_pending = false;
+    }
+}
+
+void Scheduler::resumeTimers(tHashTimerEntry *element)
+{
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        Timer *timer = static_cast<Timer*>(element->timers->arr[i]);
+        if (timer->_heapIndex != TIMER_IDLE || timer->_pending)
+        {
+            continue;
+        }
+
+        if (timer->_started)
+        {
+            timer->_startTime = _timerClock - timer->_elapsed;
+            pushTimer(timer);
+        }
+        else
+        {
+            queueTimer(timer);
+        }
+    }
+}
+
+void Scheduler::fireTimer(Timer *timer)
+{
+    // same bookkeeping as Timer::update(), done before trigger() so that a
+    // callback pausing its own target stores the rewound progress
+    timer->_elapsed = (float)(_timerClock - timer->_startTime);
+    if (timer->_useDelay)
+    {
+        timer->_startTime += timer->_delay;
+        timer->_useDelay = false;
+    }
+    else
+    {
+        timer->_startTime = _timerClock;
+    }
+    timer->_timesExecuted += 1;
+    bool finished = (! timer->_runForever && timer->_timesExecuted > timer->_repeat);
+
+    timer->trigger();
+
+    if (finished)
+    {
+        timer->cancel();
+    }
+    else if (timer->_heapIndex == TIMER_FIRING)
+    {
+        // neither paused nor unscheduled by the callback
+        pushTimer(timer);
+    }
+}
+
+void Scheduler::pushTimer(Timer *timer)
+{
+    timer->_fireTime = timer->_startTime + (timer->_useDelay ? timer->_delay : timer->_interval);
+    timer->_heapIndex = _timerHeap.size();
+    _timerHeap.push_back(timer);
+    siftTimerUp(timer->_heapIndex);
+}
+
+void Scheduler::removeTimer(Timer *timer)
+{
+    ssize_t index = timer->_heapIndex;
+    Timer *last = _timerHeap.back();
+    _timerHeap.pop_back();
+    timer->_heapIndex = TIMER_IDLE;
+
+    if (last != timer)
+    {
+        _timerHeap[index] = last;
+        last->_heapIndex = index;
+        siftTimerUp(index);
+        siftTimerDown(last->_heapIndex);
+    }
+}
+
+void Scheduler::siftTimerUp(ssize_t index)
+{
+    Timer *timer = _timerHeap[index];
+    while (index > 0)
+    {
+        ssize_t parent = (index - 1) / 2;
+        if (_timerHeap[parent]->_fireTime <= timer->_fireTime)
+        {
+            break;
+        }
+        _timerHeap[index] = _timerHeap[parent];
+        _timerHeap[index]->_heapIndex = index;
+        index = parent;
+    }
+    _timerHeap[index] = timer;
+    timer->_heapIndex = index;
+}
+
+void Scheduler::siftTimerDown(ssize_t index)
+{
+    ssize_t count = _timerHeap.size();
+    Timer *timer = _timerHeap[index];
+    while (true)
+    {
+        ssize_t child = index * 2 + 1;
+        if (child >= count)
+        {
+            break;
+        }
+        if (child + 1 < count && _timerHeap[child + 1]->_fireTime < _timerHeap[child]->_fireTime)
+        {
+            ++child;
+        }
+        if (timer->_fireTime <= _timerHeap[child]->_fireTime)
+        {
+            break;
+        }
+        _timerHeap[index] = _timerHeap[child];
+        _timerHeap[index]->_heapIndex = index;
+        index = child;
+    }
+    _timerHeap[index] = timer;
+    timer->_heapIndex = index;
+}
+
 void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, bool paused, const std::string& key)
 {
     this->schedule(callback, target, interval, kRepeatForever, 0.0f, paused, key);
@@ -316,7 +676,7 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
             if (key == timer->getKey())
             {
                 CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", timer->getInterval(), interval);
-                timer->setInterval(interval);
+                setTimerInterval(timer, interval);
                 return;
             }        
         }
@@ -326,6 +686,10 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
     TimerTargetCallback *timer = new TimerTargetCallback();
     timer->initWithCallback(this, callback, target, key, interval, repeat, delay);
     ccArrayAppendObject(element->timers, timer);
+    if (! element->paused)
+    {
+        queueTimer(timer);
+    }
     timer->release();
 }
 
@@ -351,30 +715,13 @@ void Scheduler::unschedule(const std::string &key, void *target)
 
             if (key == timer->getKey())
             {
-                if (timer == element->currentTimer && (! element->currentTimerSalvaged))
-                {
-                    element->currentTimer->retain();
-                    element->currentTimerSalvaged = true;
-                }
-
+                // a timer firing right now is kept alive by update()
+                stopTimer(timer);
                 ccArrayRemoveObjectAtIndex(element->timers, i, true);
 
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
-
                 if (element->timers->num == 0)
                 {
-                    if (_currentTarget == element)
-                    {
-                        _currentTargetSalvaged = true;
-                    }
-                    else
-                    {
-                        removeHashElement(element);
-                    }
+                    removeHashElement(element);
                 }
 
                 return;
@@ -631,22 +978,7 @@ void Scheduler::unscheduleAllForTarget(void *target)
 
     if (element)
     {
-        if (ccArrayContainsObject(element->timers, element->currentTimer)
-            && (! element->currentTimerSalvaged))
-        {
-            element->currentTimer->retain();
-            element->currentTimerSalvaged = true;
-        }
-        ccArrayRemoveAllObjects(element->timers);
-
-        if (_currentTarget == element)
-        {
-            _currentTargetSalvaged = true;
-        }
-        else
-        {
-            removeHashElement(element);
-        }
+        removeHashElement(element);
     }
 
     // update selector
@@ -683,9 +1015,10 @@ void Scheduler::resumeTarget(void *target)
     // custom selectors
     tHashTimerEntry *element = nullptr;
     HASH_FIND_PTR(_hashForTimers, &target, element);
-    if (element)
+    if (element && element->paused)
     {
         element->paused = false;
+        resumeTimers(element);
     }
 
     // update selector
@@ -705,9 +1038,10 @@ void Scheduler::pauseTarget(void *target)
     // custom selectors
     tHashTimerEntry *element = nullptr;
     HASH_FIND_PTR(_hashForTimers, &target, element);
-    if (element)
+    if (element && ! element->paused)
     {
         element->paused = true;
+        pauseTimers(element);
     }
 
     // update selector
@@ -756,7 +1090,11 @@ std::set<void*> Scheduler::pauseAllTargetsWithMinPriority(int minPriority)
     for(tHashTimerEntry *element = _hashForTimers; element != nullptr;
         element = (tHashTimerEntry*)element->hh.next)
     {
-        element->paused = true;
+        if (! element->paused)
+        {
+            element->paused = true;
+            pauseTimers(element);
+        }
         idsWithSelectors.insert(element->target);
     }
 
@@ -804,11 +1142,20 @@ void Scheduler::resumeTargets(const std::set<void*>& targetsToResume)
 
 void Scheduler::performFunctionInCocosThread(const std::function<void ()> &function)
 {
-    _performMutex.lock();
-
-    _functionsToPerform.push_back(function);
+    _functionsToPerform->push(function);
+}
 
-    _performMutex.unlock();
+Scheduler::PerformFunctionStats Scheduler::getPerformFunctionStats() const
+{
+    PerformFunctionStats stats;
+    {
+        std::lock_guard<std::mutex> lock(_functionsToPerform->overflowMutex);
+        stats.overflowed = _functionsToPerform->overflowed;
+    }
+    stats.enqueued = _functionsToPerform->enqueuePos.load(std::memory_order_acquire) + stats.overflowed;
+    stats.drained = _functionsToPerform->drained;
+    stats.deferred = _functionsToPerform->deferred;
+    return stats;
 }
 
 // main loop
@@ -855,44 +1202,45 @@ void Scheduler::update(float dt)
         }
     }
 
-    // Iterate over all the custom selectors
-    for (tHashTimerEntry *elt = _hashForTimers; elt != nullptr; )
+    // Fire the custom selectors that are due. They are collected first so that
+    // each timer fires at most once per tick, whatever the callbacks schedule
+    _timerClock += dt;
+    while (! _timerHeap.empty() && _timerHeap.front()->_fireTime <= _timerClock)
     {
-        _currentTarget = elt;
-        _currentTargetSalvaged = false;
+        Timer *timer = _timerHeap.front();
+        removeTimer(timer);
+        timer->_heapIndex = TIMER_FIRING;
+        timer->retain();
+        _firedTimers.push_back(timer);
+    }
 
-        if (! _currentTarget->paused)
+    for (auto timer : _firedTimers)
+    {
+        // an earlier callback may have paused or unscheduled it
+        if (timer->_heapIndex == TIMER_FIRING)
         {
-            // The 'timers' array may change while inside this loop
-            for (elt->timerIndex = 0; elt->timerIndex < elt->timers->num; ++(elt->timerIndex))
-            {
-                elt->currentTimer = (Timer*)(elt->timers->arr[elt->timerIndex]);
-                elt->currentTimerSalvaged = false;
-
-                elt->currentTimer->update(dt);
-
-                if (elt->currentTimerSalvaged)
-                {
-                    // The currentTimer told the remove itself. To prevent the timer from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    elt->currentTimer->release();
-                }
-
-                elt->currentTimer = nullptr;
-            }
+            fireTimer(timer);
         }
+        timer->release();
+    }
+    _firedTimers.clear();
 
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashTimerEntry *)elt->hh.next;
-
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->timers->num == 0)
+    // Timers scheduled before or during this tick start counting from now on,
+    // like the first Timer::update() call which only resets _elapsed
+    for (auto timer : _timersToStart)
+    {
+        if (timer->_pending)
         {
-            removeHashElement(_currentTarget);
+            timer->_pending = false;
+            timer->_started = true;
+            timer->_elapsed = 0;
+            timer->_timesExecuted = 0;
+            timer->_startTime = _timerClock;
+            pushTimer(timer);
         }
+        timer->release();
     }
+    _timersToStart.clear();
 
     // delete all updates that are marked for deletion
     // updates with priority < 0
@@ -923,7 +1271,6 @@ void Scheduler::update(float dt)
     }
 
     _updateHashLocked = false;
-    _currentTarget = nullptr;
 
 #if CC_ENABLE_SCRIPT_BINDING
     //
@@ -951,19 +1298,8 @@ void Scheduler::update(float dt)
     // Functions allocated from another thread
     //
 
-    // Testing size is faster than locking / unlocking.
-    // And almost never there will be functions scheduled to be called.
-    if( !_functionsToPerform.empty() ) {
-        _performMutex.lock();
-        // fixed #4123: Save the callback functions, they must be invoked after '_performMutex.unlock()', otherwise if new functions are added in callback, it will cause thread deadlock.
-        auto temp = _functionsToPerform;
-        _functionsToPerform.clear();
-        _performMutex.unlock();
-        for( const auto &function : temp ) {
-            function();
-        }
-        
-    }
+    // Only the functions posted before this point run in this tick, the ones they post wait for the next one
+    _functionsToPerform->drain(_performFunctionBudget);
 }
 
 void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, unsigned int repeat, float delay, bool paused)
@@ -1001,7 +1337,7 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
             if (selector == timer->getSelector())
             {
                 CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", timer->getInterval(), interval);
-                timer->setInterval(interval);
+                setTimerInterval(timer, interval);
                 return;
             }
         }
@@ -1011,6 +1347,10 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
     TimerTargetSelector *timer = new TimerTargetSelector();
     timer->initWithSelector(this, selector, target, interval, repeat, delay);
     ccArrayAppendObject(element->timers, timer);
+    if (! element->paused)
+    {
+        queueTimer(timer);
+    }
     timer->release();
 }
 
@@ -1076,30 +1416,13 @@ void Scheduler::unschedule(SEL_SCHEDULE selector, Ref *target)
             
             if (selector == timer->getSelector())
             {
-                if (timer == element->currentTimer && (! element->currentTimerSalvaged))
-                {
-                    element->currentTimer->retain();
-                    element->currentTimerSalvaged = true;
-                }
-                
+                // a timer firing right now is kept alive by update()
+                stopTimer(timer);
                 ccArrayRemoveObjectAtIndex(element->timers, i, true);
                 
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
-                
                 if (element->timers->num == 0)
                 {
-                    if (_currentTarget == element)
-                    {
-                        _currentTargetSalvaged = true;
-                    }
-                    else
-                    {
-                        removeHashElement(element);
-                    }
+                    removeHashElement(element);
                 }
                 
                 return;
@@ -70,7 +70,8 @@ public:
     void update(float dt);
     
 protected:
-    
+    friend class Scheduler;
+
     Scheduler* _scheduler; // weak ref
     float _elapsed;
     bool _runForever;
@@ -79,6 +80,13 @@ protected:
     unsigned int _repeat; //0 = once, 1 is 2 x executed
     float _delay;
     float _interval;
+
+    // state used by the Scheduler's fire time heap
+    double _startTime;   // scheduler clock when _elapsed was last reset
+    double _fireTime;    // scheduler clock when the timer fires next
+    ssize_t _heapIndex;  // index in the heap, or a negative state
+    bool _started;       // false until the first tick after being scheduled
+    bool _pending;       // waiting in the start queue
 };
 
 
@@ -148,6 +156,7 @@ private:
 struct _listEntry;
 struct _hashSelectorEntry;
 struct _hashUpdateEntry;
+struct _functionQueue;
 
 #if CC_ENABLE_SCRIPT_BINDING
 class SchedulerScriptHandlerEntry;
@@ -163,6 +172,8 @@ class SchedulerScriptHandlerEntry;
 
 应该尽量避免使用'custom selectors'. 使用'update selector'更加快，且消耗的内存更少.
 
+custom 选择器按下次触发的时间保存在最小堆中, 每帧只处理到期的计时器.
+
 */
 class CC_DLL Scheduler : public Ref
 {
@@ -365,6 +376,35 @@ public:
      @since v3.0
      */
     void performFunctionInCocosThread( const std::function<void()> &function);
+
+    /** performFunctionInCocosThread 的统计计数 */
+    struct PerformFunctionStats
+    {
+        /** 已提交的函数总数 */
+        uint64_t enqueued;
+        /** 已执行的函数总数 */
+        uint64_t drained;
+        /** 因超出时间预算被推迟到下一帧的次数, 同一个函数推迟多帧时每帧计一次 */
+        uint64_t deferred;
+        /** 队列已满时改走备用队列的函数数 */
+        uint64_t overflowed;
+    };
+
+    /** 设置每帧执行 performFunctionInCocosThread 提交的函数的时间预算(秒).
+     超出预算后剩下的函数推迟到下一帧, 每帧至少执行一个. 0 表示不限制, 默认为 0.
+     @since v3.2
+     */
+    void setPerformFunctionBudget(float seconds) { _performFunctionBudget = seconds; }
+
+    /** 获取每帧执行 performFunctionInCocosThread 提交的函数的时间预算(秒)
+     @since v3.2
+     */
+    float getPerformFunctionBudget() const { return _performFunctionBudget; }
+
+    /** 获取 performFunctionInCocosThread 的统计计数. 只能在cocos2d线程中调用.
+     @since v3.2
+     */
+    PerformFunctionStats getPerformFunctionStats() const;
     
     /////////////////////////////////////
     
@@ -433,6 +473,19 @@ protected:
     void removeHashElement(struct _hashSelectorEntry *element);
     void removeUpdateFromHash(struct _listEntry *entry);
 
+    // timer specific
+
+    void queueTimer(Timer *timer);
+    void stopTimer(Timer *timer);
+    void setTimerInterval(Timer *timer, float interval);
+    void pauseTimers(struct _hashSelectorEntry *element);
+    void resumeTimers(struct _hashSelectorEntry *element);
+    void fireTimer(Timer *timer);
+    void pushTimer(Timer *timer);
+    void removeTimer(Timer *timer);
+    void siftTimerUp(ssize_t index);
+    void siftTimerDown(ssize_t index);
+
     // update specific
 
     void priorityIn(struct _listEntry **list, const ccSchedulerFunc& callback, void *target, int priority, bool paused);
@@ -450,9 +503,11 @@ protected:
     struct _hashUpdateEntry *_hashForUpdates; // hash used to fetch quickly the list entries for pause,delete,etc
 
     // Used for "selectors with interval"
-    struct _hashSelectorEntry *_hashForTimers;
-    struct _hashSelectorEntry *_currentTarget;
-    bool _currentTargetSalvaged;
+    struct _hashSelectorEntry *_hashForTimers; // lookup by target, pause state
+    std::vector<Timer*> _timerHeap;            // running timers, min-heap on fire time
+    std::vector<Timer*> _timersToStart;        // scheduled timers waiting for their first tick
+    std::vector<Timer*> _firedTimers;          // due timers of the current tick
+    double _timerClock;                        // sum of the scaled dt of all ticks
     // If true unschedule will not remove anything from a hash. Elements will only be marked for deletion.
     bool _updateHashLocked;
     
@@ -461,8 +516,8 @@ protected:
 #endif
     
     // Used for "perform Function"
-    std::vector<std::function<void()>> _functionsToPerform;
-    std::mutex _performMutex;
+    struct _functionQueue *_functionsToPerform; // lock-free queue, producers are any thread, consumer is the cocos thread
+    float _performFunctionBudget;
 };
 
 // end of global group
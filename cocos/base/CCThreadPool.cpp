@@ -0,0 +1,175 @@
+/****************************************************************************
+ Copyright (c) 2014 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/CCThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+static ThreadPool* s_sharedThreadPool = nullptr;
+
+static std::mutex& sharedThreadPoolMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+ThreadPool* ThreadPool::getInstance()
+{
+    std::lock_guard<std::mutex> lock(sharedThreadPoolMutex());
+    if (!s_sharedThreadPool)
+    {
+        int cores = (int)std::thread::hardware_concurrency();
+        s_sharedThreadPool = new ThreadPool(std::max(cores - 1, 1));
+    }
+    return s_sharedThreadPool;
+}
+
+void ThreadPool::destroyInstance()
+{
+    std::lock_guard<std::mutex> lock(sharedThreadPoolMutex());
+    CC_SAFE_DELETE(s_sharedThreadPool);
+}
+
+ThreadPool::ThreadPool(int threadCount)
+: _stop(false)
+{
+    CCASSERT(threadCount > 0, "ThreadPool needs at least one thread");
+    for (int i = 0; i < threadCount; ++i)
+    {
+        _threads.push_back(std::thread(&ThreadPool::workerLoop, this));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_tasksMutex);
+        _stop = true;
+    }
+    _tasksCondition.notify_all();
+
+    for (auto& thread : _threads)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::pushTask(const std::function<void()>& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(_tasksMutex);
+        _tasks.push_back(task);
+    }
+    _tasksCondition.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_tasksMutex);
+            _tasksCondition.wait(lock, [this]{ return _stop || !_tasks.empty(); });
+
+            // drain the queue before quitting
+            if (_tasks.empty())
+                return;
+
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(ssize_t count, ssize_t minChunkSize, const std::function<void(ssize_t begin, ssize_t end)>& func)
+{
+    if (count <= 0)
+        return;
+
+    minChunkSize = std::max(minChunkSize, (ssize_t)1);
+    ssize_t chunks = std::min((count + minChunkSize - 1) / minChunkSize, (ssize_t)_threads.size() + 1);
+    if (chunks <= 1)
+    {
+        func(0, count);
+        return;
+    }
+
+    const ssize_t chunkSize = (count + chunks - 1) / chunks;
+
+    struct Progress
+    {
+        std::atomic<ssize_t> nextChunk;
+        ssize_t finishedChunks;
+        std::mutex mutex;
+        std::condition_variable condition;
+    };
+    auto progress = std::make_shared<Progress>();
+    progress->nextChunk = 0;
+    progress->finishedChunks = 0;
+
+    // Every job keeps grabbing chunks until none are left, so the calling thread
+    // finishes the work by itself if all workers are busy. The caller only waits for
+    // chunks that a running thread has claimed, never for queued jobs, so calling this
+    // from a worker can't deadlock. A job that starts after every chunk was claimed
+    // returns without touching func, which may be gone by then.
+    auto job = [progress, chunks, chunkSize, count, &func]() {
+        ssize_t chunk;
+        ssize_t done = 0;
+        while ((chunk = progress->nextChunk++) < chunks)
+        {
+            ssize_t begin = chunk * chunkSize;
+            ssize_t end = std::min(begin + chunkSize, count);
+            if (begin < end)
+                func(begin, end);
+            ++done;
+        }
+
+        if (done > 0)
+        {
+            std::lock_guard<std::mutex> lock(progress->mutex);
+            progress->finishedChunks += done;
+            if (progress->finishedChunks == chunks)
+                progress->condition.notify_one();
+        }
+    };
+
+    for (ssize_t i = 1; i < chunks; ++i)
+    {
+        pushTask(job);
+    }
+    job();
+
+    std::unique_lock<std::mutex> lock(progress->mutex);
+    progress->condition.wait(lock, [&]{ return progress->finishedChunks == chunks; });
+}
+
+NS_CC_END
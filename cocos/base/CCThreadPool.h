@@ -0,0 +1,88 @@
+/****************************************************************************
+ Copyright (c) 2014 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCTHREADPOOL_H__
+#define __CCTHREADPOOL_H__
+
+#include "base/CCPlatformMacros.h"
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup base_nodes
+ * @{
+ */
+
+/** @brief 固定数量工作线程组成的线程池.
+ 
+ 用于把引擎内部可以并行的工作(例如顶点变换)分发到多个核上.
+ 提交的任务不能调用 OpenGL, 也不能访问场景图.
+ */
+class CC_DLL ThreadPool
+{
+public:
+    /** 返回共享的线程池, 工作线程数量为 CPU 核数减一(至少为一). 线程安全. */
+    static ThreadPool* getInstance();
+
+    /** 销毁共享的线程池, 等待所有已提交的任务完成. 调用时其他线程不能再使用共享的线程池. */
+    static void destroyInstance();
+
+    /** 使用给定数量的工作线程创建线程池 */
+    explicit ThreadPool(int threadCount);
+    ~ThreadPool();
+
+    /** 返回工作线程数量 */
+    inline int getThreadCount() const { return (int)_threads.size(); }
+
+    /** 提交一个任务, 由某个工作线程异步执行 */
+    void pushTask(const std::function<void()>& task);
+
+    /** 把 [0, count) 分成若干段, 在工作线程和调用线程上并行执行 func(begin, end).
+     每段至少包含 minChunkSize 个元素. 所有分段执行完后才返回.
+     可以在工作线程中调用(包括在 func 中嵌套调用): 工作线程都忙时, 调用线程自己执行所有分段.
+     */
+    void parallelFor(ssize_t count, ssize_t minChunkSize, const std::function<void(ssize_t begin, ssize_t end)>& func);
+
+protected:
+    void workerLoop();
+
+    std::vector<std::thread> _threads;
+    std::deque<std::function<void()>> _tasks;
+    std::mutex _tasksMutex;
+    std::condition_variable _tasksCondition;
+    bool _stop;
+};
+
+// end of base_nodes group
+/// @}
+
+NS_CC_END
+
+#endif // __CCTHREADPOOL_H__
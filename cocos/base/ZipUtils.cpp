@@ -32,6 +32,15 @@
 #include "2d/platform/CCFileUtils.h"
 #include "unzip.h"
 #include <map>
+#include <vector>
+#include <mutex>
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT) && (CC_TARGET_PLATFORM != CC_PLATFORM_WP8)
+#define CC_ZIPFILE_USE_PREAD 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits>
+#endif
 
 NS_CC_BEGIN
 
@@ -125,75 +134,266 @@ inline unsigned int ZipUtils::checksumPvr(const unsigned int *data, ssize_t len)
     return cs;
 }
 
-// memory in iPhone is precious
-// Should buffer factor be 1.5 instead of 2 ?
-#define BUFFER_INC_FACTOR (2)
-
-int ZipUtils::inflateMemoryWithHint(unsigned char *in, ssize_t inLength, unsigned char **out, ssize_t *outLength, ssize_t outLenghtHint)
+// Inflates stream until it ends. Output fills buffer first, whatever does not
+// fit is handed to overflow in small chunks (an empty overflow makes that an
+// error). input is asked for more data whenever avail_in runs out, it may be
+// empty when next_in already holds everything. Returns the zlib status,
+// Z_STREAM_END on success, and the total output length in produced.
+static int inflateChunks(z_stream &stream, const ZipUtils::InflateInput &input, unsigned char *buffer, ssize_t bufferLength,
+                         const ZipUtils::InflateOutput &overflow, ssize_t *produced)
 {
-    /* ret value */
-    int err = Z_OK;
-    
-    ssize_t bufferSize = outLenghtHint;
-    *out = (unsigned char*)malloc(bufferSize);
-    
-    z_stream d_stream; /* decompression stream */
-    d_stream.zalloc = (alloc_func)0;
-    d_stream.zfree = (free_func)0;
-    d_stream.opaque = (voidpf)0;
-    
-    d_stream.next_in  = in;
-    d_stream.avail_in = static_cast<unsigned int>(inLength);
-    d_stream.next_out = *out;
-    d_stream.avail_out = static_cast<unsigned int>(bufferSize);
-    
-    /* window size to hold 256k */
-    if( (err = inflateInit2(&d_stream, 15 + 32)) != Z_OK )
-        return err;
+    unsigned char chunk[16 * 1024];
+    bool inputDone = !input;
     
+    // done ends up 1 for gzip streams and -1 for zlib streams
+    gz_header gzipHeader;
+    memset(&gzipHeader, 0, sizeof(gzipHeader));
+    inflateGetHeader(&stream, &gzipHeader);
+    ssize_t total = 0;
+    int err = Z_OK;
+
+    auto refill = [&]() {
+        if (stream.avail_in == 0 && !inputDone)
+        {
+            const unsigned char *data = nullptr;
+            ssize_t length = 0;
+            if (input(&data, &length) && length > 0)
+            {
+                stream.next_in = const_cast<Bytef*>(data);
+                stream.avail_in = static_cast<uInt>(length);
+            }
+            else
+            {
+                inputDone = true;
+            }
+        }
+    };
+
     for (;;)
     {
-        err = inflate(&d_stream, Z_NO_FLUSH);
-        
-        if (err == Z_STREAM_END)
+        refill();
+
+        bool intoBuffer = total < bufferLength;
+        if (intoBuffer)
         {
-            break;
+            // zlib counts in uInt, hand out huge buffers in pieces
+            ssize_t left = bufferLength - total;
+            stream.next_out = buffer + total;
+            stream.avail_out = static_cast<uInt>(left < 0x40000000 ? left : 0x40000000);
         }
-        
-        switch (err)
+        else
         {
-            case Z_NEED_DICT:
-                err = Z_DATA_ERROR;
-            case Z_DATA_ERROR:
-            case Z_MEM_ERROR:
-                inflateEnd(&d_stream);
-                return err;
+            // with a full buffer inflate may still have to consume the end of
+            // the stream, any real output past it needs an overflow though
+            stream.next_out = chunk;
+            stream.avail_out = sizeof(chunk);
         }
-        
-        // not enough memory ?
-        if (err != Z_STREAM_END)
+
+        uInt available = stream.avail_out;
+        err = inflate(&stream, Z_NO_FLUSH);
+        ssize_t got = available - stream.avail_out;
+        total += got;
+
+        if (!intoBuffer && got > 0 && (!overflow || !overflow(chunk, got)))
         {
-            *out = (unsigned char*)realloc(*out, bufferSize * BUFFER_INC_FACTOR);
-            
-            /* not enough memory, ouch */
-            if (! *out )
+            err = Z_BUF_ERROR;
+            break;
+        }
+
+        if (err == Z_STREAM_END)
+        {
+            // concatenated gzip members decode as one stream, like gzread does.
+            // Whatever follows a zlib stream is ignored
+            if (gzipHeader.done == 1)
             {
-                CCLOG("cocos2d: ZipUtils: realloc failed");
-                inflateEnd(&d_stream);
-                return Z_MEM_ERROR;
+                refill();
+                if (stream.avail_in > 0 && stream.next_in[0] == 0x1F && inflateReset(&stream) == Z_OK)
+                {
+                    memset(&gzipHeader, 0, sizeof(gzipHeader));
+                    inflateGetHeader(&stream, &gzipHeader);
+                    continue;
+                }
             }
-            
-            d_stream.next_out = *out + bufferSize;
-            d_stream.avail_out = static_cast<unsigned int>(bufferSize);
-            bufferSize *= BUFFER_INC_FACTOR;
+            break;
+        }
+        if (err == Z_NEED_DICT)
+        {
+            err = Z_DATA_ERROR;
+        }
+        if (err == Z_DATA_ERROR || err == Z_MEM_ERROR || err == Z_STREAM_ERROR)
+        {
+            break;
+        }
+        // no progress without input left means the data is truncated
+        if (got == 0 && stream.avail_in == 0 && inputDone)
+        {
+            err = Z_DATA_ERROR;
+            break;
         }
     }
-    
-    *outLength = bufferSize - d_stream.avail_out;
-    err = inflateEnd(&d_stream);
+
+    *produced = total;
     return err;
 }
 
+static void initInflateStream(z_stream &stream)
+{
+    stream.zalloc = (alloc_func)0;
+    stream.zfree = (free_func)0;
+    stream.opaque = (voidpf)0;
+    stream.next_in = Z_NULL;
+    stream.avail_in = 0;
+}
+
+ssize_t ZipUtils::inflateStream(const InflateInput &input, const InflateOutput &output)
+{
+    CCASSERT(input && output, "Invalid callbacks for inflateStream");
+
+    z_stream d_stream;
+    initInflateStream(d_stream);
+
+    // 15 + 32: auto detect zlib or gzip header
+    if (inflateInit2(&d_stream, 15 + 32) != Z_OK)
+    {
+        return -1;
+    }
+
+    ssize_t total = 0;
+    int err = inflateChunks(d_stream, input, nullptr, 0, output, &total);
+    inflateEnd(&d_stream);
+
+    if (err != Z_STREAM_END)
+    {
+        CCLOG("cocos2d: ZipUtils: inflateStream failed: %d", err);
+        return -1;
+    }
+    return total;
+}
+
+ssize_t ZipUtils::inflateMemoryToBuffer(const unsigned char *in, ssize_t inLength, unsigned char *out, ssize_t outLength)
+{
+    z_stream d_stream;
+    initInflateStream(d_stream);
+    d_stream.next_in = const_cast<Bytef*>(in);
+    d_stream.avail_in = static_cast<uInt>(inLength);
+
+    if (inflateInit2(&d_stream, 15 + 32) != Z_OK)
+    {
+        return -1;
+    }
+
+    // single pass straight into the destination, nothing else is allocated
+    ssize_t total = 0;
+    int err = inflateChunks(d_stream, nullptr, out, outLength, nullptr, &total);
+    inflateEnd(&d_stream);
+
+    return err == Z_STREAM_END ? total : -1;
+}
+
+int ZipUtils::inflateToBuffer(const InflateInput &input, unsigned char **out, ssize_t *outLength, ssize_t outLengthHint)
+{
+    *out = nullptr;
+    *outLength = 0;
+
+    z_stream d_stream;
+    initInflateStream(d_stream);
+
+    int err = inflateInit2(&d_stream, 15 + 32);
+    if (err != Z_OK)
+    {
+        return err;
+    }
+
+    ssize_t bufferSize = outLengthHint > 0 ? outLengthHint : 0;
+    unsigned char *buffer = (unsigned char*)malloc(bufferSize > 0 ? bufferSize : 1);
+    if (!buffer)
+    {
+        inflateEnd(&d_stream);
+        return Z_MEM_ERROR;
+    }
+
+    // when the hint is too small the rest is kept in chunks and joined once at
+    // the end, instead of growing (and copying) the whole buffer repeatedly
+    std::vector<std::vector<unsigned char>> chunks;
+    auto overflow = [&chunks](const unsigned char *data, ssize_t length) {
+        chunks.emplace_back(data, data + length);
+        return true;
+    };
+
+    ssize_t total = 0;
+    err = inflateChunks(d_stream, input, buffer, bufferSize, overflow, &total);
+    inflateEnd(&d_stream);
+
+    if (err != Z_STREAM_END)
+    {
+        free(buffer);
+        return err;
+    }
+
+    if (!chunks.empty())
+    {
+        unsigned char *joined = (unsigned char*)malloc(total);
+        if (!joined)
+        {
+            CCLOG("cocos2d: ZipUtils: out of memory");
+            free(buffer);
+            return Z_MEM_ERROR;
+        }
+
+        memcpy(joined, buffer, bufferSize);
+        ssize_t offset = bufferSize;
+        for (const auto& chunk : chunks)
+        {
+            memcpy(joined + offset, chunk.data(), chunk.size());
+            offset += chunk.size();
+        }
+        free(buffer);
+        buffer = joined;
+    }
+
+    *out = buffer;
+    *outLength = total;
+    return Z_OK;
+}
+
+// Reads the uncompressed size (modulo 4GB) from the trailer of a gzip member.
+// Sizes deflate could not possibly produce from compressedLength bytes are
+// ignored so a damaged file can't request a huge buffer.
+static ssize_t gzipSizeFromTrailer(const unsigned char *trailer, ssize_t compressedLength)
+{
+    uint32_t size = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | ((uint32_t)trailer[3] << 24);
+    return (double)size <= (double)compressedLength * 1032 ? (ssize_t)size : 0;
+}
+
+int ZipUtils::inflateMemoryWithHint(unsigned char *in, ssize_t inLength, unsigned char **out, ssize_t *outLength, ssize_t outLenghtHint)
+{
+    // gzip data knows its own size, which beats any guess. Concatenated
+    // members only report the last one, the overflow catches the rest
+    ssize_t hint = outLenghtHint;
+    if (isGZipBuffer(in, inLength) && inLength >= 18)
+    {
+        ssize_t size = gzipSizeFromTrailer(in + inLength - 4, inLength);
+        if (size > 0)
+        {
+            hint = size;
+        }
+    }
+
+    bool consumed = false;
+    auto input = [&](const unsigned char **data, ssize_t *length) {
+        if (consumed)
+        {
+            return false;
+        }
+        consumed = true;
+        *data = in;
+        *length = inLength;
+        return true;
+    };
+
+    return inflateToBuffer(input, out, outLength, hint);
+}
+
 ssize_t ZipUtils::inflateMemoryWithHint(unsigned char *in, ssize_t inLength, unsigned char **out, ssize_t outLengthHint)
 {
     ssize_t outLength = 0;
@@ -235,72 +435,72 @@ ssize_t ZipUtils::inflateMemory(unsigned char *in, ssize_t inLength, unsigned ch
 
 int ZipUtils::inflateGZipFile(const char *path, unsigned char **out)
 {
-    int len;
-    unsigned int offset = 0;
-    
     CCASSERT(out, "");
     CCASSERT(&*out, "");
     
-    gzFile inFile = gzopen(path, "rb");
+    FILE *inFile = fopen(path, "rb");
     if( inFile == nullptr ) {
         CCLOG("cocos2d: ZipUtils: error open gzip file: %s", path);
         return -1;
     }
-    
-    /* 512k initial decompress buffer */
-    unsigned int bufferSize = 512 * 1024;
-    unsigned int totalBufferSize = bufferSize;
-    
-    *out = (unsigned char*)malloc( bufferSize );
-    if( ! out )
+
+    unsigned char header[2] = { 0, 0 };
+    size_t headerLength = fread(header, 1, sizeof(header), inFile);
+
+    // gzread passes plain files through untouched, keep doing that
+    if (!isGZipBuffer(header, headerLength))
     {
-        CCLOG("cocos2d: ZipUtils: out of memory");
-        return -1;
-    }
-    
-    for (;;) {
-        len = gzread(inFile, *out + offset, bufferSize);
-        if (len < 0)
+        fseek(inFile, 0, SEEK_END);
+        long size = ftell(inFile);
+        fseek(inFile, 0, SEEK_SET);
+
+        *out = (unsigned char*)malloc(size > 0 ? size : 1);
+        size_t readsize = *out ? fread(*out, 1, size, inFile) : 0;
+        fclose(inFile);
+        if (! *out || readsize != (size_t)size)
         {
-            CCLOG("cocos2d: ZipUtils: error in gzread");
-            free( *out );
+            CCLOG("cocos2d: ZipUtils: error reading file: %s", path);
+            free(*out);
             *out = nullptr;
             return -1;
         }
-        if (len == 0)
-        {
-            break;
-        }
-        
-        offset += len;
-        
-        // finish reading the file
-        if( (unsigned int)len < bufferSize )
-        {
-            break;
-        }
-        
-        bufferSize *= BUFFER_INC_FACTOR;
-        totalBufferSize += bufferSize;
-        unsigned char *tmp = (unsigned char*)realloc(*out, totalBufferSize );
-        
-        if( ! tmp )
+        return (int)size;
+    }
+
+    // size the output from the trailer so the file inflates straight into
+    // its final buffer, the compressed data is read in chunks
+    ssize_t sizeHint = 512 * 1024;
+    unsigned char trailer[4];
+    if (fseek(inFile, -4, SEEK_END) == 0 && fread(trailer, 1, sizeof(trailer), inFile) == sizeof(trailer))
+    {
+        ssize_t size = gzipSizeFromTrailer(trailer, ftell(inFile));
+        if (size > 0)
         {
-            CCLOG("cocos2d: ZipUtils: out of memory");
-            free( *out );
-            *out = nullptr;
-            return -1;
+            sizeHint = size;
         }
-        
-        *out = tmp;
     }
-    
-    if (gzclose(inFile) != Z_OK)
+    fseek(inFile, 0, SEEK_SET);
+
+    unsigned char chunk[32 * 1024];
+    auto input = [&](const unsigned char **data, ssize_t *length) {
+        size_t readsize = fread(chunk, 1, sizeof(chunk), inFile);
+        *data = chunk;
+        *length = readsize;
+        return readsize > 0;
+    };
+
+    ssize_t outLength = 0;
+    int err = inflateToBuffer(input, out, &outLength, sizeHint);
+    fclose(inFile);
+
+    if (err != Z_OK)
     {
-        CCLOG("cocos2d: ZipUtils: gzclose failed");
+        CCLOG("cocos2d: ZipUtils: error inflating gzip file: %s", path);
+        *out = nullptr;
+        return -1;
     }
-    
-    return offset;
+
+    return (int)outLength;
 }
 
 bool ZipUtils::isCCZFile(const char *path)
@@ -429,11 +629,11 @@ int ZipUtils::inflateCCZBuffer(const unsigned char *buffer, ssize_t bufferLen, u
         return -1;
     }
 
-    unsigned long destlen = len;
-    size_t source = (size_t) buffer + sizeof(*header);
-    int ret = uncompress(*out, &destlen, (Bytef*)source, bufferLen - sizeof(*header) );
+    // the header carries the exact size, inflate straight into the texture buffer
+    const unsigned char *source = buffer + sizeof(*header);
+    ssize_t ret = inflateMemoryToBuffer(source, bufferLen - sizeof(*header), *out, len);
 
-    if( ret != Z_OK )
+    if( ret != (ssize_t)len )
     {
         CCLOG("cocos2d: CCZ: Failed to uncompress data");
         free( *out );
@@ -488,22 +688,194 @@ struct ZipEntryInfo
 {
     unz_file_pos pos;
     uLong uncompressed_size;
+    ZPOS64_T compressed_size;
+    uLong compression_method;
+    uLong flag;
+    // offset of the entry's data inside the archive, resolved on first use (0 = unknown)
+    ZPOS64_T data_offset;
 };
 
 class ZipFilePrivate
 {
 public:
+    ZipFilePrivate()
+    : zipFile(nullptr)
+#ifdef CC_ZIPFILE_USE_PREAD
+    , fd(-1)
+#endif
+    {
+    }
+    
     unzFile zipFile;
     
+    // guards zipFile and the lazily resolved data offsets
+    std::mutex zipFileMutex;
+    
+    // read-only mapping of the whole archive, null when it could not be mapped
+    std::shared_ptr<Data> archive;
+    
+#ifdef CC_ZIPFILE_USE_PREAD
+    // used with pread when the archive is not mapped, shared by all threads
+    int fd;
+#endif
+    
     // std::unordered_map is faster if available on the platform
     typedef std::unordered_map<std::string, struct ZipEntryInfo> FileListContainer;
     FileListContainer fileList;
+    
+    // Offset of the entry's data in the archive, 0 if it can't be read
+    // without minizip (encrypted, unknown method, no mapping nor pread).
+    ZPOS64_T getDataOffset(ZipEntryInfo &entry);
+    
+    // Reads and inflates the entry into buffer without touching zipFile,
+    // so any number of threads can do it at the same time.
+    bool readDirect(const ZipEntryInfo &entry, ZPOS64_T offset, unsigned char *buffer);
+    
+    // Reads the entry through the shared minizip handle.
+    unsigned char *readLocked(ZipEntryInfo &entry);
 };
 
+ZPOS64_T ZipFilePrivate::getDataOffset(ZipEntryInfo &entry)
+{
+    if ((entry.flag & 1) != 0 || (entry.compression_method != 0 && entry.compression_method != Z_DEFLATED))
+    {
+        return 0;
+    }
+#ifdef CC_ZIPFILE_USE_PREAD
+    if (!archive && fd < 0)
+#else
+    if (!archive)
+#endif
+    {
+        return 0;
+    }
+    
+    std::lock_guard<std::mutex> lock(zipFileMutex);
+    if (entry.data_offset == 0)
+    {
+        // the local header has a variable length, let minizip parse it once
+        if (UNZ_OK == unzGoToFilePos(zipFile, &entry.pos)
+            && UNZ_OK == unzOpenCurrentFile(zipFile))
+        {
+            entry.data_offset = unzGetCurrentFileZStreamPos64(zipFile);
+            unzCloseCurrentFile(zipFile);
+        }
+    }
+    return entry.data_offset;
+}
+
+bool ZipFilePrivate::readDirect(const ZipEntryInfo &entry, ZPOS64_T offset, unsigned char *buffer)
+{
+    const unsigned char *source = nullptr;
+    unsigned char *compressed = nullptr;
+    if (archive)
+    {
+        if (offset + entry.compressed_size > (ZPOS64_T)archive->getSize())
+        {
+            return false;
+        }
+        source = archive->getBytes() + offset;
+    }
+#ifdef CC_ZIPFILE_USE_PREAD
+    else
+    {
+        // off_t is 32 bits on 32-bit Android builds without large file support,
+        // leave entries it can't address to minizip
+        if (offset + entry.compressed_size > (ZPOS64_T)std::numeric_limits<off_t>::max())
+        {
+            return false;
+        }
+        
+        // stored entries are read straight into the output buffer
+        compressed = (entry.compression_method == 0) ? buffer : (unsigned char*)malloc((size_t)entry.compressed_size);
+        if (pread(fd, compressed, (size_t)entry.compressed_size, (off_t)offset) != (ssize_t)entry.compressed_size)
+        {
+            if (compressed != buffer)
+            {
+                free(compressed);
+            }
+            return false;
+        }
+        source = compressed;
+    }
+#endif
+    
+    bool ok = false;
+    if (entry.compression_method == 0)
+    {
+        ok = entry.compressed_size == entry.uncompressed_size;
+        if (ok && source != buffer)
+        {
+            memcpy(buffer, source, entry.uncompressed_size);
+        }
+    }
+    else
+    {
+        // raw deflate stream, the output size is known
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        if (inflateInit2(&stream, -MAX_WBITS) == Z_OK)
+        {
+            stream.next_in = (Bytef*)source;
+            stream.avail_in = (uInt)entry.compressed_size;
+            stream.next_out = buffer;
+            stream.avail_out = (uInt)entry.uncompressed_size;
+            int err = inflate(&stream, Z_FINISH);
+            ok = err == Z_STREAM_END && stream.total_out == entry.uncompressed_size;
+            inflateEnd(&stream);
+        }
+    }
+    
+    if (compressed && compressed != buffer)
+    {
+        free(compressed);
+    }
+    return ok;
+}
+
+unsigned char *ZipFilePrivate::readLocked(ZipEntryInfo &entry)
+{
+    std::lock_guard<std::mutex> lock(zipFileMutex);
+    
+    unsigned char *buffer = nullptr;
+    do
+    {
+        int nRet = unzGoToFilePos(zipFile, &entry.pos);
+        CC_BREAK_IF(UNZ_OK != nRet);
+        
+        nRet = unzOpenCurrentFile(zipFile);
+        CC_BREAK_IF(UNZ_OK != nRet);
+        
+        buffer = (unsigned char*)malloc(entry.uncompressed_size);
+        int CC_UNUSED nSize = unzReadCurrentFile(zipFile, buffer, static_cast<unsigned int>(entry.uncompressed_size));
+        CCASSERT(nSize == 0 || nSize == (int)entry.uncompressed_size, "the file size is wrong");
+        
+        unzCloseCurrentFile(zipFile);
+    } while (0);
+    
+    return buffer;
+}
+
 ZipFile::ZipFile(const std::string &zipFile, const std::string &filter)
 : _data(new ZipFilePrivate)
 {
     _data->zipFile = unzOpen(zipFile.c_str());
+    if (_data->zipFile)
+    {
+        // a negative mapping threshold turns mapping off for archives as well
+        auto fileUtils = FileUtils::getInstance();
+        Data mapped = fileUtils->getFileMappingThreshold() >= 0 ? fileUtils->getMappedDataFromFile(zipFile) : Data::Null;
+        if (!mapped.isNull())
+        {
+            _data->archive = std::make_shared<Data>(std::move(mapped));
+        }
+#ifdef CC_ZIPFILE_USE_PREAD
+        else
+        {
+            _data->fd = open(zipFile.c_str(), O_RDONLY);
+        }
+#endif
+    }
     setFilter(filter);
 }
 
@@ -513,6 +885,12 @@ ZipFile::~ZipFile()
     {
         unzClose(_data->zipFile);
     }
+#ifdef CC_ZIPFILE_USE_PREAD
+    if (_data && _data->fd >= 0)
+    {
+        close(_data->fd);
+    }
+#endif
 
     CC_SAFE_DELETE(_data);
 }
@@ -525,6 +903,8 @@ bool ZipFile::setFilter(const std::string &filter)
         CC_BREAK_IF(!_data);
         CC_BREAK_IF(!_data->zipFile);
         
+        std::lock_guard<std::mutex> lock(_data->zipFileMutex);
+        
         // clear existing file list
         _data->fileList.clear();
         
@@ -549,6 +929,10 @@ bool ZipFile::setFilter(const std::string &filter)
                     ZipEntryInfo entry;
                     entry.pos = posInfo;
                     entry.uncompressed_size = (uLong)fileInfo.uncompressed_size;
+                    entry.compressed_size = fileInfo.compressed_size;
+                    entry.compression_method = fileInfo.compression_method;
+                    entry.flag = fileInfo.flag;
+                    entry.data_offset = 0;
                     _data->fileList[currentFileName] = entry;
                 }
             }
@@ -587,29 +971,68 @@ unsigned char *ZipFile::getFileData(const std::string &fileName, ssize_t *size)
         CC_BREAK_IF(!_data->zipFile);
         CC_BREAK_IF(fileName.empty());
         
-        ZipFilePrivate::FileListContainer::const_iterator it = _data->fileList.find(fileName);
+        ZipFilePrivate::FileListContainer::iterator it = _data->fileList.find(fileName);
         CC_BREAK_IF(it ==  _data->fileList.end());
         
-        ZipEntryInfo fileInfo = it->second;
-        
-        int nRet = unzGoToFilePos(_data->zipFile, &fileInfo.pos);
-        CC_BREAK_IF(UNZ_OK != nRet);
-        
-        nRet = unzOpenCurrentFile(_data->zipFile);
-        CC_BREAK_IF(UNZ_OK != nRet);
+        ZipEntryInfo &fileInfo = it->second;
         
-        buffer = (unsigned char*)malloc(fileInfo.uncompressed_size);
-        int CC_UNUSED nSize = unzReadCurrentFile(_data->zipFile, buffer, static_cast<unsigned int>(fileInfo.uncompressed_size));
-        CCASSERT(nSize == 0 || nSize == (int)fileInfo.uncompressed_size, "the file size is wrong");
+        // inflate outside of the lock when the data can be reached directly
+        ZPOS64_T offset = _data->getDataOffset(fileInfo);
+        if (offset != 0)
+        {
+            buffer = (unsigned char*)malloc(fileInfo.uncompressed_size);
+            if (!_data->readDirect(fileInfo, offset, buffer))
+            {
+                free(buffer);
+                buffer = nullptr;
+            }
+        }
+        if (!buffer)
+        {
+            buffer = _data->readLocked(fileInfo);
+        }
         
-        if (size)
+        if (buffer && size)
         {
             *size = fileInfo.uncompressed_size;
         }
-        unzCloseCurrentFile(_data->zipFile);
     } while (0);
     
     return buffer;
 }
 
+Data ZipFile::getFileData(const std::string &fileName)
+{
+    Data ret;
+    do
+    {
+        CC_BREAK_IF(!_data->zipFile);
+        CC_BREAK_IF(!_data->archive);
+        CC_BREAK_IF(fileName.empty());
+        
+        ZipFilePrivate::FileListContainer::iterator it = _data->fileList.find(fileName);
+        CC_BREAK_IF(it == _data->fileList.end());
+        
+        // only stored entries can be used in place
+        ZipEntryInfo &fileInfo = it->second;
+        CC_BREAK_IF(fileInfo.compression_method != 0);
+        
+        ZPOS64_T offset = _data->getDataOffset(fileInfo);
+        ZPOS64_T archiveSize = static_cast<ZPOS64_T>(_data->archive->getSize());
+        CC_BREAK_IF(offset == 0 || offset + fileInfo.uncompressed_size > archiveSize);
+        
+        // the entry keeps the mapping alive even after this ZipFile is destroyed
+        ret.setSharedBytes(_data->archive->getBytes() + offset, fileInfo.uncompressed_size, _data->archive);
+        return ret;
+    } while (0);
+    
+    ssize_t size = 0;
+    unsigned char *buffer = getFileData(fileName, &size);
+    if (buffer)
+    {
+        ret.fastSet(buffer, size);
+    }
+    return ret;
+}
+
 NS_CC_END
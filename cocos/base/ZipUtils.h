@@ -26,6 +26,7 @@ THE SOFTWARE.
 #define __SUPPORT_ZIPUTILS_H__
 
 #include <string>
+#include <functional>
 #include "base/CCPlatformConfig.h"
 #include "CCPlatformDefine.h"
 #include "base/CCPlatformMacros.h"
@@ -64,7 +65,7 @@ namespace cocos2d
         *无论是膨胀的zlib或gzip的瘪内存。膨胀的内存
         *由调用者释放。
         *
-        *它会分配256K的目标缓冲区。如果这还不够，将乘2前面的缓冲区大小，直到有足够的存储器。
+        *它会分配256K的目标缓冲区。如果这还不够，超出的部分分块解压，最后合并成一块。
         *@returns 返回瘪缓冲区的长度
         * 
         @since v0.8.1
@@ -76,7 +77,8 @@ namespace cocos2d
         *无论是膨胀的zlib或gzip的瘪内存。膨胀的内存
         *由调用者释放。
         *
-        * outLenghtHint被假定为所需要的空间分配膨胀的缓冲区。
+        * outLenghtHint被假定为所需要的空间分配膨胀的缓冲区。gzip数据会改用文件尾记录的原始长度。
+        *提示准确时直接解压到一块缓冲区; 不够时超出部分分块保存, 最后只拼接一次.
         *
         *@returns 瘪缓冲区的长度
         * 
@@ -85,6 +87,30 @@ namespace cocos2d
         CC_DEPRECATED_ATTRIBUTE static ssize_t ccInflateMemoryWithHint(unsigned char *in, ssize_t inLength, unsigned char **out, ssize_t outLengthHint) { return inflateMemoryWithHint(in, inLength, out, outLengthHint); }
         static ssize_t inflateMemoryWithHint(unsigned char *in, ssize_t inLength, unsigned char **out, ssize_t outLengthHint);
 
+        /** 流式解压的输入回调.
+        *把下一块压缩数据的地址和长度写入 data 和 length, 数据在下一次调用前必须保持有效.
+        *没有更多输入时返回 false.
+        */
+        typedef std::function<bool(const unsigned char **data, ssize_t *length)> InflateInput;
+
+        /** 流式解压的输出回调, 按顺序收到解压后的数据块. 返回 false 会中止解压.
+        */
+        typedef std::function<bool(const unsigned char *data, ssize_t length)> InflateOutput;
+
+        /**流式解压zlib或gzip数据 (自动识别格式)
+        *
+        *压缩数据按块从 input 读取, 解压结果按块交给 output, 两者都不需要整体放在内存里.
+        *
+        *@returns 解压后的总长度, 出错时返回 -1
+        */
+        static ssize_t inflateStream(const InflateInput &input, const InflateOutput &output);
+
+        /**已知解压后大小时的快速路径: 把zlib或gzip数据直接解压到调用者提供的缓冲区, 不分配任何中间内存.
+        *
+        *@returns 解压后的长度. 数据损坏或者 outLength 不够大时返回 -1
+        */
+        static ssize_t inflateMemoryToBuffer(const unsigned char *in, ssize_t inLength, unsigned char *out, ssize_t outLength);
+
         /**膨胀一个gzip文件到内存
         *
         *@returns 瘪缓冲区的长度
@@ -204,6 +230,7 @@ namespace cocos2d
 
     private:
         static int inflateMemoryWithHint(unsigned char *in, ssize_t inLength, unsigned char **out, ssize_t *outLength, ssize_t outLenghtHint);
+        static int inflateToBuffer(const InflateInput &input, unsigned char **out, ssize_t *outLength, ssize_t outLengthHint);
         static inline void decodeEncodedPvr (unsigned int *data, ssize_t len);
         static inline unsigned int checksumPvr(const unsigned int *data, ssize_t len);
 
@@ -214,6 +241,7 @@ namespace cocos2d
 
     // 前向声明
     class ZipFilePrivate;
+    class Data;
 
     /**
      * Zip文件 - 读取的辅助类。
@@ -221,6 +249,9 @@ namespace cocos2d
      *它会缓存特定zip文件列表在压缩文档中的位置，
      *所以这将是更快的读取某些特定的文件或检查他们的存在性。
      *
+     *getFileData 和 fileExists 可以在多个线程中同时调用, 不同的文件会被并行解压;
+     *setFilter 不能与它们同时调用。
+     *
      *@since V2.0.5
      */
     class ZipFile
@@ -270,6 +301,14 @@ namespace cocos2d
         */
         unsigned char *getFileData(const std::string &fileName, ssize_t *size);
 
+        /**
+        *从zip文件获取资源文件的数据, 以 Data 返回。
+        *当zip文件可以被内存映射且该文件以不压缩(stored)方式存储时, 返回的 Data 直接引用映射, 不复制数据。
+        *@param fileName 文件名
+        *@return 失败时返回空的 Data。
+        */
+        Data getFileData(const std::string &fileName);
+
     private:
         /**内部数据如zip文件指针/文件列表数组等等*/
         ZipFilePrivate *_data;
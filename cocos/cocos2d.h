@@ -120,6 +120,7 @@ THE SOFTWARE.
 #include "2d/CCProgressTimer.h"
 #include "2d/CCRenderTexture.h"
 #include "2d/CCNodeGrid.h"
+#include "2d/CCCullingNode.h"
 #include "2d/CCParticleBatchNode.h"
 #include "2d/CCParticleSystem.h"
 #include "2d/CCParticleExamples.h"
@@ -159,6 +160,7 @@ THE SOFTWARE.
 #include "2d/platform/CCFileUtils.h"
 #include "2d/platform/CCImage.h"
 #include "2d/platform/CCSAXParser.h"
+#include "2d/platform/CCPackFile.h"
 #include "2d/platform/CCThread.h"
 #include "base/CCPlatformConfig.h"
 #include "base/CCPlatformMacros.h"
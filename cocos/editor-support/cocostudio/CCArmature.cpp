@@ -455,7 +455,7 @@ void Armature::visit(cocos2d::Renderer *renderer, const Mat4 &parentTransform, b
 
     bool dirty = parentTransformUpdated || _transformUpdated;
     if(dirty)
-        _modelViewTransform = transform(parentTransform);
+        updateModelViewTransform(parentTransform);
     _transformUpdated = false;
 
     // IMPORTANT:
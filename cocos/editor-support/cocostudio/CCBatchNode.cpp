@@ -111,7 +111,7 @@ void BatchNode::visit(Renderer *renderer, const Mat4 &parentTransform, bool pare
 
     bool dirty = parentTransformUpdated || _transformUpdated;
     if(dirty)
-        _modelViewTransform = transform(parentTransform);
+        updateModelViewTransform(parentTransform);
     _transformUpdated = false;
 
     // IMPORTANT:
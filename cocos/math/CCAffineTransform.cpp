@@ -156,6 +156,33 @@ Mat4 TransformConcat(const Mat4& t1, const Mat4& t2)
     return t1 * t2;
 }
 
+bool TransformIsAffine2D(const Mat4& t)
+{
+    const float* m = t.m;
+    return m[2] == 0 && m[3] == 0 && m[6] == 0 && m[7] == 0
+        && m[8] == 0 && m[9] == 0 && m[10] == 1 && m[11] == 0 && m[15] == 1;
+}
+
+void TransformConcatAffine2D(const Mat4& t1, const Mat4& t2, Mat4* dst)
+{
+    const float* p = t1.m;
+    const float* l = t2.m;
+
+    float a  = p[0] * l[0] + p[4] * l[1];
+    float b  = p[1] * l[0] + p[5] * l[1];
+    float c  = p[0] * l[4] + p[4] * l[5];
+    float d  = p[1] * l[4] + p[5] * l[5];
+    float tx = p[0] * l[12] + p[4] * l[13] + p[12];
+    float ty = p[1] * l[12] + p[5] * l[13] + p[13];
+    float tz = p[14] + l[14];
+
+    float* m = dst->m;
+    m[0] = a;   m[1] = b;   m[2] = 0;   m[3] = 0;
+    m[4] = c;   m[5] = d;   m[6] = 0;   m[7] = 0;
+    m[8] = 0;   m[9] = 0;   m[10] = 1;  m[11] = 0;
+    m[12] = tx; m[13] = ty; m[14] = tz; m[15] = 1;
+}
+
 
 /* Return true if `t1' and `t2' are equal, false otherwise. */
 bool AffineTransformEqualToTransform(const AffineTransform& t1, const AffineTransform& t2)
@@ -64,6 +64,11 @@ CC_DLL AffineTransform AffineTransformInvert(const AffineTransform& t);
 
 Mat4 TransformConcat(const Mat4& t1, const Mat4& t2);
 
+/* 矩阵是否只包含 2D 仿射变换 (没有 3D 旋转、Z 缩放和投影)，此时只有 a,b,c,d,tx,ty 和 z 平移有意义 */
+CC_DLL bool TransformIsAffine2D(const Mat4& t);
+/* dst = t1 * t2，t1 和 t2 都必须满足 TransformIsAffine2D()，dst 可以和 t1 或 t2 相同 */
+CC_DLL void TransformConcatAffine2D(const Mat4& t1, const Mat4& t2, Mat4* dst);
+
 extern CC_DLL const AffineTransform AffineTransformIdentity;
 
 NS_CC_END
@@ -20,6 +20,12 @@ This file was modified to fit the cocos2d-x project
 
 #include "MathUtil.h"
 #include "base/ccMacros.h"
+#include "base/ccTypes.h"
+#include "math/Matrix.h"
+
+#if !defined(USE_NEON) && defined(__SSE__)
+#include <xmmintrin.h>
+#endif
 
 NS_CC_MATH_BEGIN
 
@@ -44,4 +50,75 @@ void MathUtil::smooth(float* x, float target, float elapsedTime, float riseTime,
     }
 }
 
+void MathUtil::transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count, const Mat4& transform)
+{
+    GP_ASSERT(count == 0 || (dst && src));
+
+    const float* m = transform.m;
+    const V3F_C4B_T2F* end = src + count;
+
+    // 2D affine matrix (no 3D rotation, z scale or projection): 4 multiplies per vertex
+    if (m[2] == 0 && m[3] == 0 && m[6] == 0 && m[7] == 0
+        && m[8] == 0 && m[9] == 0 && m[10] == 1 && m[11] == 0 && m[15] == 1)
+    {
+        const float a = m[0], b = m[1], c = m[4], d = m[5];
+        const float tx = m[12], ty = m[13], tz = m[14];
+
+        for (; src < end; ++src, ++dst)
+        {
+            float x = src->vertices.x, y = src->vertices.y;
+            dst->colors = src->colors;
+            dst->texCoords = src->texCoords;
+            dst->vertices.x = a * x + c * y + tx;
+            dst->vertices.y = b * x + d * y + ty;
+            dst->vertices.z = src->vertices.z + tz;
+        }
+        return;
+    }
+
+#if defined(USE_NEON)
+    for (; src < end; ++src, ++dst)
+    {
+        float x = src->vertices.x, y = src->vertices.y, z = src->vertices.z;
+        dst->colors = src->colors;
+        dst->texCoords = src->texCoords;
+        transformVec4(m, x, y, z, 1.0f, &dst->vertices.x);
+    }
+#elif defined(__SSE__)
+    // Columns of the matrix stay in registers for the whole run
+    const __m128 c0 = _mm_loadu_ps(m);
+    const __m128 c1 = _mm_loadu_ps(m + 4);
+    const __m128 c2 = _mm_loadu_ps(m + 8);
+    const __m128 c3 = _mm_loadu_ps(m + 12);
+
+    for (; src < end; ++src, ++dst)
+    {
+        __m128 r = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(src->vertices.x)), c3);
+        r = _mm_add_ps(_mm_mul_ps(c1, _mm_set1_ps(src->vertices.y)), r);
+        r = _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(src->vertices.z)), r);
+
+        dst->colors = src->colors;
+        dst->texCoords = src->texCoords;
+        _mm_storel_pi((__m64*)&dst->vertices.x, r);
+        _mm_store_ss(&dst->vertices.z, _mm_movehl_ps(r, r));
+    }
+#else
+    // Copy the matrix so the compiler knows it does not alias dst
+    const float m0 = m[0], m1 = m[1], m2 = m[2];
+    const float m4 = m[4], m5 = m[5], m6 = m[6];
+    const float m8 = m[8], m9 = m[9], m10 = m[10];
+    const float m12 = m[12], m13 = m[13], m14 = m[14];
+
+    for (; src < end; ++src, ++dst)
+    {
+        float x = src->vertices.x, y = src->vertices.y, z = src->vertices.z;
+        dst->colors = src->colors;
+        dst->texCoords = src->texCoords;
+        dst->vertices.x = x * m0 + y * m4 + z * m8 + m12;
+        dst->vertices.y = x * m1 + y * m5 + z * m9 + m13;
+        dst->vertices.z = x * m2 + y * m6 + z * m10 + m14;
+    }
+#endif
+}
+
 NS_CC_MATH_END
@@ -25,6 +25,9 @@
 
 NS_CC_MATH_BEGIN
 
+class Mat4;
+struct V3F_C4B_T2F;
+
 /**
  * 定义一个数学工具类
  *
@@ -64,6 +67,18 @@ public:
      */
     static void smooth(float* x, float target, float elapsedTime, float riseTime, float fallTime);
 
+    /**
+     * 将 src 中的 count 个顶点用给定矩阵变换到 dst 中，颜色和纹理坐标原样复制。
+     * 2D 仿射矩阵只计算 x/y 的 2x2 部分和平移；其他矩阵在支持的平台上使用 SSE 或 NEON 实现，否则使用标量实现。
+     * src 和 dst 可以指向同一块内存。
+     *
+     * @param dst 目标顶点数组。
+     * @param src 源顶点数组。
+     * @param count 顶点数量。
+     * @param transform 变换矩阵。
+     */
+    static void transformVertices(V3F_C4B_T2F* dst, const V3F_C4B_T2F* src, size_t count, const Mat4& transform);
+
 private:
 
     inline static void addMatrix(const float* m, float scalar, float* dst);
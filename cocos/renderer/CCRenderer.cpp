@@ -30,6 +30,7 @@
 #include "renderer/CCBatchCommand.h"
 #include "renderer/CCCustomCommand.h"
 #include "renderer/CCGroupCommand.h"
+#include "renderer/CCStreamBuffer.h"
 #include "renderer/CCGLProgramCache.h"
 #include "renderer/ccGLStateCache.h"
 #include "base/CCConfiguration.h"
@@ -37,6 +38,8 @@
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventType.h"
+#include "base/CCThreadPool.h"
+#include "math/MathUtil.h"
 
 NS_CC_BEGIN
 
@@ -71,6 +74,131 @@ void RenderQueue::sort()
     std::sort(std::begin(_queuePosZ), std::end(_queuePosZ), compareRenderCommand);
 }
 
+// how many commands a QuadCommand may be moved back to join a batch with the same material
+static const size_t MATERIAL_SORT_LOOKBACK = 32;
+
+// Computes the world space xy bounds of the quads. Returns false when the quads
+// are not flat at z == 0 in world space, their xy bounds say nothing about the
+// drawing order then.
+static bool getQuadCommandBounds(const QuadCommand* cmd, Rect* bounds)
+{
+    // z in world space is m[2] * x + m[6] * y + m[10] * z + m[14]
+    const Mat4& mv = cmd->getModelView();
+    if (mv.m[2] != 0 || mv.m[6] != 0 || mv.m[14] != 0)
+        return false;
+
+    // bounds of the quads in model space
+    auto vertices = reinterpret_cast<const V3F_C4B_T2F*>(cmd->getQuads());
+    ssize_t count = cmd->getQuadCount() * 4;
+    if (count <= 0)
+    {
+        *bounds = Rect::ZERO;
+        return true;
+    }
+
+    float minX = vertices[0].vertices.x, maxX = minX;
+    float minY = vertices[0].vertices.y, maxY = minY;
+    for (ssize_t i = 0; i < count; ++i)
+    {
+        if (vertices[i].vertices.z != 0)
+            return false;
+        minX = std::min(minX, vertices[i].vertices.x);
+        maxX = std::max(maxX, vertices[i].vertices.x);
+        minY = std::min(minY, vertices[i].vertices.y);
+        maxY = std::max(maxY, vertices[i].vertices.y);
+    }
+
+    // transform the corners to world space
+    Vec3 corners[4] = { Vec3(minX, minY, 0), Vec3(maxX, minY, 0), Vec3(minX, maxY, 0), Vec3(maxX, maxY, 0) };
+    mv.transformPoint(&corners[0]);
+    minX = maxX = corners[0].x;
+    minY = maxY = corners[0].y;
+    for (int i = 1; i < 4; ++i)
+    {
+        mv.transformPoint(&corners[i]);
+        minX = std::min(minX, corners[i].x);
+        maxX = std::max(maxX, corners[i].x);
+        minY = std::min(minY, corners[i].y);
+        maxY = std::max(maxY, corners[i].y);
+    }
+    *bounds = Rect(minX, minY, maxX - minX, maxY - minY);
+    return true;
+}
+
+static void reorderRunByMaterial(std::vector<RenderCommand*>& queue, size_t begin, size_t end,
+                                 std::vector<RenderCommand*>& reordered, std::vector<Rect>& bounds, std::vector<bool>& movable)
+{
+    reordered.clear();
+    bounds.clear();
+    movable.clear();
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        auto command = queue[i];
+        size_t insertAt = reordered.size();
+        Rect commandBounds;
+        bool commandMovable = false;
+
+        // only flat, batchable QuadCommands take part. Everything else keeps its
+        // place and nothing is moved across it
+        if (command->getType() == RenderCommand::Type::QUAD_COMMAND)
+        {
+            auto cmd = static_cast<QuadCommand*>(command);
+            uint32_t materialID = cmd->getMaterialID();
+            commandMovable = materialID != QuadCommand::MATERIAL_ID_DO_NOT_BATCH && getQuadCommandBounds(cmd, &commandBounds);
+            if (commandMovable)
+            {
+                // Walk back over the commands this one would be drawn before. Stop at anything
+                // that can't be moved or that overlaps it, since the order would then be visible.
+                for (size_t k = reordered.size(); k > 0 && reordered.size() - k < MATERIAL_SORT_LOOKBACK; --k)
+                {
+                    if (!movable[k - 1])
+                        break;
+                    if (static_cast<QuadCommand*>(reordered[k - 1])->getMaterialID() == materialID)
+                    {
+                        insertAt = k;
+                        break;
+                    }
+                    if (bounds[k - 1].intersectsRect(commandBounds))
+                        break;
+                }
+            }
+        }
+
+        reordered.insert(reordered.begin() + insertAt, command);
+        bounds.insert(bounds.begin() + insertAt, commandBounds);
+        movable.insert(movable.begin() + insertAt, commandMovable);
+    }
+
+    std::copy(reordered.begin(), reordered.end(), queue.begin() + begin);
+}
+
+static void reorderQueueByMaterial(std::vector<RenderCommand*>& queue)
+{
+    std::vector<RenderCommand*> reordered;
+    std::vector<Rect> bounds;
+    std::vector<bool> movable;
+
+    // only commands with the same global order may be reordered
+    size_t runStart = 0;
+    for (size_t i = 1; i <= queue.size(); ++i)
+    {
+        if (i == queue.size() || queue[i]->getGlobalOrder() != queue[runStart]->getGlobalOrder())
+        {
+            if (i - runStart > 1)
+                reorderRunByMaterial(queue, runStart, i, reordered, bounds, movable);
+            runStart = i;
+        }
+    }
+}
+
+void RenderQueue::reorderByMaterial()
+{
+    reorderQueueByMaterial(_queueNegZ);
+    reorderQueueByMaterial(_queue0);
+    reorderQueueByMaterial(_queuePosZ);
+}
+
 RenderCommand* RenderQueue::operator[](ssize_t index) const
 {
     if(index < static_cast<ssize_t>(_queueNegZ.size()))
@@ -107,8 +235,11 @@ static const int DEFAULT_RENDER_QUEUE = 0;
 //
 Renderer::Renderer()
 :_lastMaterialID(0)
+,_vertexStream(nullptr)
 ,_numQuads(0)
 ,_glViewAssigned(false)
+,_parallelQuadFill(false)
+,_materialSorting(false)
 ,_isRendering(false)
 #if CC_ENABLE_CACHE_TEXTURE_DATA
 ,_cacheTextureListener(nullptr)
@@ -121,6 +252,7 @@ Renderer::Renderer()
     RenderQueue defaultRenderQueue;
     _renderGroups.push_back(defaultRenderQueue);
     _batchedQuadCommands.reserve(BATCH_QUADCOMMAND_RESEVER_SIZE);
+    _batchedQuadOffsets.reserve(BATCH_QUADCOMMAND_RESEVER_SIZE);
 }
 
 Renderer::~Renderer()
@@ -128,7 +260,8 @@ Renderer::~Renderer()
     _renderGroups.clear();
     _groupCommandManager->release();
     
-    glDeleteBuffers(2, _buffersVBO);
+    CC_SAFE_DELETE(_vertexStream);
+    glDeleteBuffers(1, &_indicesVBO);
     
     if (Configuration::getInstance()->supportsShareableVAO())
     {
@@ -173,6 +306,15 @@ void Renderer::setupIndices()
 
 void Renderer::setupBuffer()
 {
+    if (_vertexStream)
+    {
+        _vertexStream->recreate();
+    }
+    else
+    {
+        _vertexStream = new StreamBuffer(GL_ARRAY_BUFFER, sizeof(_quads[0]) * VBO_SIZE);
+    }
+
     if(Configuration::getInstance()->supportsShareableVAO())
     {
         setupVBOAndVAO();
@@ -188,24 +330,14 @@ void Renderer::setupVBOAndVAO()
     glGenVertexArrays(1, &_quadVAO);
     GL::bindVAO(_quadVAO);
 
-    glGenBuffers(2, &_buffersVBO[0]);
-
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * VBO_SIZE, _quads, GL_DYNAMIC_DRAW);
+    glGenBuffers(1, &_indicesVBO);
 
-    // vertices
+    // the attribute pointers are set on every flush, they depend on where the quads land in the stream
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
-
-    // colors
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, colors));
-
-    // tex coords
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indicesVBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * VBO_SIZE * 6, _indices, GL_STATIC_DRAW);
 
     // Must unbind the VAO before changing the element buffer.
@@ -218,7 +350,7 @@ void Renderer::setupVBOAndVAO()
 
 void Renderer::setupVBO()
 {
-    glGenBuffers(2, &_buffersVBO[0]);
+    glGenBuffers(1, &_indicesVBO);
 
     mapBuffers();
 }
@@ -228,17 +360,27 @@ void Renderer::mapBuffers()
     // Avoid changing the element buffer for whatever VAO might be bound.
     GL::bindVAO(0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * VBO_SIZE, _quads, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indicesVBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * VBO_SIZE * 6, _indices, GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
     CHECK_GL_ERROR_DEBUG();
 }
 
+void Renderer::setupQuadVertexAttribs(GLintptr offset)
+{
+    const GLsizei stride = sizeof(V3F_C4B_T2F);
+
+    // vertices
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*) (offset + offsetof(V3F_C4B_T2F, vertices)));
+
+    // colors
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (GLvoid*) (offset + offsetof(V3F_C4B_T2F, colors)));
+
+    // tex coords
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*) (offset + offsetof(V3F_C4B_T2F, texCoords)));
+}
+
 void Renderer::addCommand(RenderCommand* command)
 {
     int renderQueue =_commandGroupStack.top();
@@ -283,19 +425,26 @@ void Renderer::visitRenderQueue(const RenderQueue& queue)
         if(RenderCommand::Type::QUAD_COMMAND == commandType)
         {
             auto cmd = static_cast<QuadCommand*>(command);
+            CCASSERT(cmd->getQuadCount() >= 0, "Invalid quad count");
+
+            //Commands bigger than the VBO are streamed on their own, VBO_SIZE quads at a time
+            if(cmd->getQuadCount() > VBO_SIZE)
+            {
+                flush();
+                drawQuadCommandInChunks(cmd);
+                continue;
+            }
+
             //Batch quads
             if(_numQuads + cmd->getQuadCount() > VBO_SIZE)
             {
-                CCASSERT(cmd->getQuadCount()>= 0 && cmd->getQuadCount() < VBO_SIZE, "VBO is not big enough for quad data, please break the quad data down or use customized render command");
-                
                 //Draw batched quads if VBO is full
                 drawBatchedQuads();
             }
             
+            //The quads are transformed right before they are uploaded
             _batchedQuadCommands.push_back(cmd);
-            
-            memcpy(_quads + _numQuads, cmd->getQuads(), sizeof(V3F_C4B_T2F_Quad) * cmd->getQuadCount());
-            convertToWorldCoordinates(_quads + _numQuads, cmd->getQuadCount(), cmd->getModelView());
+            _batchedQuadOffsets.push_back(_numQuads);
             
             _numQuads += cmd->getQuadCount();
 
@@ -343,6 +492,8 @@ void Renderer::render()
         for (auto &renderqueue : _renderGroups)
         {
             renderqueue.sort();
+            if (_materialSorting)
+                renderqueue.reorderByMaterial();
         }
         visitRenderQueue(_renderGroups[0]);
         flush();
@@ -366,30 +517,113 @@ void Renderer::clean()
 
     // Clear batch quad commands
     _batchedQuadCommands.clear();
+    _batchedQuadOffsets.clear();
     _numQuads = 0;
 
     _lastMaterialID = 0;
 }
 
-void Renderer::convertToWorldCoordinates(V3F_C4B_T2F_Quad* quads, ssize_t quantity, const Mat4& modelView)
+void Renderer::transformQuads(V3F_C4B_T2F_Quad* dst, const V3F_C4B_T2F_Quad* src, ssize_t count, const Mat4& modelView)
+{
+    // Small runs are not worth waking up the workers
+    static const ssize_t MIN_QUADS_PER_JOB = 256;
+
+    if (!_parallelQuadFill || count < MIN_QUADS_PER_JOB * 2)
+    {
+        MathUtil::transformVertices(&dst->tl, &src->tl, count * 4, modelView);
+        return;
+    }
+
+    ThreadPool::getInstance()->parallelFor(count, MIN_QUADS_PER_JOB, [=, &modelView](ssize_t begin, ssize_t end){
+        MathUtil::transformVertices(&dst[begin].tl, &src[begin].tl, (end - begin) * 4, modelView);
+    });
+}
+
+void Renderer::fillBatchedQuads(V3F_C4B_T2F_Quad* dst)
+{
+    // Small batches are not worth waking up the workers
+    static const ssize_t MIN_QUADS_PER_JOB = 256;
+
+    if (!_parallelQuadFill)
+    {
+        for (size_t i = 0; i < _batchedQuadCommands.size(); ++i)
+        {
+            auto cmd = _batchedQuadCommands[i];
+            MathUtil::transformVertices(&dst[_batchedQuadOffsets[i]].tl, &cmd->getQuads()->tl, cmd->getQuadCount() * 4, cmd->getModelView());
+        }
+        return;
+    }
+
+    // Split by quads rather than by commands so one big command (e.g. a particle system)
+    // is spread over all the workers as well
+    ThreadPool::getInstance()->parallelFor(_numQuads, MIN_QUADS_PER_JOB, [this, dst](ssize_t begin, ssize_t end){
+        auto it = std::upper_bound(_batchedQuadOffsets.begin(), _batchedQuadOffsets.end(), begin);
+        ssize_t index = (it - _batchedQuadOffsets.begin()) - 1;
+
+        while (begin < end)
+        {
+            auto cmd = _batchedQuadCommands[index];
+            ssize_t cmdStart = _batchedQuadOffsets[index];
+            ssize_t from = begin - cmdStart;
+            ssize_t to = std::min(end - cmdStart, cmd->getQuadCount());
+
+            MathUtil::transformVertices(&dst[begin].tl, &cmd->getQuads()[from].tl, (to - from) * 4, cmd->getModelView());
+
+            begin = cmdStart + to;
+            ++index;
+        }
+    });
+}
+
+void Renderer::drawQuadCommandInChunks(QuadCommand* cmd)
 {
-//    kmMat4 matrixP, mvp;
-//    kmGLGetMatrix(KM_GL_PROJECTION, &matrixP);
-//    kmMat4Multiply(&mvp, &matrixP, &modelView);
-    for(ssize_t i=0; i<quantity; ++i)
+    const bool useVAO = Configuration::getInstance()->supportsShareableVAO();
+    const ssize_t total = cmd->getQuadCount();
+
+    cmd->useMaterial();
+    _lastMaterialID = cmd->getMaterialID();
+
+    for (ssize_t start = 0; start < total; start += VBO_SIZE)
     {
-        V3F_C4B_T2F_Quad *q = &quads[i];
-        Vec3 *vec1 = (Vec3*)&q->bl.vertices;
-        modelView.transformPoint(vec1);
+        ssize_t count = std::min((ssize_t)VBO_SIZE, total - start);
+        GLsizeiptr size = sizeof(_quads[0]) * count;
+        GLintptr offset = 0;
 
-        Vec3 *vec2 = (Vec3*)&q->br.vertices;
-        modelView.transformPoint(vec2);
+        if (useVAO)
+        {
+            //Transform straight into the stream, no copy through _quads
+            auto buf = static_cast<V3F_C4B_T2F_Quad*>(_vertexStream->map(size, &offset));
+            transformQuads(buf, cmd->getQuads() + start, count, cmd->getModelView());
+            _vertexStream->unmap();
+
+            GL::bindVAO(_quadVAO);
+            setupQuadVertexAttribs(offset);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        else
+        {
+            transformQuads(_quads, cmd->getQuads() + start, count, cmd->getModelView());
+            offset = _vertexStream->update(_quads, size);
 
-        Vec3 *vec3 = (Vec3*)&q->tr.vertices;
-        modelView.transformPoint(vec3);
+            GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
+            setupQuadVertexAttribs(offset);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indicesVBO);
+        }
 
-        Vec3 *vec4 = (Vec3*)&q->tl.vertices;
-        modelView.transformPoint(vec4);
+        //Every chunk starts at vertex 0 of its region, so the shared indices work for all of them
+        glDrawElements(GL_TRIANGLES, (GLsizei) count*6, GL_UNSIGNED_SHORT, 0);
+        _drawnBatches++;
+        _drawnVertices += count*6;
+    }
+
+    if (useVAO)
+    {
+        GL::bindVAO(0);
+    }
+    else
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 }
 
@@ -406,47 +640,31 @@ void Renderer::drawBatchedQuads()
         return;
     }
 
+    const GLsizeiptr quadsSize = sizeof(_quads[0]) * _numQuads;
+    GLintptr offset = 0;
+
     if (Configuration::getInstance()->supportsShareableVAO())
     {
-        //Set VBO data
-        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-
-        // option 1: subdata
-//        glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0])*start, sizeof(_quads[0]) * n , &_quads[start] );
-
-        // option 2: data
-//        glBufferData(GL_ARRAY_BUFFER, sizeof(quads_[0]) * (n-start), &quads_[start], GL_DYNAMIC_DRAW);
+        //Stream the quads into the next free region of the vertex stream
+        void *buf = _vertexStream->map(quadsSize, &offset);
+        fillBatchedQuads(static_cast<V3F_C4B_T2F_Quad*>(buf));
+        _vertexStream->unmap();
 
-        // option 3: orphaning + glMapBuffer
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * (_numQuads), nullptr, GL_DYNAMIC_DRAW);
-        void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-        memcpy(buf, _quads, sizeof(_quads[0])* (_numQuads));
-        glUnmapBuffer(GL_ARRAY_BUFFER);
+        //Bind VAO and point it at the region
+        GL::bindVAO(_quadVAO);
+        setupQuadVertexAttribs(offset);
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-        //Bind VAO
-        GL::bindVAO(_quadVAO);
     }
     else
     {
-#define kQuadSize sizeof(_quads[0].bl)
-        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_quads[0]) * _numQuads , _quads, GL_DYNAMIC_DRAW);
+        fillBatchedQuads(_quads);
+        offset = _vertexStream->update(_quads, quadsSize);
 
         GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
+        setupQuadVertexAttribs(offset);
 
-        // vertices
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, vertices));
-
-        // colors
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, colors));
-
-        // tex coords
-        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indicesVBO);
     }
 
     //Start drawing verties in batch
@@ -494,6 +712,7 @@ void Renderer::drawBatchedQuads()
     }
 
     _batchedQuadCommands.clear();
+    _batchedQuadOffsets.clear();
     _numQuads = 0;
 }
 
@@ -37,6 +37,7 @@ NS_CC_BEGIN
 
 class EventListenerCustom;
 class QuadCommand;
+class StreamBuffer;
 
 /** 该类知道如何排序 `RenderCommand` 对象.
  `z == 0`的命令被压人正确的位置，只有`z < 0` 和 `z > 0`的`RenderCommand`对象需要排序.
@@ -47,6 +48,10 @@ public:
     void push_back(RenderCommand* command);
     ssize_t size() const;
     void sort();
+    /** 在 globalZOrder 相同的命令中, 把材质相同且互不遮挡的 QuadCommand 排到一起, 以减少批绘制次数.
+     只有屏幕包围盒不相交的命令才会交换顺序, 所以绘制结果不变.
+     */
+    void reorderByMaterial();
     RenderCommand* operator[](ssize_t index) const;
     void clear();
 
@@ -112,9 +117,26 @@ public:
 
     inline GroupCommandManager* getGroupCommandManager() const { return _groupCommandManager; };
 
+    /** 返回渲染器用来上传每帧顶点数据的 GL_ARRAY_BUFFER 环形缓冲区.
+     其他需要每帧上传动态顶点数据的节点也可以使用它, 以避免各自重新分配缓冲区.
+     */
+    inline StreamBuffer* getVertexStream() const { return _vertexStream; }
+
     /** 返回矩形区域是否可见 */
     bool checkVisibility(const Mat4& transform, const Size& size);
 
+    /** 开启后, 每次批绘制前由 `ThreadPool` 的工作线程并行地把 QuadCommand 的顶点变换到世界坐标,
+     并直接写入映射的顶点缓冲区, GL 线程只负责提交绘制. 默认关闭.
+     */
+    void setParallelQuadFillEnabled(bool enabled) { _parallelQuadFill = enabled; }
+    bool isParallelQuadFillEnabled() const { return _parallelQuadFill; }
+
+    /** 开启后, 每帧排序时会调用 `RenderQueue::reorderByMaterial`, 把可以合批的 QuadCommand 排到一起.
+     可以通过 getDrawnBatches() 观察效果. 默认关闭.
+     */
+    void setMaterialSortingEnabled(bool enabled) { _materialSorting = enabled; }
+    bool isMaterialSortingEnabled() const { return _materialSorting; }
+
 protected:
 
     void setupIndices();
@@ -123,6 +145,8 @@ protected:
     void setupVBOAndVAO();
     void setupVBO();
     void mapBuffers();
+    //把顶点属性指向顶点流中 offset 处的 quads
+    void setupQuadVertexAttribs(GLintptr offset);
 
     void drawBatchedQuads();
 
@@ -131,7 +155,12 @@ protected:
     
     void visitRenderQueue(const RenderQueue& queue);
 
-    void convertToWorldCoordinates(V3F_C4B_T2F_Quad* quads, ssize_t quantity, const Mat4& modelView);
+    //把 count 个 quads 变换到世界坐标并写入 dst, 开启并行填充时使用工作线程
+    void transformQuads(V3F_C4B_T2F_Quad* dst, const V3F_C4B_T2F_Quad* src, ssize_t count, const Mat4& modelView);
+    //把当前批次的所有 quads 变换到世界坐标并写入 dst
+    void fillBatchedQuads(V3F_C4B_T2F_Quad* dst);
+    //绘制超过 VBO_SIZE 的 QuadCommand, 每次从顶点流中映射 VBO_SIZE 个 quads
+    void drawQuadCommandInChunks(QuadCommand* cmd);
 
     std::stack<int> _commandGroupStack;
     
@@ -140,16 +169,22 @@ protected:
     uint32_t _lastMaterialID;
 
     std::vector<QuadCommand*> _batchedQuadCommands;
+    //每个批处理命令的第一个 quad 在批次中的位置
+    std::vector<ssize_t> _batchedQuadOffsets;
 
     V3F_C4B_T2F_Quad _quads[VBO_SIZE];
     GLushort _indices[6 * VBO_SIZE];
     GLuint _quadVAO;
-    GLuint _buffersVBO[2]; //0: vertex  1: indices
+    GLuint _indicesVBO;
+    StreamBuffer* _vertexStream;
 
     int _numQuads;
     
     bool _glViewAssigned;
 
+    bool _parallelQuadFill;
+    bool _materialSorting;
+
     // stats
     ssize_t _drawnBatches;
     ssize_t _drawnVertices;
@@ -0,0 +1,189 @@
+/****************************************************************************
+ Copyright (c) 2014 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "renderer/CCStreamBuffer.h"
+
+#include "base/CCConfiguration.h"
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+// allocations are aligned so vertex attribute offsets stay aligned too
+static const GLintptr STREAM_BUFFER_ALIGNMENT = 16;
+
+StreamBuffer::StreamBuffer(GLenum target, GLsizeiptr segmentSize)
+: _target(target)
+, _buffer(0)
+, _segmentSize(segmentSize)
+, _offset(0)
+, _useMapRange(false)
+, _useFences(false)
+{
+#if CC_STREAM_BUFFER_USE_MAP_RANGE
+    _useMapRange = Configuration::getInstance()->supportsMapBufferRange();
+    _useFences = _useMapRange && Configuration::getInstance()->supportsFenceSync();
+    for (int i = 0; i < SEGMENT_COUNT; ++i)
+        _fences[i] = nullptr;
+#endif
+    for (int i = 0; i < SEGMENT_COUNT; ++i)
+        _pendingSegments[i] = false;
+
+    createBuffer();
+}
+
+StreamBuffer::~StreamBuffer()
+{
+#if CC_STREAM_BUFFER_USE_MAP_RANGE
+    for (int i = 0; i < SEGMENT_COUNT; ++i)
+    {
+        if (_fences[i])
+            glDeleteSync(_fences[i]);
+    }
+#endif
+    glDeleteBuffers(1, &_buffer);
+}
+
+void StreamBuffer::recreate()
+{
+    // the old objects died with the context, don't delete them
+#if CC_STREAM_BUFFER_USE_MAP_RANGE
+    for (int i = 0; i < SEGMENT_COUNT; ++i)
+        _fences[i] = nullptr;
+#endif
+    for (int i = 0; i < SEGMENT_COUNT; ++i)
+        _pendingSegments[i] = false;
+    _offset = 0;
+
+    createBuffer();
+}
+
+void StreamBuffer::createBuffer()
+{
+    glGenBuffers(1, &_buffer);
+    if (_useMapRange)
+    {
+        glBindBuffer(_target, _buffer);
+        glBufferData(_target, _segmentSize * SEGMENT_COUNT, nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(_target, 0);
+    }
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
+void StreamBuffer::waitForSegments(GLintptr start, GLsizeiptr size)
+{
+#if CC_STREAM_BUFFER_USE_MAP_RANGE
+    int first = (int)(start / _segmentSize);
+    int last = (int)((start + size - 1) / _segmentSize);
+
+    // Segments written before that this allocation doesn't continue into are done:
+    // everything that reads them has been issued, so fence them now.
+    for (int i = 0; i < SEGMENT_COUNT; ++i)
+    {
+        if (_pendingSegments[i] && (i < first || i > last))
+        {
+            _fences[i] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            _pendingSegments[i] = false;
+        }
+    }
+
+    // Segments we are about to enter may still be read by the GPU
+    for (int i = first; i <= last; ++i)
+    {
+        if (_fences[i])
+        {
+            GLenum result;
+            do
+            {
+                result = glClientWaitSync(_fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+            } while (result == GL_TIMEOUT_EXPIRED);
+            CCASSERT(result != GL_WAIT_FAILED, "glClientWaitSync failed");
+
+            glDeleteSync(_fences[i]);
+            _fences[i] = nullptr;
+        }
+        _pendingSegments[i] = true;
+    }
+#endif
+}
+
+void* StreamBuffer::map(GLsizeiptr size, GLintptr* offset)
+{
+    CCASSERT(size > 0 && size <= _segmentSize, "Invalid size for StreamBuffer::map");
+
+    glBindBuffer(_target, _buffer);
+
+#if CC_STREAM_BUFFER_USE_MAP_RANGE
+    if (_useMapRange)
+    {
+        GLintptr start = (_offset + STREAM_BUFFER_ALIGNMENT - 1) & ~(STREAM_BUFFER_ALIGNMENT - 1);
+        GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+
+        if (start + size > _segmentSize * SEGMENT_COUNT)
+        {
+            start = 0;
+            // without fences the only safe way to reuse the storage is to orphan it
+            if (!_useFences)
+                access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+        }
+
+        if (_useFences)
+            waitForSegments(start, size);
+
+        _offset = start + size;
+        *offset = start;
+        return glMapBufferRange(_target, start, size, access);
+    }
+#endif
+
+    // fallback: orphan the buffer on every allocation
+    glBufferData(_target, size, nullptr, GL_DYNAMIC_DRAW);
+    *offset = 0;
+    return glMapBuffer(_target, GL_WRITE_ONLY);
+}
+
+void StreamBuffer::unmap()
+{
+    glUnmapBuffer(_target);
+}
+
+GLintptr StreamBuffer::update(const void* data, GLsizeiptr size)
+{
+    GLintptr offset = 0;
+    if (_useMapRange)
+    {
+        void* buf = map(size, &offset);
+        memcpy(buf, data, size);
+        unmap();
+    }
+    else
+    {
+        // glMapBuffer is not always available without VAO support, upload directly
+        glBindBuffer(_target, _buffer);
+        glBufferData(_target, size, data, GL_DYNAMIC_DRAW);
+    }
+    return offset;
+}
+
+NS_CC_END
@@ -0,0 +1,92 @@
+/****************************************************************************
+ Copyright (c) 2014 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_STREAM_BUFFER_H_
+#define __CC_STREAM_BUFFER_H_
+
+#include "base/CCPlatformMacros.h"
+#include "CCGL.h"
+
+// glMapBufferRange 和同步对象只在这些平台的 GL 头文件中有声明, 其他平台使用 glBufferData 重新分配的方式
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX) || (CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
+#define CC_STREAM_BUFFER_USE_MAP_RANGE 1
+#else
+#define CC_STREAM_BUFFER_USE_MAP_RANGE 0
+#endif
+
+NS_CC_BEGIN
+
+/** 用于每帧上传动态顶点数据的环形缓冲区.
+
+ 每次分配都写到上一次分配之后, 使用 GL_MAP_UNSYNCHRONIZED_BIT 映射, 所以不会等待 GPU.
+ 缓冲区被分成 SEGMENT_COUNT 段, 离开某一段时插入一个 fence, 再次写入这一段之前等待它完成.
+ 不支持同步对象时, 回绕时重新分配(orphan)整个缓冲区;
+ 连 glMapBufferRange 也不支持时, 每次分配都使用 glBufferData 重新分配, 偏移总是 0.
+ */
+class CC_DLL StreamBuffer
+{
+public:
+    static const int SEGMENT_COUNT = 4;
+
+    /** 创建一个绑定到 target 的流缓冲区, 单次分配最多 segmentSize 字节 */
+    StreamBuffer(GLenum target, GLsizeiptr segmentSize);
+    ~StreamBuffer();
+
+    /** 在 GL 上下文丢失后重新创建缓冲区 (例如 Android 回到前台时) */
+    void recreate();
+
+    /** 映射 size 字节, 返回可写指针, offset 返回这块区域在缓冲区中的字节偏移.
+     调用后 getBuffer() 绑定在 target 上. 写完后必须调用 unmap().
+     */
+    void* map(GLsizeiptr size, GLintptr* offset);
+    void unmap();
+
+    /** 把 data 的 size 个字节上传到缓冲区, 返回字节偏移 */
+    GLintptr update(const void* data, GLsizeiptr size);
+
+    inline GLuint getBuffer() const { return _buffer; }
+    inline GLenum getTarget() const { return _target; }
+    /** 单次分配的最大字节数 */
+    inline GLsizeiptr getMaxAllocationSize() const { return _segmentSize; }
+
+protected:
+    void createBuffer();
+    void waitForSegments(GLintptr start, GLsizeiptr size);
+
+    GLenum _target;
+    GLuint _buffer;
+    GLsizeiptr _segmentSize;
+    GLintptr _offset;
+    bool _useMapRange;
+    bool _useFences;
+    // 上一次 fence 之后被写入过的段
+    bool _pendingSegments[SEGMENT_COUNT];
+#if CC_STREAM_BUFFER_USE_MAP_RANGE
+    GLsync _fences[SEGMENT_COUNT];
+#endif
+};
+
+NS_CC_END
+
+#endif //__CC_STREAM_BUFFER_H_
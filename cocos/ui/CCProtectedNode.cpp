@@ -278,7 +278,7 @@ void ProtectedNode::visit(Renderer* renderer, const Mat4 &parentTransform, bool
     
     bool dirty = _transformUpdated || parentTransformUpdated;
     if(dirty)
-        _modelViewTransform = this->transform(parentTransform);
+        updateModelViewTransform(parentTransform);
     _transformUpdated = false;
     
     
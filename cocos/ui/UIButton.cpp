@@ -756,6 +756,12 @@ Widget* Button::createCloneInstance()
     return Button::create();
 }
 
+bool Button::isHitTestInContentSize() const
+{
+    // a subclass may override hitTest() to change the touch area
+    return typeid(*this) == typeid(Button);
+}
+
 void Button::copySpecialProperties(Widget *widget)
 {
     Button* button = dynamic_cast<Button*>(widget);
@@ -208,6 +208,7 @@ protected:
     void pressedTextureScaleChangedWithSize();
     void disabledTextureScaleChangedWithSize();
     virtual Widget* createCloneInstance() override;
+    virtual bool isHitTestInContentSize() const override;
     virtual void copySpecialProperties(Widget* model) override;
     virtual void adaptRenderers() override;
     void updateTitleLocation();
@@ -604,6 +604,12 @@ Widget* CheckBox::createCloneInstance()
     return CheckBox::create();
 }
 
+bool CheckBox::isHitTestInContentSize() const
+{
+    // a subclass may override hitTest() to change the touch area
+    return typeid(*this) == typeid(CheckBox);
+}
+
 void CheckBox::copySpecialProperties(Widget *widget)
 {
     CheckBox* checkBox = dynamic_cast<CheckBox*>(widget);
@@ -218,6 +218,7 @@ protected:
     void backGroundDisabledTextureScaleChangedWithSize();
     void frontCrossDisabledTextureScaleChangedWithSize();
     virtual Widget* createCloneInstance() override;
+    virtual bool isHitTestInContentSize() const override;
     virtual void copySpecialProperties(Widget* model) override;
     virtual void adaptRenderers() override;
 protected:
@@ -341,6 +341,12 @@ Widget* ImageView::createCloneInstance()
     return ImageView::create();
 }
 
+bool ImageView::isHitTestInContentSize() const
+{
+    // a subclass may override hitTest() to change the touch area
+    return typeid(*this) == typeid(ImageView);
+}
+
 void ImageView::copySpecialProperties(Widget *widget)
 {
     ImageView* imageView = dynamic_cast<ImageView*>(widget);
@@ -128,6 +128,7 @@ protected:
     virtual void updateFlippedY() override;
     void imageTextureScaleChangedWithSize();
     virtual Widget* createCloneInstance() override;
+    virtual bool isHitTestInContentSize() const override;
     virtual void copySpecialProperties(Widget* model) override;
     virtual void adaptRenderers() override;
 protected:
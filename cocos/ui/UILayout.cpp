@@ -24,6 +24,9 @@ THE SOFTWARE.
 
 #include "ui/UILayout.h"
 #include "ui/UIHelper.h"
+#include "ui/UIHBox.h"
+#include "ui/UIVBox.h"
+#include "ui/UIRelativeBox.h"
 #include "extensions/GUI/CCControlExtension/CCScale9Sprite.h"
 #include "renderer/CCGLProgram.h"
 #include "renderer/CCGLProgramCache.h"
@@ -743,7 +746,7 @@ void Layout::stencilClippingVisit(Renderer *renderer, const Mat4 &parentTransfor
     
     bool dirty = parentTransformUpdated || _transformUpdated;
     if(dirty)
-        _modelViewTransform = transform(parentTransform);
+        updateModelViewTransform(parentTransform);
     _transformUpdated = false;
 
     // IMPORTANT:
@@ -1494,6 +1497,13 @@ Widget* Layout::createCloneInstance()
     return Layout::create();
 }
 
+bool Layout::isHitTestInContentSize() const
+{
+    // a subclass may override hitTest() to change the touch area
+    return typeid(*this) == typeid(Layout) || typeid(*this) == typeid(HBox)
+        || typeid(*this) == typeid(VBox) || typeid(*this) == typeid(RelativeBox);
+}
+
 void Layout::copyClonedWidgetChildren(Widget* model)
 {
     Widget::copyClonedWidgetChildren(model);
@@ -305,6 +305,7 @@ protected:
     
     void supplyTheLayoutParameterLackToChild(Widget* child);
     virtual Widget* createCloneInstance() override;
+    virtual bool isHitTestInContentSize() const override;
     virtual void copySpecialProperties(Widget* model) override;
     virtual void copyClonedWidgetChildren(Widget* model) override;
     
@@ -484,6 +484,12 @@ Widget* ListView::createCloneInstance()
     return ListView::create();
 }
 
+bool ListView::isHitTestInContentSize() const
+{
+    // a subclass may override hitTest() to change the touch area
+    return typeid(*this) == typeid(ListView);
+}
+
 void ListView::copyClonedWidgetChildren(Widget* model)
 {
     auto& arrayItems = static_cast<ListView*>(model)->getItems();
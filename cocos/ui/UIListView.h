@@ -202,6 +202,7 @@ protected:
     void remedyLayoutParameter(Widget* item);
     virtual void onSizeChanged() override;
     virtual Widget* createCloneInstance() override;
+    virtual bool isHitTestInContentSize() const override;
     virtual void copySpecialProperties(Widget* model) override;
     virtual void copyClonedWidgetChildren(Widget* model) override;
     void selectedItemEvent(int state);
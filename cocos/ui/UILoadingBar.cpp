@@ -378,6 +378,12 @@ Widget* LoadingBar::createCloneInstance()
     return LoadingBar::create();
 }
 
+bool LoadingBar::isHitTestInContentSize() const
+{
+    // a subclass may override hitTest() to change the touch area
+    return typeid(*this) == typeid(LoadingBar);
+}
+
 void LoadingBar::copySpecialProperties(Widget *widget)
 {
     LoadingBar* loadingBar = dynamic_cast<LoadingBar*>(widget);
@@ -611,6 +611,12 @@ Widget* PageView::createCloneInstance()
     return PageView::create();
 }
 
+bool PageView::isHitTestInContentSize() const
+{
+    // a subclass may override hitTest() to change the touch area
+    return typeid(*this) == typeid(PageView);
+}
+
 void PageView::copyClonedWidgetChildren(Widget* model)
 {
     auto& modelPages = static_cast<PageView*>(model)->getPages();
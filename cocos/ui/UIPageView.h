@@ -201,6 +201,7 @@ virtual Widget* getChildByName(const std::string& name) override {return Widget:
     void updateChildrenPosition();
     virtual void onSizeChanged() override;
     virtual Widget* createCloneInstance() override;
+    virtual bool isHitTestInContentSize() const override;
     virtual void copySpecialProperties(Widget* model) override;
     virtual void copyClonedWidgetChildren(Widget* model) override;
     virtual void setClippingEnabled(bool enabled) override {Layout::setClippingEnabled(enabled);};
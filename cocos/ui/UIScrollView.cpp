@@ -1723,6 +1723,12 @@ Widget* ScrollView::createCloneInstance()
     return ScrollView::create();
 }
 
+bool ScrollView::isHitTestInContentSize() const
+{
+    // a subclass may override hitTest() to change the touch area
+    return typeid(*this) == typeid(ScrollView);
+}
+
 void ScrollView::copyClonedWidgetChildren(Widget* model)
 {
     Layout::copyClonedWidgetChildren(model);
@@ -378,6 +378,7 @@ protected:
     void bounceRightEvent();
     virtual void onSizeChanged() override;
     virtual Widget* createCloneInstance() override;
+    virtual bool isHitTestInContentSize() const override;
     virtual void copySpecialProperties(Widget* model) override;
     virtual void copyClonedWidgetChildren(Widget* model) override;
     virtual void setClippingEnabled(bool able) override{Layout::setClippingEnabled(able);};
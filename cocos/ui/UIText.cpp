@@ -341,6 +341,12 @@ Widget* Text::createCloneInstance()
     return Text::create();
 }
 
+bool Text::isHitTestInContentSize() const
+{
+    // a subclass may override hitTest() to change the touch area
+    return typeid(*this) == typeid(Text);
+}
+
 void Text::copySpecialProperties(Widget *widget)
 {
     Text* label = dynamic_cast<Text*>(widget);
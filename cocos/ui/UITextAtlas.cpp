@@ -191,6 +191,12 @@ Widget* TextAtlas::createCloneInstance()
     return TextAtlas::create();
 }
 
+bool TextAtlas::isHitTestInContentSize() const
+{
+    // a subclass may override hitTest() to change the touch area
+    return typeid(*this) == typeid(TextAtlas);
+}
+
 void TextAtlas::copySpecialProperties(Widget *widget)
 {
     TextAtlas* labelAtlas = dynamic_cast<TextAtlas*>(widget);
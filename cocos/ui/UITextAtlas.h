@@ -112,6 +112,7 @@ protected:
     virtual void updateTextureRGBA() override;
     void labelAtlasScaleChangedWithSize();
     virtual Widget* createCloneInstance() override;
+    virtual bool isHitTestInContentSize() const override;
     virtual void copySpecialProperties(Widget* model) override;
 protected:
     Label* _labelAtlasRenderer;
@@ -185,6 +185,12 @@ Widget* TextBMFont::createCloneInstance()
     return TextBMFont::create();
 }
 
+bool TextBMFont::isHitTestInContentSize() const
+{
+    // a subclass may override hitTest() to change the touch area
+    return typeid(*this) == typeid(TextBMFont);
+}
+
 void TextBMFont::copySpecialProperties(Widget *widget)
 {
     TextBMFont* labelBMFont = dynamic_cast<TextBMFont*>(widget);
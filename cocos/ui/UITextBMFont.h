@@ -92,6 +92,7 @@ protected:
     virtual void updateTextureRGBA() override;
     void labelBMFontScaleChangedWithSize();
     virtual Widget* createCloneInstance() override;
+    virtual bool isHitTestInContentSize() const override;
     virtual void copySpecialProperties(Widget* model) override;
     virtual void adaptRenderers() override;
 protected:
@@ -110,6 +110,11 @@ bool Widget::init()
 
 void Widget::onEnter()
 {
+    // the listener is created by the constructor, where the override can't be seen yet
+    if (_touchListener)
+    {
+        _touchListener->setHitTestEnabled(isHitTestInContentSize());
+    }
     updateSizeAndPosition();
     ProtectedNode::onEnter();
 }
@@ -416,6 +421,7 @@ void Widget::setTouchEnabled(bool enable)
         _touchListener = EventListenerTouchOneByOne::create();
         CC_SAFE_RETAIN(_touchListener);
         _touchListener->setSwallowTouches(true);
+        _touchListener->setHitTestEnabled(isHitTestInContentSize());
         _touchListener->onTouchBegan = CC_CALLBACK_2(Widget::onTouchBegan, this);
         _touchListener->onTouchMoved = CC_CALLBACK_2(Widget::onTouchMoved, this);
         _touchListener->onTouchEnded = CC_CALLBACK_2(Widget::onTouchEnded, this);
@@ -703,6 +709,12 @@ bool Widget::hitTest(const Vec2 &pt)
     return false;
 }
 
+bool Widget::isHitTestInContentSize() const
+{
+    // hitTest() is public and virtual, subclasses may grow the touch area
+    return false;
+}
+
 bool Widget::clippingParentAreaContainPoint(const Vec2 &pt)
 {
     _affectByClipping = false;
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "ui/CCProtectedNode.h"
 #include "ui/UILayoutParameter.h"
 #include "ui/GUIDefine.h"
+#include <typeinfo>
 
 NS_CC_BEGIN
 
@@ -633,6 +634,9 @@ protected:
     bool isAncestorsEnabled();
     Widget* getAncensterWidget(Node* node);
     bool isAncestorsVisible(Node* node);
+    //hitTest 是否只检查内容区域 (0, 0, contentSize)，是的话触摸侦听器会开启 hit test，让 EventDispatcher 先排除区域外的触摸
+    //默认为 false，子类可能重写了 hitTest，只有确定没有重写的引擎控件才返回 true
+    virtual bool isHitTestInContentSize() const;
 
 protected:
     bool _enabled;            ///< widget的最高控制
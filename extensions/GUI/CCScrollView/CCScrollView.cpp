@@ -563,7 +563,7 @@ void ScrollView::visit(Renderer *renderer, const Mat4 &parentTransform, bool par
 
     bool dirty = parentTransformUpdated || _transformUpdated;
     if(dirty)
-        _modelViewTransform = this->transform(parentTransform);
+        updateModelViewTransform(parentTransform);
     _transformUpdated = false;
 
     // IMPORTANT:
@@ -227,6 +227,9 @@ void AssetsManager::downloadAndUncompress()
             // Set resource search path.
             this->setSearchPath();
             
+            // Names looked up before the update may have been cached as missing.
+            FileUtils::getInstance()->purgeCachedEntries();
+            
             // Delete unloaded zip file.
             string zipfileName = this->_storagePath + TEMP_PACKAGE_FILE_NAME;
             if (remove(zipfileName.c_str()) != 0)
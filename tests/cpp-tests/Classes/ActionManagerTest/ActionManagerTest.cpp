@@ -2,6 +2,8 @@
 #include "../testResource.h"
 #include "cocos2d.h"
 
+#include <chrono>
+
 enum 
 {
     kTagNode,
@@ -15,7 +17,7 @@ Layer* restartActionManagerAction();
 
 static int sceneIdx = -1; 
 
-#define MAX_LAYER    5
+#define MAX_LAYER    6
 
 Layer* createActionManagerLayer(int nIndex)
 {
@@ -26,6 +28,7 @@ Layer* createActionManagerLayer(int nIndex)
         case 2: return new PauseTest();
         case 3: return new StopActionTest();
         case 4: return new ResumeTest();
+        case 5: return new ManyActionsTest();
     }
 
     return NULL;
@@ -307,6 +310,91 @@ void ResumeTest::resumeGrossini(float time)
     director->getActionManager()->resumeTarget(pGrossini);
 }
 
+//------------------------------------------------------------------
+//
+// ManyActionsTest
+//
+//------------------------------------------------------------------
+ManyActionsTest::ManyActionsTest()
+: _benchmarkManager(nullptr)
+, _label(nullptr)
+, _updateTime(0)
+, _frames(0)
+{
+}
+
+ManyActionsTest::~ManyActionsTest()
+{
+    CC_SAFE_RELEASE(_benchmarkManager);
+}
+
+std::string ManyActionsTest::subtitle() const
+{
+    return "2000 sprites with MoveTo/RotateBy/ScaleTo/FadeTo";
+}
+
+void ManyActionsTest::onEnter()
+{
+    ActionManagerTest::onEnter();
+
+    _label = Label::createWithTTF("", "fonts/arial.ttf", 20);
+    _label->setPosition(Vec2(VisibleRect::center().x, VisibleRect::top().y - 75));
+    addChild(_label, 1);
+
+    // the sprites get their own manager, so that its update can be timed
+    _benchmarkManager = new ActionManager();
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        auto sprite = Sprite::create(s_pathSister1);
+        sprite->setActionManager(_benchmarkManager);
+        sprite->setScale(0.2f);
+        sprite->setPosition(Vec2(VisibleRect::left().x + CCRANDOM_0_1() * VisibleRect::getVisibleRect().size.width,
+                                 VisibleRect::bottom().y + CCRANDOM_0_1() * VisibleRect::getVisibleRect().size.height));
+        addChild(sprite);
+        _nodes.pushBack(sprite);
+        runActionsOn(sprite);
+    }
+
+    scheduleUpdate();
+}
+
+void ManyActionsTest::runActionsOn(Node* node)
+{
+    float duration = 1 + CCRANDOM_0_1() * 2;
+    Vec2 position(VisibleRect::left().x + CCRANDOM_0_1() * VisibleRect::getVisibleRect().size.width,
+                  VisibleRect::bottom().y + CCRANDOM_0_1() * VisibleRect::getVisibleRect().size.height);
+
+    node->runAction(MoveTo::create(duration, position));
+    node->runAction(RotateBy::create(duration, 360));
+    node->runAction(ScaleTo::create(duration, 0.1f + CCRANDOM_0_1() * 0.3f));
+    node->runAction(FadeTo::create(duration, (GLubyte)(CCRANDOM_0_1() * 255)));
+}
+
+void ManyActionsTest::update(float dt)
+{
+    for (auto node : _nodes)
+    {
+        if (_benchmarkManager->getNumberOfRunningActionsInTarget(node) == 0)
+        {
+            runActionsOn(node);
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    _benchmarkManager->update(dt);
+    _updateTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (++_frames == 60)
+    {
+        char str[64];
+        snprintf(str, sizeof(str), "ActionManager::update: %.3f ms", _updateTime / _frames);
+        _label->setString(str);
+        _updateTime = 0;
+        _frames = 0;
+    }
+}
+
 //------------------------------------------------------------------
 //
 // ActionManagerTestScene
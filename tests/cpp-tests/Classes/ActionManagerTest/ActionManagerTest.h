@@ -62,6 +62,25 @@ public:
     void resumeGrossini(float time);
 };
 
+class ManyActionsTest : public ActionManagerTest
+{
+public:
+    ManyActionsTest();
+    ~ManyActionsTest();
+
+    virtual std::string subtitle() const override;
+    virtual void onEnter() override;
+    virtual void update(float dt) override;
+    void runActionsOn(Node* node);
+
+private:
+    ActionManager* _benchmarkManager;
+    Vector<Node*> _nodes;
+    Label* _label;
+    float _updateTime;
+    int _frames;
+};
+
 class ActionManagerTestScene : public TestScene
 {
 public:
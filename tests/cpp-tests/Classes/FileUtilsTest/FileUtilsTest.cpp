@@ -1,4 +1,7 @@
 #include "FileUtilsTest.h"
+#include "base/ZipUtils.h"
+#include <atomic>
+#include <thread>
 
 static std::function<Layer*()> createFunctions[] = {
     CL(TestResolutionDirectories),
@@ -6,6 +9,11 @@ static std::function<Layer*()> createFunctions[] = {
     CL(TestFilenameLookup),
     CL(TestIsFileExist),
     CL(TextWritePlist),
+    CL(TestFileMapping),
+    CL(TestLookupCache),
+    CL(TestPackFile),
+    CL(TestZipFileThreads),
+    CL(TestInflate),
 };
 
 static int sceneIdx=-1;
@@ -396,3 +404,319 @@ std::string TextWritePlist::subtitle() const
     std::string writablePath = FileUtils::getInstance()->getWritablePath().c_str();
     return ("See plist file at your writablePath");
 }
+
+// TestFileMapping
+
+void TestFileMapping::onEnter()
+{
+    FileUtilsDemo::onEnter();
+    auto s = Director::getInstance()->getWinSize();
+    auto sharedFileUtils = FileUtils::getInstance();
+    
+    const std::string filename = "Images/grossini.png";
+    
+    ssize_t oldThreshold = sharedFileUtils->getFileMappingThreshold();
+    sharedFileUtils->setFileMappingThreshold(-1);
+    Data readData = sharedFileUtils->getDataFromFile(filename);
+    sharedFileUtils->setFileMappingThreshold(oldThreshold);
+    
+    Data mappedData = sharedFileUtils->getMappedDataFromFile(filename);
+    
+    std::string result;
+    if (mappedData.isNull())
+    {
+        result = "mapping not supported, read fallback used";
+    }
+    else if (mappedData.getSize() == readData.getSize()
+             && memcmp(mappedData.getBytes(), readData.getBytes(), readData.getSize()) == 0)
+    {
+        // copies of a mapped Data own a private buffer
+        Data copied = mappedData;
+        result = (mappedData.isShared() && !copied.isShared()) ? "mapped data matches, ok" : "unexpected ownership";
+    }
+    else
+    {
+        result = "mapped data differs from read data";
+    }
+    
+    auto label = Label::createWithSystemFont(result, "", 20);
+    label->setPosition(Vec2(s.width/2, s.height/2));
+    this->addChild(label);
+}
+
+std::string TestFileMapping::title() const
+{
+    return "FileUtils: memory mapped files";
+}
+
+std::string TestFileMapping::subtitle() const
+{
+    return "Compares getMappedDataFromFile with a normal read";
+}
+
+// TestLookupCache
+
+void TestLookupCache::onEnter()
+{
+    FileUtilsDemo::onEnter();
+    auto s = Director::getInstance()->getWinSize();
+    auto sharedFileUtils = FileUtils::getInstance();
+    
+    _wasIndexEnabled = sharedFileUtils->isSearchPathIndexEnabled();
+    sharedFileUtils->setSearchPathIndexEnabled(true);
+    sharedFileUtils->purgeCachedEntries();
+    sharedFileUtils->resetLookupStats();
+    
+    // the second probe of each file is answered by a cache
+    bool ok = true;
+    for (int i = 0; i < 2; ++i)
+    {
+        ok = ok && sharedFileUtils->isFileExist("Images/grossini.png");
+        ok = ok && !sharedFileUtils->isFileExist("Images/grossini-missing.png");
+    }
+    
+    const FileUtils::LookupStats& stats = sharedFileUtils->getLookupStats();
+    ok = ok && stats.cacheHits == 1 && stats.missingCacheHits == 1 && stats.resolved == 1 && stats.unresolved == 1;
+    
+    char text[128];
+    snprintf(text, sizeof(text), "%s\nfile system checks: %u, avoided: %u",
+             ok ? "lookup caches ok" : "unexpected lookup counters", stats.fileChecks, stats.fileChecksAvoided);
+    
+    auto label = Label::createWithSystemFont(text, "", 20);
+    label->setPosition(Vec2(s.width/2, s.height/2));
+    this->addChild(label);
+}
+
+void TestLookupCache::onExit()
+{
+    FileUtils::getInstance()->setSearchPathIndexEnabled(_wasIndexEnabled);
+    FileUtilsDemo::onExit();
+}
+
+std::string TestLookupCache::title() const
+{
+    return "FileUtils: lookup caches";
+}
+
+std::string TestLookupCache::subtitle() const
+{
+    return "Missing files and the search path index skip file system checks";
+}
+
+// TestPackFile
+
+void TestPackFile::onEnter()
+{
+    FileUtilsDemo::onEnter();
+    auto s = Director::getInstance()->getWinSize();
+    auto sharedFileUtils = FileUtils::getInstance();
+    
+    // Misc/test.ccpk is made by tools/packer/make_pack.py -z from a directory with
+    // pack/hello.txt (deflated in the pack) and a copy of Images/grossini.png (stored)
+    _defaultSearchPathArray = sharedFileUtils->getSearchPaths();
+    sharedFileUtils->addSearchPath(sharedFileUtils->fullPathForFilename("Misc/test.ccpk"));
+    
+    std::string expected;
+    for (int i = 0; i < 40; ++i)
+    {
+        expected += "Hello from the pack file!\n";
+    }
+    
+    bool ok = sharedFileUtils->isFileExist("pack/hello.txt")
+        && sharedFileUtils->isFileExist("pack/grossini.png")
+        && !sharedFileUtils->isFileExist("pack/missing.png");
+    ok = ok && sharedFileUtils->getStringFromFile("pack/hello.txt") == expected;
+    
+    Data packed = sharedFileUtils->getDataFromFile("pack/grossini.png");
+    Data original = sharedFileUtils->getDataFromFile("Images/grossini.png");
+    ok = ok && !packed.isNull() && packed.getSize() == original.getSize()
+        && memcmp(packed.getBytes(), original.getBytes(), original.getSize()) == 0;
+    
+    auto label = Label::createWithSystemFont(ok ? "pack lookups and reads ok" : "pack lookups or reads failed", "", 20);
+    label->setPosition(Vec2(s.width/2, s.height/2 + 40));
+    this->addChild(label);
+    
+    // a sprite loaded straight from the pack
+    auto sprite = Sprite::create("pack/grossini.png");
+    if (sprite)
+    {
+        sprite->setPosition(Vec2(s.width/2, s.height/2 - 40));
+        this->addChild(sprite);
+    }
+}
+
+void TestPackFile::onExit()
+{
+    // unmounts the pack
+    FileUtils::getInstance()->setSearchPaths(_defaultSearchPathArray);
+    FileUtilsDemo::onExit();
+}
+
+std::string TestPackFile::title() const
+{
+    return "FileUtils: pack files";
+}
+
+std::string TestPackFile::subtitle() const
+{
+    return "Reads a stored and a deflated file from a mounted .ccpk";
+}
+
+// TestZipFileThreads
+
+void TestZipFileThreads::onEnter()
+{
+    FileUtilsDemo::onEnter();
+    auto s = Director::getInstance()->getWinSize();
+    auto sharedFileUtils = FileUtils::getInstance();
+    
+    // Misc/test.zip holds pack/hello.txt deflated and a copy of Images/grossini.png stored
+    std::string zipPath = sharedFileUtils->fullPathForFilename("Misc/test.zip");
+    std::string names[] = { "pack/hello.txt", "pack/grossini.png" };
+    Data expected[] = { sharedFileUtils->getDataFromFile("Misc/hello.txt"), sharedFileUtils->getDataFromFile("Images/grossini.png") };
+    
+    // the archive is read from a mapping first, then with pread (mapping turned off)
+    ssize_t oldThreshold = sharedFileUtils->getFileMappingThreshold();
+    std::string result;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        sharedFileUtils->setFileMappingThreshold(pass == 0 ? oldThreshold : -1);
+        ZipFile zip(zipPath);
+        if (!zip.fileExists(names[0]))
+        {
+            // e.g. inside the Android apk, minizip can only open real files
+            result = "can't open " + zipPath;
+            break;
+        }
+        
+        std::atomic<int> failures(0);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i)
+        {
+            threads.push_back(std::thread([&, i](){
+                for (int j = 0; j < 50; ++j)
+                {
+                    int k = (i + j) % 2;
+                    ssize_t size = 0;
+                    unsigned char* buffer = zip.getFileData(names[k], &size);
+                    if (!buffer || size != expected[k].getSize() || memcmp(buffer, expected[k].getBytes(), size) != 0)
+                    {
+                        ++failures;
+                    }
+                    free(buffer);
+                }
+            }));
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        
+        result += pass == 0 ? "mapped: " : "\npread: ";
+        result += failures == 0 ? "ok" : "failed";
+    }
+    sharedFileUtils->setFileMappingThreshold(oldThreshold);
+    
+    auto label = Label::createWithSystemFont(result, "", 20);
+    label->setPosition(Vec2(s.width/2, s.height/2));
+    this->addChild(label);
+}
+
+std::string TestZipFileThreads::title() const
+{
+    return "ZipFile: reads from several threads";
+}
+
+std::string TestZipFileThreads::subtitle() const
+{
+    return "4 threads read a stored and a deflated entry at once";
+}
+
+// TestInflate
+
+// Inflates data with every ZipUtils entry point, the hint is deliberately too small
+static bool checkInflate(const Data& compressed, const Data& expected)
+{
+    ssize_t size = expected.getSize();
+    std::vector<unsigned char> in(compressed.getBytes(), compressed.getBytes() + compressed.getSize());
+    
+    unsigned char* out = nullptr;
+    ssize_t length = ZipUtils::inflateMemoryWithHint(in.data(), in.size(), &out, 16);
+    bool ok = length == size && memcmp(out, expected.getBytes(), size) == 0;
+    free(out);
+    
+    // known size fast path, one byte short must fail
+    std::vector<unsigned char> buffer(size);
+    ok = ok && ZipUtils::inflateMemoryToBuffer(in.data(), in.size(), buffer.data(), size) == size
+        && memcmp(buffer.data(), expected.getBytes(), size) == 0;
+    ok = ok && ZipUtils::inflateMemoryToBuffer(in.data(), in.size(), buffer.data(), size - 1) == -1;
+    
+    // streaming with small input chunks
+    size_t position = 0;
+    std::vector<unsigned char> streamed;
+    length = ZipUtils::inflateStream([&](const unsigned char** data, ssize_t* chunkLength) {
+        if (position >= in.size())
+            return false;
+        *data = in.data() + position;
+        *chunkLength = std::min<ssize_t>(7, in.size() - position);
+        position += *chunkLength;
+        return true;
+    }, [&](const unsigned char* data, ssize_t chunkLength) {
+        streamed.insert(streamed.end(), data, data + chunkLength);
+        return true;
+    });
+    ok = ok && length == size && streamed.size() == (size_t)size && memcmp(streamed.data(), expected.getBytes(), size) == 0;
+    
+    return ok;
+}
+
+void TestInflate::onEnter()
+{
+    FileUtilsDemo::onEnter();
+    auto s = Director::getInstance()->getWinSize();
+    auto sharedFileUtils = FileUtils::getInstance();
+    
+    // made from Misc/hello.txt, hello-members.txt.gz holds two concatenated gzip members
+    Data expected = sharedFileUtils->getDataFromFile("Misc/hello.txt");
+    const char* files[] = { "Misc/hello.txt.zlib", "Misc/hello.txt.gz", "Misc/hello-members.txt.gz" };
+    
+    std::string result;
+    for (auto file : files)
+    {
+        Data compressed = sharedFileUtils->getDataFromFile(file);
+        result += file;
+        result += checkInflate(compressed, expected) ? ": ok\n" : ": failed\n";
+    }
+    
+    // bytes after a zlib stream are not another member
+    Data zlibData = sharedFileUtils->getDataFromFile("Misc/hello.txt.zlib");
+    std::vector<unsigned char> trailing(zlibData.getBytes(), zlibData.getBytes() + zlibData.getSize());
+    trailing.push_back(0x1F);
+    unsigned char* out = nullptr;
+    ssize_t length = ZipUtils::inflateMemoryWithHint(trailing.data(), trailing.size(), &out, expected.getSize());
+    result += (length == expected.getSize()) ? "zlib with trailing byte: ok" : "zlib with trailing byte: failed";
+    free(out);
+    
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID)
+    // inflateGZipFile reads from the file system directly
+    out = nullptr;
+    int fileLength = ZipUtils::inflateGZipFile(sharedFileUtils->fullPathForFilename("Misc/hello-members.txt.gz").c_str(), &out);
+    bool fileOk = fileLength == expected.getSize() && memcmp(out, expected.getBytes(), fileLength) == 0;
+    result += fileOk ? "\ninflateGZipFile: ok" : "\ninflateGZipFile: failed";
+    free(out);
+#endif
+    
+    auto label = Label::createWithSystemFont(result, "", 18);
+    label->setPosition(Vec2(s.width/2, s.height/2));
+    this->addChild(label);
+}
+
+std::string TestInflate::title() const
+{
+    return "ZipUtils: inflate";
+}
+
+std::string TestInflate::subtitle() const
+{
+    return "zlib, gzip and concatenated gzip through every inflate entry point";
+}
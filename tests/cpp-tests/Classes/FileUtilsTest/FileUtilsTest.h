@@ -83,4 +83,62 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class TestFileMapping : public FileUtilsDemo
+{
+public:
+    CREATE_FUNC(TestFileMapping);
+
+    virtual void onEnter() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
+class TestLookupCache : public FileUtilsDemo
+{
+public:
+    CREATE_FUNC(TestLookupCache);
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+private:
+    bool _wasIndexEnabled;
+};
+
+class TestPackFile : public FileUtilsDemo
+{
+public:
+    CREATE_FUNC(TestPackFile);
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+private:
+    std::vector<std::string> _defaultSearchPathArray;
+};
+
+class TestZipFileThreads : public FileUtilsDemo
+{
+public:
+    CREATE_FUNC(TestZipFileThreads);
+
+    virtual void onEnter() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
+class TestInflate : public FileUtilsDemo
+{
+public:
+    CREATE_FUNC(TestInflate);
+
+    virtual void onEnter() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
 #endif /* __FILEUTILSTEST_H__ */
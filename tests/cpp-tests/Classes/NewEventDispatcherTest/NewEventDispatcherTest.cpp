@@ -28,7 +28,9 @@ std::function<Layer*()> createFunctions[] =
     CL(Issue4129),
     CL(Issue4160),
     CL(DanglingNodePointersTest),
-    CL(RegisterAndUnregisterWhileEventHanldingTest)
+    CL(RegisterAndUnregisterWhileEventHanldingTest),
+    CL(SceneGraphOrderTest),
+    CL(HitTestBoundsTest)
 };
 
 unsigned int TEST_CASE_COUNT = sizeof(createFunctions) / sizeof(createFunctions[0]);
@@ -1457,3 +1459,147 @@ std::string RegisterAndUnregisterWhileEventHanldingTest::subtitle() const
 {
     return  "Tap the square multiple times - should not crash!";
 }
+
+// SceneGraphOrderTest
+SceneGraphOrderTest::SceneGraphOrderTest()
+: _container(nullptr)
+, _accum(0)
+{
+    Size size = Director::getInstance()->getVisibleSize();
+    
+    // A large tree without listeners, it should not slow down touch dispatch
+    for (int i = 0; i < 50; ++i)
+    {
+        auto group = Node::create();
+        for (int j = 0; j < 100; ++j)
+        {
+            group->addChild(Node::create());
+        }
+        addChild(group, -1);
+    }
+    
+    auto listener = EventListenerTouchOneByOne::create();
+    listener->setSwallowTouches(true);
+    listener->onTouchBegan = [](Touch* touch, Event* event){
+        auto target = static_cast<Sprite*>(event->getCurrentTarget());
+        
+        Vec2 locationInNode = target->convertToNodeSpace(touch->getLocation());
+        Size s = target->getContentSize();
+        Rect rect = Rect(0, 0, s.width, s.height);
+        
+        if (rect.containsPoint(locationInNode))
+        {
+            log("sprite %d began", target->getTag());
+            target->setOpacity(180);
+            return true;
+        }
+        return false;
+    };
+    listener->onTouchEnded = [](Touch* touch, Event* event){
+        auto target = static_cast<Sprite*>(event->getCurrentTarget());
+        target->setOpacity(255);
+    };
+    
+    _container = Node::create();
+    addChild(_container);
+    
+    const int SPRITE_COUNT = 5;
+    for (int i = 0; i < SPRITE_COUNT; ++i)
+    {
+        auto sprite = Sprite::create(i % 2 ? "Images/CyanSquare.png" : "Images/YellowSquare.png");
+        sprite->setTag(i);
+        sprite->setPosition(VisibleRect::center() + Vec2((i - SPRITE_COUNT / 2) * 30, 0));
+        _eventDispatcher->addEventListenerWithSceneGraphPriority(listener->clone(), sprite);
+        _container->addChild(sprite);
+    }
+    
+    this->scheduleUpdate();
+}
+
+void SceneGraphOrderTest::update(float dt)
+{
+    _accum += dt;
+    if (_accum > 1.0f)
+    {
+        // Bring the bottom sprite to the front, reorderChild doesn't change its local Z order
+        auto& children = _container->getChildren();
+        Node* bottom = children.at(0);
+        for (const auto& child : children)
+        {
+            if (child->getOrderOfArrival() < bottom->getOrderOfArrival())
+                bottom = child;
+        }
+        _container->reorderChild(bottom, bottom->getLocalZOrder());
+        _accum = 0;
+    }
+}
+
+std::string SceneGraphOrderTest::title() const
+{
+    return "Scene graph priority after reordering";
+}
+
+std::string SceneGraphOrderTest::subtitle() const
+{
+    return "Touch the overlapping sprites, the front one should respond";
+}
+
+// HitTestBoundsTest
+HitTestBoundsTest::HitTestBoundsTest()
+{
+    auto listener = EventListenerTouchOneByOne::create();
+    listener->setSwallowTouches(true);
+    // onTouchBegan only claims touches inside the sprite, so the dispatcher may skip it for touches elsewhere
+    listener->setHitTestEnabled(true);
+    listener->onTouchBegan = [](Touch* touch, Event* event){
+        auto target = static_cast<Sprite*>(event->getCurrentTarget());
+        
+        Vec2 locationInNode = target->convertToNodeSpace(touch->getLocation());
+        Size s = target->getContentSize();
+        Rect rect = Rect(0, 0, s.width, s.height);
+        
+        if (rect.containsPoint(locationInNode))
+        {
+            target->setOpacity(180);
+            return true;
+        }
+        return false;
+    };
+    listener->onTouchEnded = [](Touch* touch, Event* event){
+        auto target = static_cast<Sprite*>(event->getCurrentTarget());
+        target->setOpacity(255);
+    };
+    
+    const int ROWS = 10;
+    const int COLS = 20;
+    Size size = Director::getInstance()->getVisibleSize();
+    Vec2 origin = Director::getInstance()->getVisibleOrigin();
+    
+    for (int row = 0; row < ROWS; ++row)
+    {
+        for (int col = 0; col < COLS; ++col)
+        {
+            auto sprite = Sprite::create((row + col) % 2 ? "Images/CyanSquare.png" : "Images/YellowSquare.png");
+            sprite->setScale(0.3f);
+            sprite->setPosition(origin + Vec2(size.width * (col + 0.5f) / COLS, size.height * (row + 1.5f) / (ROWS + 2)));
+            _eventDispatcher->addEventListenerWithSceneGraphPriority(listener->clone(), sprite);
+            addChild(sprite);
+            
+            // rotated sprites keep working, their world bounding box is only used to reject touches
+            if (col % 5 == 0)
+            {
+                sprite->runAction(RepeatForever::create(RotateBy::create(2, 360)));
+            }
+        }
+    }
+}
+
+std::string HitTestBoundsTest::title() const
+{
+    return "Touch hit test bounds";
+}
+
+std::string HitTestBoundsTest::subtitle() const
+{
+    return "Touched sprite should become transparent, also the rotating ones";
+}
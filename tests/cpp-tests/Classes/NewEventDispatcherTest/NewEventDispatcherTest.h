@@ -227,4 +227,30 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class SceneGraphOrderTest : public EventDispatcherTestDemo
+{
+public:
+    CREATE_FUNC(SceneGraphOrderTest);
+    SceneGraphOrderTest();
+    
+    virtual void update(float dt) override;
+    
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    
+private:
+    Node* _container;
+    float _accum;
+};
+
+class HitTestBoundsTest : public EventDispatcherTestDemo
+{
+public:
+    CREATE_FUNC(HitTestBoundsTest);
+    HitTestBoundsTest();
+    
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
 #endif /* defined(__samples__NewEventDispatcherTest__) */
@@ -40,6 +40,9 @@ static std::function<Layer*()> createFunctions[] =
     CL(NewDrawNodeTest),
     CL(NewCullingTest),
     CL(VBOFullTest),
+    CL(BigQuadCommandTest),
+    CL(MaterialSortingTest),
+    CL(CullingNodeTest),
 };
 
 #define MAX_LAYER    (sizeof(createFunctions) / sizeof(createFunctions[0]))
@@ -559,3 +562,134 @@ std::string VBOFullTest::subtitle() const
 {
     return "VBO full Test, everthing should render normally";
 }
+
+BigQuadCommandTest::BigQuadCommandTest()
+{
+    Size s = Director::getInstance()->getWinSize();
+
+    // A single QuadCommand with more quads than the renderer's VBO can hold
+    auto emitter = ParticleGalaxy::createWithTotalParticles(Renderer::VBO_SIZE * 3);
+    emitter->setTexture(Director::getInstance()->getTextureCache()->addImage("Images/fire.png"));
+    emitter->setEmissionRate(emitter->getTotalParticles() / emitter->getLife());
+    emitter->setPosition(Vec2(s.width/2, s.height/2));
+    addChild(emitter);
+}
+
+BigQuadCommandTest::~BigQuadCommandTest()
+{
+
+}
+
+std::string BigQuadCommandTest::title() const
+{
+    return "New Renderer";
+}
+
+std::string BigQuadCommandTest::subtitle() const
+{
+    return "One QuadCommand bigger than the VBO, should render normally";
+}
+
+MaterialSortingTest::MaterialSortingTest()
+{
+    Size s = Director::getInstance()->getWinSize();
+
+    // Interleave two textures in a grid that does not overlap, so every sprite
+    // breaks the batch unless the renderer groups them by material
+    const int columns = 12;
+    const int rows = 6;
+    for (int i = 0; i < columns * rows; ++i)
+    {
+        auto sprite = Sprite::create(i % 2 ? "Images/grossinis_sister1.png" : "Images/grossinis_sister2.png");
+        sprite->setScale(0.4f);
+        sprite->setPosition(Vec2(s.width * (i % columns + 0.5f) / columns, s.height * (0.2f + 0.6f * (i / columns + 0.5f) / rows)));
+        addChild(sprite);
+    }
+
+    MenuItemFont::setFontSize(16);
+    auto item = MenuItemToggle::createWithCallback(CC_CALLBACK_1(MaterialSortingTest::toggleSorting, this),
+                                                   MenuItemFont::create("Material sorting: OFF"),
+                                                   MenuItemFont::create("Material sorting: ON"),
+                                                   nullptr);
+    auto menu = Menu::create(item, nullptr);
+    menu->setPosition(Vec2(s.width/2, s.height - 80));
+    addChild(menu);
+}
+
+MaterialSortingTest::~MaterialSortingTest()
+{
+
+}
+
+void MaterialSortingTest::onExit()
+{
+    Director::getInstance()->getRenderer()->setMaterialSortingEnabled(false);
+    MultiSceneTest::onExit();
+}
+
+void MaterialSortingTest::toggleSorting(Ref* sender)
+{
+    auto renderer = Director::getInstance()->getRenderer();
+    renderer->setMaterialSortingEnabled(!renderer->isMaterialSortingEnabled());
+}
+
+std::string MaterialSortingTest::title() const
+{
+    return "New Renderer";
+}
+
+std::string MaterialSortingTest::subtitle() const
+{
+    return "Toggle material sorting, drawn batches should drop";
+}
+
+CullingNodeTest::CullingNodeTest()
+{
+    Size s = Director::getInstance()->getWinSize();
+
+    // A world much bigger than the screen; only the children around the window get visited
+    const int columns = 60;
+    const int rows = 60;
+    const float spacing = 40;
+
+    _world = CullingNode::create(spacing * 4);
+    for (int i = 0; i < columns * rows; ++i)
+    {
+        auto sprite = Sprite::create(i % 2 ? "Images/grossinis_sister1.png" : "Images/grossinis_sister2.png");
+        sprite->setScale(0.3f);
+        sprite->setPosition(Vec2(spacing * (i % columns), spacing * (i / columns)));
+        _world->addChild(sprite);
+    }
+    addChild(_world);
+
+    auto scroll = MoveBy::create(8, Vec2(s.width - spacing * columns, s.height - spacing * rows));
+    _world->runAction(RepeatForever::create(Sequence::create(scroll, scroll->reverse(), nullptr)));
+
+    _infoLabel = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _infoLabel->setPosition(Vec2(s.width/2, s.height - 70));
+    addChild(_infoLabel, 1);
+
+    scheduleUpdate();
+}
+
+CullingNodeTest::~CullingNodeTest()
+{
+
+}
+
+void CullingNodeTest::update(float dt)
+{
+    char str[64] = {0};
+    snprintf(str, sizeof(str) - 1, "visited: %d culled: %d", (int)_world->getVisitedChildrenCount(), (int)_world->getCulledChildrenCount());
+    _infoLabel->setString(str);
+}
+
+std::string CullingNodeTest::title() const
+{
+    return "New Renderer";
+}
+
+std::string CullingNodeTest::subtitle() const
+{
+    return "CullingNode skips offscreen children";
+}
@@ -146,4 +146,46 @@ protected:
     virtual ~VBOFullTest();
 };
 
+class BigQuadCommandTest : public MultiSceneTest
+{
+public:
+    CREATE_FUNC(BigQuadCommandTest);
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+protected:
+    BigQuadCommandTest();
+    virtual ~BigQuadCommandTest();
+};
+
+class MaterialSortingTest : public MultiSceneTest
+{
+public:
+    CREATE_FUNC(MaterialSortingTest);
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void onExit() override;
+
+protected:
+    MaterialSortingTest();
+    virtual ~MaterialSortingTest();
+    void toggleSorting(Ref* sender);
+};
+
+class CullingNodeTest : public MultiSceneTest
+{
+public:
+    CREATE_FUNC(CullingNodeTest);
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void update(float dt) override;
+
+protected:
+    CullingNodeTest();
+    virtual ~CullingNodeTest();
+
+    CullingNode* _world;
+    Label* _infoLabel;
+};
+
 #endif //__NewRendererTest_H_
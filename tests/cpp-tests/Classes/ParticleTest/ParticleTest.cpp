@@ -1012,13 +1012,15 @@ Layer* createParticleLayer(int nIndex)
         case 46: return new Issue3990();
         case 47: return new ParticleAutoBatching();
         case 48: return new ParticleVisibleTest();
+        case 49: return new ParticleParallelUpdate();
+        case 50: return new ParticlePrewarm();
         default:
             break;
     }
 
     return NULL;
 }
-#define MAX_LAYER    49
+#define MAX_LAYER    51
 
 
 Layer* nextParticleAction()
@@ -2004,6 +2006,108 @@ std::string ParticleAutoBatching::subtitle() const
     return "All 10 particles should be drawin in one batch";
 }
 
+//
+// ParticleParallelUpdate
+//
+void ParticleParallelUpdate::onEnter()
+{
+    ParticleDemo::onEnter();
+
+    _color->setColor(Color3B::BLACK);
+    this->removeChild(_background, true);
+    _background = NULL;
+
+    _wasParallelUpdateEnabled = ParticleSystem::isParallelUpdateEnabled();
+    ParticleSystem::setParallelUpdateEnabled(true);
+
+    const char* files[] = { "Particles/SmallSun.plist", "Particles/SpinningPeas.plist", "Particles/LavaFlow.plist", "Particles/Comet.plist" };
+    Size s = Director::getInstance()->getWinSize();
+
+    for (int i = 0; i < 32; i++)
+    {
+        auto particle = ParticleSystemQuad::create(files[i % 4]);
+        particle->setPosition(Vec2((i % 8 + 0.5f) * s.width / 8, (i / 8 + 0.5f) * s.height / 4));
+        particle->setPositionType(ParticleSystem::PositionType::GROUPED);
+        this->addChild(particle, 10);
+    }
+
+    _emitter = NULL;
+}
+
+void ParticleParallelUpdate::onExit()
+{
+    ParticleSystem::setParallelUpdateEnabled(_wasParallelUpdateEnabled);
+    ParticleDemo::onExit();
+}
+
+void ParticleParallelUpdate::update(float dt)
+{
+    auto atlas = (LabelAtlas*) getChildByTag(kTagParticleCount);
+
+    unsigned int count = 0;
+
+    for(const auto &child : _children) {
+        auto item = dynamic_cast<ParticleSystem*>(child);
+        if (item != NULL)
+        {
+            count += item->getParticleCount();
+        }
+    }
+
+    char str[100] = {0};
+    sprintf(str, "%4d", count);
+    atlas->setString(str);
+}
+
+std::string ParticleParallelUpdate::title() const
+{
+    return "Parallel update";
+}
+
+std::string ParticleParallelUpdate::subtitle() const
+{
+    return "32 emitters simulated on the thread pool";
+}
+
+//
+// ParticlePrewarm
+//
+void ParticlePrewarm::onEnter()
+{
+    ParticleDemo::onEnter();
+
+    _color->setColor(Color3B::BLACK);
+    this->removeChild(_background, true);
+    _background = NULL;
+
+    Size s = Director::getInstance()->getWinSize();
+    auto texture = Director::getInstance()->getTextureCache()->addImage(s_fire);
+
+    // both emitters share a seed and a prewarm, so they must stay identical
+    for (int i = 0; i < 2; i++)
+    {
+        auto smoke = ParticleSmoke::create();
+        smoke->setTexture(texture);
+        smoke->setPositionType(ParticleSystem::PositionType::GROUPED);
+        smoke->setPosition(Vec2(s.width * (i + 1) / 3, 60));
+        smoke->setRandomSeed(1234);
+        smoke->simulate(5);
+        this->addChild(smoke, 10);
+    }
+
+    _emitter = NULL;
+}
+
+std::string ParticlePrewarm::title() const
+{
+    return "Prewarm";
+}
+
+std::string ParticlePrewarm::subtitle() const
+{
+    return "Both smokes start running and look identical";
+}
+
 //
 // main
 //
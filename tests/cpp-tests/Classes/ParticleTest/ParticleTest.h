@@ -327,4 +327,24 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class ParticleParallelUpdate : public ParticleDemo
+{
+public:
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void update(float dt) override;
+private:
+    bool _wasParallelUpdateEnabled;
+};
+
+class ParticlePrewarm : public ParticleDemo
+{
+public:
+    virtual void onEnter() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
 #endif
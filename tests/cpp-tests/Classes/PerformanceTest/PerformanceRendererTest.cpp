@@ -9,9 +9,28 @@
 #include "PerformanceRendererTest.h"
 #include "PerformanceTextureTest.h"
 #include "../testResource.h"
+#include <chrono>
+#include <algorithm>
+
+enum
+{
+    TEST_COUNT = 2,
+};
+
+static Scene* createRendererTestScene(int curCase)
+{
+    switch (curCase)
+    {
+        case 0:
+            return RenderTestLayer::scene();
+        case 1:
+            return RenderQuadTransformTestLayer::scene();
+    }
+    return nullptr;
+}
 
 RenderTestLayer::RenderTestLayer()
-: PerformBasicLayer(true, 1, 1)
+: PerformBasicLayer(true, TEST_COUNT, 0)
 {
 }
 
@@ -45,7 +64,142 @@ void RenderTestLayer::onEnter()
 
 void RenderTestLayer::showCurrentTest()
 {
-    
+    Director::getInstance()->replaceScene(createRendererTestScene(_curCase));
+}
+
+////////////////////////////////////////////////////////
+//
+// RenderQuadTransformTestLayer
+//
+////////////////////////////////////////////////////////
+RenderQuadTransformTestLayer::RenderQuadTransformTestLayer()
+: PerformBasicLayer(true, TEST_COUNT, 1)
+, _infoLabel(nullptr)
+, _frames(0)
+{
+    for (int i = 0; i < MATRIX_COUNT; ++i)
+    {
+        _scalarTime[i] = _kernelTime[i] = 0;
+    }
+}
+
+RenderQuadTransformTestLayer::~RenderQuadTransformTestLayer()
+{
+}
+
+Scene* RenderQuadTransformTestLayer::scene()
+{
+    auto scene = Scene::create();
+    auto layer = new RenderQuadTransformTestLayer();
+    scene->addChild(layer);
+    layer->release();
+
+    return scene;
+}
+
+void RenderQuadTransformTestLayer::onEnter()
+{
+    PerformBasicLayer::onEnter();
+
+    auto s = Director::getInstance()->getWinSize();
+
+    auto label = Label::createWithTTF("Quad transform", "fonts/arial.ttf", 32);
+    addChild(label, 1);
+    label->setPosition(Vec2(s.width/2, s.height-50));
+
+    _infoLabel = Label::createWithTTF("", "fonts/arial.ttf", 20);
+    addChild(_infoLabel, 1);
+    _infoLabel->setPosition(Vec2(s.width/2, s.height/2));
+
+    _srcQuads.resize(QUAD_COUNT);
+    _dstQuads.resize(QUAD_COUNT);
+    for (int i = 0; i < QUAD_COUNT; ++i)
+    {
+        auto& quad = _srcQuads[i];
+        float x = CCRANDOM_0_1() * s.width;
+        float y = CCRANDOM_0_1() * s.height;
+        quad.bl.vertices = Vec3(x, y, 0);
+        quad.br.vertices = Vec3(x + 32, y, 0);
+        quad.tl.vertices = Vec3(x, y + 32, 0);
+        quad.tr.vertices = Vec3(x + 32, y + 32, 0);
+    }
+
+    scheduleUpdate();
+}
+
+void RenderQuadTransformTestLayer::showCurrentTest()
+{
+    Director::getInstance()->replaceScene(createRendererTestScene(_curCase));
+}
+
+float RenderQuadTransformTestLayer::transformScalar(const Mat4& modelView)
+{
+    // What Renderer used to do: copy, then transform every vertex through Mat4::transformPoint
+    auto start = std::chrono::high_resolution_clock::now();
+    std::copy(_srcQuads.begin(), _srcQuads.end(), _dstQuads.begin());
+    for (auto& quad : _dstQuads)
+    {
+        modelView.transformPoint(&quad.bl.vertices);
+        modelView.transformPoint(&quad.br.vertices);
+        modelView.transformPoint(&quad.tr.vertices);
+        modelView.transformPoint(&quad.tl.vertices);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::duration<float>>(end - start).count();
+}
+
+float RenderQuadTransformTestLayer::transformKernel(const Mat4& modelView)
+{
+    // What Renderer does now
+    auto start = std::chrono::high_resolution_clock::now();
+    MathUtil::transformVertices(&_dstQuads[0].tl, &_srcQuads[0].tl, QUAD_COUNT * 4, modelView);
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::duration<float>>(end - start).count();
+}
+
+void RenderQuadTransformTestLayer::update(float dt)
+{
+    float angle = CC_DEGREES_TO_RADIANS(_frames % 360);
+    Mat4 modelView[MATRIX_COUNT];
+    Mat4::createRotationZ(angle, &modelView[MATRIX_2D]);
+    modelView[MATRIX_2D].translate(10, 20, 0);
+    Mat4::createRotationX(angle, &modelView[MATRIX_3D]);
+    modelView[MATRIX_3D].translate(10, 20, -5);
+
+    // alternate the order so neither variant always runs on a warm cache
+    for (int i = 0; i < MATRIX_COUNT; ++i)
+    {
+        if (_frames % 2 == 0)
+        {
+            _scalarTime[i] += transformScalar(modelView[i]);
+            _kernelTime[i] += transformKernel(modelView[i]);
+        }
+        else
+        {
+            _kernelTime[i] += transformKernel(modelView[i]);
+            _scalarTime[i] += transformScalar(modelView[i]);
+        }
+    }
+
+    if (++_frames % 60 == 0)
+    {
+        char str[256] = {0};
+        snprintf(str, sizeof(str) - 1, "%d quads\n"
+                 "2D: scalar %.3f ms, transformVertices %.3f ms (%.2fx)\n"
+                 "3D: scalar %.3f ms, transformVertices %.3f ms (%.2fx)",
+                 QUAD_COUNT,
+                 _scalarTime[MATRIX_2D] * 1000 / 60, _kernelTime[MATRIX_2D] * 1000 / 60,
+                 _kernelTime[MATRIX_2D] > 0 ? _scalarTime[MATRIX_2D] / _kernelTime[MATRIX_2D] : 0.0f,
+                 _scalarTime[MATRIX_3D] * 1000 / 60, _kernelTime[MATRIX_3D] * 1000 / 60,
+                 _kernelTime[MATRIX_3D] > 0 ? _scalarTime[MATRIX_3D] / _kernelTime[MATRIX_3D] : 0.0f);
+        _infoLabel->setString(str);
+        log("%s", str);
+
+        for (int i = 0; i < MATRIX_COUNT; ++i)
+        {
+            _scalarTime[i] = _kernelTime[i] = 0;
+        }
+    }
 }
 
 void runRendererTest()
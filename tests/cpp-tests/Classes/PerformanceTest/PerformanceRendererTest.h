@@ -24,5 +24,39 @@ public:
     static Scene* scene();
 };
 
+class RenderQuadTransformTestLayer : public PerformBasicLayer
+{
+public:
+    static const int QUAD_COUNT = 10000;
+
+    RenderQuadTransformTestLayer();
+    virtual ~RenderQuadTransformTestLayer();
+
+    virtual void onEnter() override;
+    virtual void showCurrentTest() override;
+    virtual void update(float dt) override;
+public:
+    static Scene* scene();
+
+protected:
+    enum
+    {
+        MATRIX_2D,      // takes the affine early-out in MathUtil::transformVertices
+        MATRIX_3D,      // full matrix, takes the SSE/NEON path
+        MATRIX_COUNT
+    };
+
+    // returns seconds spent
+    float transformScalar(const Mat4& modelView);
+    float transformKernel(const Mat4& modelView);
+
+    std::vector<V3F_C4B_T2F_Quad> _srcQuads;
+    std::vector<V3F_C4B_T2F_Quad> _dstQuads;
+    Label* _infoLabel;
+    float _scalarTime[MATRIX_COUNT];
+    float _kernelTime[MATRIX_COUNT];
+    int _frames;
+};
+
 void runRendererTest();
 #endif
@@ -1,5 +1,7 @@
 #include "ReleasePoolTest.h"
 
+#include <thread>
+
 using namespace cocos2d;
 
 class TestObject : public Ref
@@ -76,5 +78,30 @@ void ReleasePoolTestScene::runThisTest()
     
     // object in pool2 should be released
     
+    // a pool holding more objects than fit in one block
+    {
+        AutoreleasePool pool3;
+        assert(PoolManager::getInstance()->getCurrentPool() == &pool3);
+        for (int i = 0; i < 5000; ++i)
+        {
+            obj->retain();
+            obj->autorelease();
+        }
+        assert(pool3.getObjectCount() == 5000);
+        assert(obj->getReferenceCount() == 5002);
+    }
+    
+    assert(obj->getReferenceCount() == 2);
+    
+    // every thread has its own current pool
+    std::thread worker([=](){
+        AutoreleasePool pool4;
+        assert(PoolManager::getInstance()->getCurrentPool() == &pool4);
+        TestObject *tmpObj = new TestObject();
+        tmpObj->autorelease();
+        assert(pool4.getObjectCount() == 1);
+    });
+    worker.join();
+    
     Director::getInstance()->replaceScene(this);
 }
@@ -28,7 +28,9 @@ static std::function<Layer*()> createFunctions[] = {
     CL(RescheduleSelector),
     CL(SchedulerDelayAndRepeat),
     CL(SchedulerIssue2268),
-    CL(ScheduleCallbackTest)
+    CL(ScheduleCallbackTest),
+    CL(SchedulerManyTimers),
+    CL(SchedulerPerformFunction)
 };
 
 #define MAX_LAYER (sizeof(createFunctions) / sizeof(createFunctions[0]))
@@ -1148,6 +1150,127 @@ void ScheduleCallbackTest::callback(float dt)
     log("In the callback of schedule(CC_CALLBACK_1(XXX::member_function), this), this, ...), dt = %f", dt);
 }
 
+// SchedulerManyTimers
+
+std::string SchedulerManyTimers::title() const
+{
+    return "Many timers";
+}
+
+std::string SchedulerManyTimers::subtitle() const
+{
+    return "10000 timers with 1-60 sec intervals.\nOnly the timers that fire should cost per frame";
+}
+
+void SchedulerManyTimers::onEnter()
+{
+    SchedulerTestLayer::onEnter();
+
+    _fired = 0;
+    auto s = Director::getInstance()->getWinSize();
+    _label = Label::createWithTTF("", "fonts/arial.ttf", 20);
+    _label->setPosition(Vec2(s.width/2, s.height/2));
+    addChild(_label);
+
+    // spread the timers over several targets, like units owning their own AI timers
+    char key[16];
+    for (int i = 0; i < 100; ++i)
+    {
+        auto unit = Node::create();
+        addChild(unit);
+        for (int j = 0; j < 100; ++j)
+        {
+            snprintf(key, sizeof(key), "ai%d", j);
+            float interval = 1.0f + (float)((i * 100 + j) % 60);
+            _scheduler->schedule([this](float dt){
+                ++_fired;
+            }, unit, interval, false, key);
+        }
+    }
+
+    schedule(schedule_selector(SchedulerManyTimers::report), 1.0f);
+}
+
+void SchedulerManyTimers::report(float dt)
+{
+    char str[64];
+    snprintf(str, sizeof(str), "fired last second: %d", _fired);
+    _label->setString(str);
+    _fired = 0;
+}
+
+// SchedulerPerformFunction
+
+std::string SchedulerPerformFunction::title() const
+{
+    return "performFunctionInCocosThread";
+}
+
+std::string SchedulerPerformFunction::subtitle() const
+{
+    return "2 threads post 2000 functions per frame.\nBudget is 2 ms per frame, the rest is deferred";
+}
+
+void SchedulerPerformFunction::onEnter()
+{
+    SchedulerTestLayer::onEnter();
+
+    // queued functions may still run after this layer is gone, so they only
+    // touch a counter they share ownership of
+    _done = std::make_shared<std::atomic<int>>(0);
+    auto s = Director::getInstance()->getWinSize();
+    _label = Label::createWithTTF("", "fonts/arial.ttf", 20);
+    _label->setPosition(Vec2(s.width/2, s.height/2));
+    addChild(_label);
+
+    _scheduler->setPerformFunctionBudget(0.002f);
+
+    _running = true;
+    for (int i = 0; i < 2; ++i)
+    {
+        auto done = _done;
+        _threads.push_back(std::thread([this, done](){
+            while (_running)
+            {
+                for (int j = 0; j < 1000; ++j)
+                {
+                    _scheduler->performFunctionInCocosThread([done](){
+                        ++*done;
+                    });
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(16));
+            }
+        }));
+    }
+
+    schedule(schedule_selector(SchedulerPerformFunction::report), 1.0f);
+}
+
+void SchedulerPerformFunction::onExit()
+{
+    _running = false;
+    for (auto& thread : _threads)
+    {
+        thread.join();
+    }
+    _threads.clear();
+    _scheduler->setPerformFunctionBudget(0);
+
+    SchedulerTestLayer::onExit();
+}
+
+void SchedulerPerformFunction::report(float dt)
+{
+    auto stats = _scheduler->getPerformFunctionStats();
+    char str[256];
+    snprintf(str, sizeof(str), "run last second: %d\nenqueued: %llu drained: %llu\ndeferred: %llu overflowed: %llu",
+             _done->load(),
+             (unsigned long long)stats.enqueued, (unsigned long long)stats.drained,
+             (unsigned long long)stats.deferred, (unsigned long long)stats.overflowed);
+    _label->setString(str);
+    *_done = 0;
+}
+
 //------------------------------------------------------------------
 //
 // SchedulerTestScene
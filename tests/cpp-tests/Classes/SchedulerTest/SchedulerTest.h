@@ -1,6 +1,10 @@
 #ifndef _SCHEDULER_TEST_H_
 #define _SCHEDULER_TEST_H_
 
+#include <atomic>
+#include <memory>
+#include <thread>
+
 #include "cocos2d.h"
 #include "extensions/cocos-ext.h"
 #include "../testBasic.h"
@@ -302,6 +306,39 @@ public:
 private:
 };
 
+class SchedulerManyTimers : public SchedulerTestLayer
+{
+public:
+    CREATE_FUNC(SchedulerManyTimers);
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    void onEnter();
+    void report(float dt);
+
+private:
+    Label* _label;
+    int _fired;
+};
+
+class SchedulerPerformFunction : public SchedulerTestLayer
+{
+public:
+    CREATE_FUNC(SchedulerPerformFunction);
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    void report(float dt);
+
+private:
+    Label* _label;
+    std::shared_ptr<std::atomic<int>> _done;
+    std::atomic<bool> _running;
+    std::vector<std::thread> _threads;
+};
+
 class SchedulerTestScene : public TestScene
 {
 public:
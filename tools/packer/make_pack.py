@@ -0,0 +1,134 @@
+#!/usr/bin/python
+#make_pack.py
+#Packs a resource directory into a .ccpk file (see cocos/2d/platform/CCPackFile.h).
+#The pack is mounted by adding its path as a FileUtils search path:
+#    FileUtils::getInstance()->addSearchPath("res.ccpk");
+#
+#usage: make_pack.py [-z] [-a ALIGNMENT] res_dir res.ccpk
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = b'CCPK'
+VERSION = 1
+
+COMPRESSION_NONE = 0
+COMPRESSION_ZLIB = 1
+
+#magic, version, entry count, slot count, alignment, names size, 8 reserved bytes
+HEADER = struct.Struct('<4sIIIII8x')
+#hash, offset, size, stored size, name offset, name length, compression, 1 reserved byte
+ENTRY = struct.Struct('<QQIIIHBx')
+
+#formats that are compressed already, they are always stored so they can be read in place
+STORED_EXTENSIONS = set(['.png', '.jpg', '.jpeg', '.webp', '.pkm', '.ccz', '.gz', '.zip',
+                         '.mp3', '.ogg', '.m4a', '.caf', '.wav'])
+
+#same hash as PackFile::hashName (64 bit FNV-1a)
+def hashName(name):
+    h = 0xcbf29ce484222325
+    for b in bytearray(name):
+        h ^= b
+        h = (h * 0x100000001b3) & 0xffffffffffffffff
+    return h
+
+def alignUp(value, alignment):
+    return (value + alignment - 1) // alignment * alignment
+
+#relative paths with '/' separators, hidden files are skipped
+def collectFiles(root):
+    files = []
+    for dirPath, dirNames, fileNames in os.walk(root):
+        dirNames[:] = sorted(d for d in dirNames if not d.startswith('.'))
+        for fileName in sorted(fileNames):
+            if fileName.startswith('.'):
+                continue
+            fullPath = os.path.join(dirPath, fileName)
+            name = os.path.relpath(fullPath, root).replace(os.sep, '/')
+            files.append((name, fullPath))
+    return files
+
+def makePack(root, output, alignment, compress):
+    files = collectFiles(root)
+
+    slotCount = 2
+    while slotCount < len(files) * 2:
+        slotCount *= 2
+
+    entries = []
+    names = bytearray()
+    blobs = []
+    for name, fullPath in files:
+        encoded = name.encode('utf-8')
+        if len(encoded) > 0xffff:
+            raise ValueError('file name too long: %s' % name)
+
+        with open(fullPath, 'rb') as f:
+            data = f.read()
+        if len(data) > 0xffffffff:
+            raise ValueError('file too large: %s' % name)
+
+        compression = COMPRESSION_NONE
+        stored = data
+        extension = os.path.splitext(name)[1].lower()
+        if compress and data and extension not in STORED_EXTENSIONS:
+            deflated = zlib.compress(data, 9)
+            #keep files stored unless compression saves at least 10%
+            if len(deflated) * 10 < len(data) * 9:
+                compression = COMPRESSION_ZLIB
+                stored = deflated
+
+        entries.append([hashName(encoded), 0, len(data), len(stored), len(names), len(encoded), compression])
+        names += encoded
+        blobs.append(stored)
+
+    indexSize = HEADER.size + slotCount * 4 + len(entries) * ENTRY.size + len(names)
+    offset = alignUp(indexSize, alignment)
+    for entry, blob in zip(entries, blobs):
+        entry[1] = offset
+        offset = alignUp(offset + len(blob), alignment)
+
+    #open addressing with linear probing, a slot stores the entry index + 1
+    slots = [0] * slotCount
+    mask = slotCount - 1
+    for i, entry in enumerate(entries):
+        slot = entry[0] & mask
+        while slots[slot]:
+            slot = (slot + 1) & mask
+        slots[slot] = i + 1
+
+    with open(output, 'wb') as f:
+        f.write(HEADER.pack(MAGIC, VERSION, len(entries), slotCount, alignment, len(names)))
+        f.write(struct.pack('<%dI' % slotCount, *slots))
+        for entry in entries:
+            f.write(ENTRY.pack(*entry))
+        f.write(names)
+        for entry, blob in zip(entries, blobs):
+            f.write(b'\0' * (entry[1] - f.tell()))
+            f.write(blob)
+
+    compressed = sum(1 for entry in entries if entry[6] == COMPRESSION_ZLIB)
+    print('%s: %d files (%d compressed), %d bytes' % (output, len(entries), compressed, os.path.getsize(output)))
+
+def main():
+    parser = argparse.ArgumentParser(description='Packs a resource directory into a .ccpk file.')
+    parser.add_argument('-z', '--compress', action='store_true',
+                        help='compress files with zlib when it saves at least 10%%')
+    parser.add_argument('-a', '--alignment', type=int, default=16,
+                        help='alignment of file data in bytes, a power of two (default 16)')
+    parser.add_argument('root', help='resource directory')
+    parser.add_argument('output', help='pack file to write')
+    args = parser.parse_args()
+
+    if args.alignment <= 0 or args.alignment & (args.alignment - 1):
+        parser.error('alignment must be a power of two')
+    if not os.path.isdir(args.root):
+        parser.error('%s is not a directory' % args.root)
+
+    makePack(args.root, args.output, args.alignment, args.compress)
+
+if __name__ == '__main__':
+    main()